@@ -0,0 +1,331 @@
+// Accuracy against cost for the engine settings worth tuning.
+//
+// Every configuration prices the same grid of contracts: spot 100, strikes
+// from 80% to 120% moneyness, three vols and three maturities, calls and
+// puts at a 5% rate. Its error is taken against a reference. European
+// contracts use Black-Scholes. American ones use a 4001-step Leisen-Reimer
+// tree with Richardson extrapolation and the control variate. That is within
+// about 1e-4 of the converged price, so American errors below that are not
+// resolved. Cost is the best of several timed passes over the grid, in ns
+// per price, including the engine's construction.
+//
+// Monte Carlo configurations give every contract its own seed, so their
+// errors are independent draws and the RMS error estimates the engine's
+// sampling error rather than one correlated draw repeated 90 times.
+//
+// Errors are deterministic, so two runs of one build agree on every error
+// column and a diff catches accuracy regressions. A configuration is on the
+// Pareto frontier when no other one of the same exercise style is at most as
+// costly with a smaller largest error. ns_per_price and pareto come from
+// timings and move from run to run, so only the error columns are meant to
+// be diffed; ns_per_price is for spotting large slowdowns.
+//
+//   options_pricing_accuracy [--format csv|json] [--out file] [--tolerance error]
+//                            [--max-steps n] [--repeats n]
+//
+// With --tolerance it also names, per exercise style, the cheapest
+// configuration whose largest error is within it.
+
+#include "options_pricing.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace OptionsPricing;
+
+namespace {
+
+struct Contract {
+    double spot;
+    double strike;
+    double rate;
+    double vol;
+    double time;
+    OptionType type;
+    std::uint64_t seed;  // Monte Carlo seed, distinct per contract
+};
+
+std::vector<Contract> makeGrid() {
+    std::vector<Contract> grid;
+    for (OptionType type : {OptionType::Call, OptionType::Put}) {
+        for (double moneyness : {0.8, 0.9, 1.0, 1.1, 1.2}) {
+            for (double vol : {0.1, 0.25, 0.5}) {
+                for (double time : {0.25, 1.0, 3.0}) {
+                    grid.push_back({100.0, 100.0 * moneyness, 0.05, vol, time, type, 0x5EED5EEDull + grid.size()});
+                }
+            }
+        }
+    }
+    return grid;
+}
+
+struct Configuration {
+    ExerciseType exercise;
+    std::string engine;
+    std::string setting;
+    std::function<double(const Contract&)> price;
+};
+
+struct Score {
+    const Configuration* configuration;
+    double maxError;
+    double rmsError;
+    double nsPerPrice;
+    bool pareto;
+};
+
+BinomialTreeSettings leisenReimer(unsigned int steps, bool american) {
+    BinomialTreeSettings settings;
+    settings.steps = steps;
+    settings.parametrization = BinomialParametrization::LeisenReimer;
+    settings.richardson = true;
+    settings.controlVariate = american;
+    return settings;
+}
+
+double reference(const Contract& c, ExerciseType exercise) {
+    if (exercise == ExerciseType::European) {
+        return BlackScholesOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type).price();
+    }
+    return BinomialTreeOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type, ExerciseType::American,
+                              leisenReimer(4001, true)).price();
+}
+
+std::vector<Configuration> makeConfigurations(unsigned int maxSteps) {
+    std::vector<Configuration> configurations;
+    for (ExerciseType exercise : {ExerciseType::European, ExerciseType::American}) {
+        bool american = exercise == ExerciseType::American;
+        for (unsigned int steps : {25u, 50u, 100u, 200u, 400u, 800u, 1600u}) {
+            if (steps > maxSteps) {
+                continue;
+            }
+            std::string setting = "steps=" + std::to_string(steps);
+            configurations.push_back({exercise, "BinomialCRR", setting, [=](const Contract& c) {
+                return BinomialTreeOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type, exercise, steps).price();
+            }});
+            configurations.push_back({exercise, "BinomialLeisenReimer", setting, [=](const Contract& c) {
+                return BinomialTreeOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type, exercise,
+                                          leisenReimer(steps, american)).price();
+            }});
+            configurations.push_back({exercise, "Trinomial", setting, [=](const Contract& c) {
+                return TrinomialTreeOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type, exercise, steps).price();
+            }});
+        }
+        for (unsigned int spaceSteps : {50u, 100u, 200u, 400u, 800u}) {
+            FiniteDifferenceSettings settings;
+            settings.spaceSteps = spaceSteps;
+            settings.timeSteps = std::max(10u, spaceSteps / 8);
+            std::string setting = "space=" + std::to_string(settings.spaceSteps) +
+                                  " time=" + std::to_string(settings.timeSteps);
+            configurations.push_back({exercise, "FiniteDifference", setting, [=](const Contract& c) {
+                return FiniteDifferenceOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type, exercise, settings)
+                    .price();
+            }});
+        }
+        if (american) {
+            for (AmericanApproximation method :
+                 {AmericanApproximation::BaroneAdesiWhaley, AmericanApproximation::BjerksundStensland}) {
+                std::string engine = method == AmericanApproximation::BaroneAdesiWhaley ? "BaroneAdesiWhaley"
+                                                                                         : "BjerksundStensland";
+                configurations.push_back({exercise, engine, "", [=](const Contract& c) {
+                    return AmericanApproximationOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type, method)
+                        .price();
+                }});
+            }
+        } else {
+            for (MonteCarloSampling sampling : {MonteCarloSampling::PseudoRandom, MonteCarloSampling::Sobol}) {
+                for (std::size_t paths : {std::size_t(1) << 12, std::size_t(1) << 15}) {
+                    MonteCarloSettings settings;
+                    settings.maxPaths = paths;
+                    settings.sampling = sampling;
+                    std::string engine = sampling == MonteCarloSampling::PseudoRandom ? "MonteCarlo"
+                                                                                       : "QuasiMonteCarlo";
+                    configurations.push_back({exercise, engine, "paths=" + std::to_string(paths),
+                                              [=](const Contract& c) {
+                        MonteCarloSettings seeded = settings;
+                        seeded.seed = c.seed;
+                        return MonteCarloOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type, seeded).price();
+                    }});
+                }
+            }
+        }
+    }
+    return configurations;
+}
+
+volatile double sink = 0.0;  // keeps timed passes from being optimized away
+
+// Errors from one pass, cost from the best of `repeats` timings, each of
+// enough passes to run for about 20 ms
+Score score(const Configuration& configuration, const std::vector<Contract>& grid,
+            const std::vector<double>& references, int repeats) {
+    using Clock = std::chrono::steady_clock;
+    Score result{&configuration, 0.0, 0.0, 0.0, false};
+    double squares = 0.0;
+    Clock::time_point start = Clock::now();
+    for (std::size_t i = 0; i < grid.size(); ++i) {
+        double error = std::fabs(configuration.price(grid[i]) - references[i]);
+        result.maxError = std::max(result.maxError, error);
+        squares += error * error;
+    }
+    double first = std::chrono::duration<double>(Clock::now() - start).count();
+    result.rmsError = std::sqrt(squares / grid.size());
+
+    int passes = std::max(1, static_cast<int>(0.02 / std::max(first, 1e-9)));
+    double best = first;
+    double total = 0.0;
+    for (int r = 0; r < repeats; ++r) {
+        start = Clock::now();
+        for (int p = 0; p < passes; ++p) {
+            for (const Contract& c : grid) {
+                total += configuration.price(c);
+            }
+        }
+        best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count() / passes);
+    }
+    sink = total;
+    result.nsPerPrice = best * 1e9 / grid.size();
+    return result;
+}
+
+// Walk each exercise style from cheapest to dearest, keeping the ones that
+// beat every cheaper configuration's largest error
+void markPareto(std::vector<Score>& scores) {
+    std::vector<Score*> order;
+    for (Score& s : scores) {
+        order.push_back(&s);
+    }
+    std::sort(order.begin(), order.end(),
+              [](const Score* a, const Score* b) { return a->nsPerPrice < b->nsPerPrice; });
+    for (ExerciseType exercise : {ExerciseType::European, ExerciseType::American}) {
+        double best = HUGE_VAL;
+        for (Score* s : order) {
+            if (s->configuration->exercise == exercise && s->maxError < best) {
+                s->pareto = true;
+                best = s->maxError;
+            }
+        }
+    }
+}
+
+void writeCsv(std::ostream& out, const std::vector<Score>& scores) {
+    out << "exercise,engine,setting,max_error,rms_error,ns_per_price,pareto\n";
+    for (const Score& s : scores) {
+        const Configuration& c = *s.configuration;
+        out << exerciseTypeToString(c.exercise) << "," << c.engine << "," << c.setting << "," << s.maxError << ","
+            << s.rmsError << "," << s.nsPerPrice << "," << (s.pareto ? 1 : 0) << "\n";
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<Score>& scores, std::size_t contracts) {
+    out << "{\n  \"contracts\": " << contracts << ",\n  \"configurations\": [\n";
+    for (std::size_t i = 0; i < scores.size(); ++i) {
+        const Score& s = scores[i];
+        const Configuration& c = *s.configuration;
+        out << "    {\"exercise\": \"" << exerciseTypeToString(c.exercise) << "\", \"engine\": \"" << c.engine
+            << "\", \"setting\": \"" << c.setting << "\", \"max_error\": " << s.maxError
+            << ", \"rms_error\": " << s.rmsError << ", \"ns_per_price\": " << s.nsPerPrice
+            << ", \"pareto\": " << (s.pareto ? "true" : "false") << "}" << (i + 1 < scores.size() ? "," : "")
+            << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+int usage() {
+    std::cerr << "usage: options_pricing_accuracy [--format csv|json] [--out file] [--tolerance error]\n"
+                 "                                [--max-steps n] [--repeats n]\n";
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string format = "csv";
+    std::string outPath;
+    double tolerance = 0.0;
+    unsigned int maxSteps = 1600;
+    int repeats = 3;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 == argc) {
+            return usage();
+        }
+        std::string value = argv[++i];
+        if (arg == "--format" && (value == "csv" || value == "json")) {
+            format = value;
+        } else if (arg == "--out") {
+            outPath = value;
+        } else if (arg == "--tolerance") {
+            tolerance = std::atof(value.c_str());
+        } else if (arg == "--max-steps") {
+            maxSteps = static_cast<unsigned int>(std::atoi(value.c_str()));
+        } else if (arg == "--repeats") {
+            repeats = std::max(1, std::atoi(value.c_str()));
+        } else {
+            return usage();
+        }
+    }
+
+    try {
+        std::vector<Contract> grid = makeGrid();
+        std::vector<double> european, american;
+        for (const Contract& c : grid) {
+            european.push_back(reference(c, ExerciseType::European));
+            american.push_back(reference(c, ExerciseType::American));
+        }
+
+        std::vector<Configuration> configurations = makeConfigurations(maxSteps);
+        std::vector<Score> scores;
+        for (const Configuration& c : configurations) {
+            bool isAmerican = c.exercise == ExerciseType::American;
+            scores.push_back(score(c, grid, isAmerican ? american : european, repeats));
+        }
+        markPareto(scores);
+
+        std::ofstream file;
+        if (!outPath.empty()) {
+            file.open(outPath);
+            if (!file) {
+                throw std::runtime_error("Cannot write " + outPath);
+            }
+        }
+        std::ostream& out = outPath.empty() ? std::cout : file;
+        out.precision(6);
+        if (format == "json") {
+            writeJson(out, scores, grid.size());
+        } else {
+            writeCsv(out, scores);
+        }
+
+        for (ExerciseType exercise : {ExerciseType::European, ExerciseType::American}) {
+            if (tolerance <= 0.0) {
+                break;
+            }
+            const Score* cheapest = nullptr;
+            for (const Score& s : scores) {
+                if (s.configuration->exercise == exercise && s.maxError <= tolerance &&
+                    (!cheapest || s.nsPerPrice < cheapest->nsPerPrice)) {
+                    cheapest = &s;
+                }
+            }
+            std::cerr << exerciseTypeToString(exercise) << " within " << tolerance << ": ";
+            if (cheapest) {
+                std::cerr << cheapest->configuration->engine << " " << cheapest->configuration->setting << ", "
+                          << cheapest->nsPerPrice << " ns\n";
+            } else {
+                std::cerr << "none\n";
+            }
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,711 @@
+// Benchmarks for every pricing engine and Greek path.
+//
+// Per-option timings are reported as the time_per_option (seconds, shown
+// with an SI prefix, e.g. 24ns) and options_per_sec counters. Write JSON for diffing between versions with
+//   options_pricing_bench --benchmark_out=bench.json --benchmark_out_format=json
+
+#include "options_pricing.h"
+#include "OptionsPricing/PositionFile.hpp"
+#if defined(OPTIONS_PRICING_HAS_CUDA)
+#include "OptionsPricing/Gpu.hpp"
+#endif
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace OptionsPricing;
+
+namespace {
+
+void reportPerOption(benchmark::State& state, double optionsPerIteration) {
+    double options = optionsPerIteration * static_cast<double>(state.iterations());
+    state.SetItemsProcessed(static_cast<int64_t>(options));
+    state.counters["options_per_sec"] = benchmark::Counter(options, benchmark::Counter::kIsRate);
+    state.counters["time_per_option"] =
+        benchmark::Counter(options, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+// Random but reproducible contracts around the money
+struct Contract {
+    double spot;
+    double strike;
+    double rate;
+    double vol;
+    double time;
+    OptionType type;
+};
+
+std::vector<Contract> makeContracts(std::size_t n) {
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> moneyness(0.7, 1.3);
+    std::uniform_real_distribution<double> vol(0.1, 0.6);
+    std::uniform_real_distribution<double> time(0.05, 3.0);
+    std::uniform_real_distribution<double> rate(0.0, 0.08);
+    std::vector<Contract> contracts(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        contracts[i] = {100.0, 100.0 * moneyness(rng), rate(rng), vol(rng), time(rng),
+                        (i % 2 == 0) ? OptionType::Call : OptionType::Put};
+    }
+    return contracts;
+}
+
+OptionBatch makeBatch(std::size_t n) {
+    OptionBatch batch;
+    batch.reserve(n);
+    for (const Contract& c : makeContracts(n)) {
+        batch.add(c.spot, c.strike, c.rate, c.vol, c.time, c.type);
+    }
+    return batch;
+}
+
+// Mixed book: one American binomial position in a hundred, the rest Black-Scholes
+const OptionPortfolio& cachedPortfolio(std::size_t n) {
+    static std::map<std::size_t, std::unique_ptr<OptionPortfolio>> cache;
+    std::unique_ptr<OptionPortfolio>& portfolio = cache[n];
+    if (!portfolio) {
+        portfolio = std::make_unique<OptionPortfolio>();
+        std::vector<Contract> contracts = makeContracts(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const Contract& c = contracts[i];
+            if (i % 100 == 0) {
+                portfolio->addOption(std::make_unique<BinomialTreeOption>(
+                    c.spot, c.strike, c.rate, c.vol, c.time, c.type, ExerciseType::American, 100));
+            } else {
+                portfolio->addOption(std::make_unique<BlackScholesOption>(
+                    c.spot, c.strike, c.rate, c.vol, c.time, c.type));
+            }
+        }
+    }
+    return *portfolio;
+}
+
+const GroupedPortfolio& cachedGroupedPortfolio(std::size_t n) {
+    static std::map<std::size_t, std::unique_ptr<GroupedPortfolio>> cache;
+    std::unique_ptr<GroupedPortfolio>& portfolio = cache[n];
+    if (!portfolio) {
+        portfolio = std::make_unique<GroupedPortfolio>();
+        std::vector<Contract> contracts = makeContracts(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const Contract& c = contracts[i];
+            if (i % 100 == 0) {
+                portfolio->addOption(BinomialTreeOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type,
+                                                        ExerciseType::American, 100));
+            } else {
+                portfolio->addOption(BlackScholesOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type));
+            }
+        }
+    }
+    return *portfolio;
+}
+
+// Black-Scholes, one option at a time
+
+void BM_BlackScholesPrice(benchmark::State& state) {
+    BlackScholesOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Call);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.price());
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_BlackScholesPrice);
+
+void BM_BlackScholesGreeks(benchmark::State& state) {
+    BlackScholesOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Call);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.calculateGreeks());
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_BlackScholesGreeks);
+
+void BM_BlackScholesAllGreeks(benchmark::State& state) {
+    BlackScholesOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Call);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.calculateAllGreeks());
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_BlackScholesAllGreeks);
+
+// Black-Scholes batches; the second argument is the SimdLevel
+
+void BM_BatchBlackScholesPrice(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    SimdLevel level = static_cast<SimdLevel>(state.range(1));
+    state.SetLabel(simdLevelToString(resolveSimdLevel(level)));
+    OptionBatch batch = makeBatch(n);
+    std::vector<double> out(n);
+    for (auto _ : state) {
+        BatchBlackScholes::price(batch.view(), out.data(), level);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_BatchBlackScholesPrice)
+    ->ArgsProduct({{1000, 100000}, {static_cast<int>(SimdLevel::Scalar), static_cast<int>(SimdLevel::AVX2),
+                                    static_cast<int>(SimdLevel::AVX512)}});
+
+void BM_BatchBlackScholesGreeks(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    SimdLevel level = static_cast<SimdLevel>(state.range(1));
+    state.SetLabel(simdLevelToString(resolveSimdLevel(level)));
+    OptionBatch batch = makeBatch(n);
+    std::vector<std::vector<double>> columns(9, std::vector<double>(n));
+    GreeksBatchOutput out = {columns[0].data(), columns[1].data(), columns[2].data(),
+                             columns[3].data(), columns[4].data(), columns[5].data(),
+                             columns[6].data(), columns[7].data(), columns[8].data()};
+    for (auto _ : state) {
+        BatchBlackScholes::greeks(batch.view(), out, level);
+        benchmark::DoNotOptimize(columns[0].data());
+        benchmark::ClobberMemory();
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_BatchBlackScholesGreeks)
+    ->ArgsProduct({{1000, 100000}, {static_cast<int>(SimdLevel::Scalar), static_cast<int>(SimdLevel::AVX2),
+                                    static_cast<int>(SimdLevel::AVX512)}});
+
+void BM_BatchBlackScholesPriceFloat(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    SimdLevel level = static_cast<SimdLevel>(state.range(1));
+    state.SetLabel(simdLevelToString(resolveSimdLevel(level)));
+    FloatOptionBatch batch(makeBatch(n).view());
+    std::vector<float> out(n);
+    for (auto _ : state) {
+        BatchBlackScholes::price(batch.view(), out.data(), level);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_BatchBlackScholesPriceFloat)
+    ->ArgsProduct({{1000, 100000}, {static_cast<int>(SimdLevel::Scalar), static_cast<int>(SimdLevel::AVX2),
+                                    static_cast<int>(SimdLevel::AVX512)}});
+
+#if defined(OPTIONS_PRICING_HAS_CUDA)
+// Device pricing including the transfers; skipped without a visible device
+void BM_GpuBatchBlackScholesPrice(benchmark::State& state) {
+    if (!gpuAvailable()) {
+        state.SkipWithError("no CUDA device");
+        return;
+    }
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    static GpuPricer pricer;
+    state.SetLabel(pricer.deviceName());
+    OptionBatch batch = makeBatch(n);
+    std::vector<double> out(n);
+    for (auto _ : state) {
+        pricer.price(batch.view(), out.data());
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_GpuBatchBlackScholesPrice)->Arg(100000)->Arg(10000000);
+#endif
+
+// Trees across step counts
+
+void BM_BinomialPrice(benchmark::State& state) {
+    BinomialTreeOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American,
+                              static_cast<unsigned int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.price());
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_BinomialPrice)->Arg(100)->Arg(500)->Arg(1000)->Arg(2000);
+
+// Leisen-Reimer with Richardson extrapolation and the control variate, at
+// step counts that match the accuracy of the Cox-Ross-Rubinstein runs above
+void BM_BinomialLeisenReimer(benchmark::State& state) {
+    BinomialTreeSettings settings;
+    settings.steps = static_cast<unsigned int>(state.range(0));
+    settings.parametrization = BinomialParametrization::LeisenReimer;
+    settings.richardson = true;
+    settings.controlVariate = true;
+    BinomialTreeOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American, settings);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.price());
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_BinomialLeisenReimer)->Arg(51)->Arg(101)->Arg(201);
+
+// A 40-strike ladder on one expiry, one tree per strike; all but the first
+// take their lattice set-up from LatticeParameterCache
+void BM_BinomialStrikeLadder(benchmark::State& state) {
+    std::vector<BinomialTreeOption> ladder;
+    for (int i = 0; i < 40; ++i) {
+        ladder.emplace_back(100.0, 80.0 + i, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American,
+                            static_cast<unsigned int>(state.range(0)));
+    }
+    for (auto _ : state) {
+        for (const BinomialTreeOption& option : ladder) {
+            benchmark::DoNotOptimize(option.price());
+        }
+    }
+    reportPerOption(state, static_cast<double>(ladder.size()));
+}
+BENCHMARK(BM_BinomialStrikeLadder)->Arg(100)->Arg(500);
+
+// Same 40 strikes on one lattice, interleaved through priceStrikes()
+void BM_BinomialLadder(benchmark::State& state) {
+    BinomialTreeOption tree(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American,
+                            static_cast<unsigned int>(state.range(0)));
+    std::vector<double> strikes;
+    for (int i = 0; i < 40; ++i) {
+        strikes.push_back(80.0 + i);
+    }
+    std::vector<double> out(strikes.size());
+    BinomialTreeOption::Workspace workspace;
+    for (auto _ : state) {
+        tree.priceStrikes(strikes.data(), nullptr, strikes.size(), out.data(), workspace);
+        benchmark::DoNotOptimize(out.data());
+    }
+    reportPerOption(state, static_cast<double>(strikes.size()));
+}
+BENCHMARK(BM_BinomialLadder)->Arg(100)->Arg(500);
+
+void BM_BinomialGreeks(benchmark::State& state) {
+    BinomialTreeOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American,
+                              static_cast<unsigned int>(state.range(0)));
+    TreeGreeksMethod method = static_cast<TreeGreeksMethod>(state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.calculateGreeks(method));
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_BinomialGreeks)
+    ->ArgsProduct({{100, 1000}, {static_cast<int>(TreeGreeksMethod::FiniteDifference),
+                                 static_cast<int>(TreeGreeksMethod::Lattice),
+                                 static_cast<int>(TreeGreeksMethod::LatticeAnalyticVega),
+                                 static_cast<int>(TreeGreeksMethod::Adjoint)}});
+
+void BM_TrinomialPrice(benchmark::State& state) {
+    TrinomialTreeOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American,
+                               static_cast<unsigned int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.price());
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_TrinomialPrice)->Arg(50)->Arg(100)->Arg(500)->Arg(1000);
+
+void BM_TrinomialGreeks(benchmark::State& state) {
+    TrinomialTreeOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American,
+                               static_cast<unsigned int>(state.range(0)));
+    TreeGreeksMethod method = static_cast<TreeGreeksMethod>(state.range(1));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.calculateGreeks(method));
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_TrinomialGreeks)
+    ->ArgsProduct({{100, 500}, {static_cast<int>(TreeGreeksMethod::FiniteDifference),
+                                static_cast<int>(TreeGreeksMethod::Lattice),
+                                static_cast<int>(TreeGreeksMethod::LatticeAnalyticVega),
+                                static_cast<int>(TreeGreeksMethod::Adjoint)}});
+
+// Closed-form American approximations; the argument is the AmericanApproximation
+
+void BM_AmericanApproximationPrice(benchmark::State& state) {
+    AmericanApproximation method = static_cast<AmericanApproximation>(state.range(0));
+    AmericanApproximationOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, method);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.price());
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_AmericanApproximationPrice)
+    ->Arg(static_cast<int>(AmericanApproximation::BaroneAdesiWhaley))
+    ->Arg(static_cast<int>(AmericanApproximation::BjerksundStensland));
+
+// Half calls, which take the Black-Scholes path, and half puts
+void BM_BatchAmericanApproximation(benchmark::State& state) {
+    std::size_t n = 10000;
+    AmericanApproximation method = static_cast<AmericanApproximation>(state.range(0));
+    SimdLevel level = static_cast<SimdLevel>(state.range(1));
+    state.SetLabel(simdLevelToString(resolveSimdLevel(level)));
+    OptionBatch batch = makeBatch(n);
+    std::vector<double> out(n);
+    for (auto _ : state) {
+        BatchAmericanApproximation::price(batch.view(), out.data(), method, level);
+        benchmark::DoNotOptimize(out.data());
+        benchmark::ClobberMemory();
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_BatchAmericanApproximation)
+    ->ArgsProduct({{static_cast<int>(AmericanApproximation::BaroneAdesiWhaley),
+                    static_cast<int>(AmericanApproximation::BjerksundStensland)},
+                   {static_cast<int>(SimdLevel::Scalar), static_cast<int>(SimdLevel::AVX2),
+                    static_cast<int>(SimdLevel::AVX512)}});
+
+// Finite differences on the same American put; the argument is the space
+// step count, with an eighth as many time steps
+
+void BM_FiniteDifferencePrice(benchmark::State& state) {
+    FiniteDifferenceSettings settings;
+    settings.spaceSteps = static_cast<unsigned int>(state.range(0));
+    settings.timeSteps = settings.spaceSteps / 8;
+    FiniteDifferenceOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American,
+                                  settings);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.gridGreeks());
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_FiniteDifferencePrice)->Arg(200)->Arg(400)->Arg(800)->Arg(1600);
+
+void BM_FiniteDifferenceLadder(benchmark::State& state) {
+    FiniteDifferenceOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American);
+    std::vector<double> strikes;
+    for (int i = 0; i < state.range(0); ++i) {
+        strikes.push_back(80.0 + 40.0 * i / state.range(0));
+    }
+    std::vector<double> prices(strikes.size());
+    FiniteDifferenceOption::Workspace workspace;
+    for (auto _ : state) {
+        option.priceStrikes(strikes.data(), strikes.size(), prices.data(), workspace);
+        benchmark::DoNotOptimize(prices.data());
+    }
+    reportPerOption(state, static_cast<double>(strikes.size()));
+}
+BENCHMARK(BM_FiniteDifferenceLadder)->Arg(1)->Arg(8)->Arg(32);
+
+// Price, delta, theta off the grid plus adjoint vega and rho; compare with
+// BM_FiniteDifferencePrice at the same argument
+void BM_FiniteDifferenceSensitivities(benchmark::State& state) {
+    FiniteDifferenceSettings settings;
+    settings.spaceSteps = static_cast<unsigned int>(state.range(0));
+    settings.timeSteps = settings.spaceSteps / 8;
+    FiniteDifferenceOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American,
+                                  settings);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option);
+        benchmark::DoNotOptimize(option.sensitivities());
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_FiniteDifferenceSensitivities)->Arg(400)->Arg(1600);
+
+// Implied volatility
+
+void BM_ImpliedVolatility(benchmark::State& state) {
+    double target = BlackScholesOption(100.0, 110.0, 0.05, 0.3, 0.5, OptionType::Call).price();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(target);
+        benchmark::DoNotOptimize(ImpliedVolatilityCalculator::calculateImpliedVolatility(
+            target, 100.0, 110.0, 0.05, 0.5, OptionType::Call));
+    }
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_ImpliedVolatility);
+
+void BM_ImpliedVolatilityBatch(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    SimdLevel level = static_cast<SimdLevel>(state.range(1));
+    state.SetLabel(simdLevelToString(resolveSimdLevel(level)));
+    std::vector<Contract> contracts = makeContracts(n);
+    std::vector<double> price(n), spot(n), strike(n), rate(n), time(n), vol(n);
+    std::vector<OptionType> type(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const Contract& c = contracts[i];
+        price[i] = BlackScholesOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type).price();
+        spot[i] = c.spot;
+        strike[i] = c.strike;
+        rate[i] = c.rate;
+        time[i] = c.time;
+        type[i] = c.type;
+    }
+    ImpliedVolBatchView view = {price.data(), spot.data(), strike.data(), rate.data(), time.data(),
+                                type.data(), n};
+    for (auto _ : state) {
+        ImpliedVolatilityCalculator::calculateImpliedVolatilities(view, vol.data(), nullptr, 1e-6, 100, level);
+        benchmark::DoNotOptimize(vol.data());
+        benchmark::ClobberMemory();
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_ImpliedVolatilityBatch)
+    ->ArgsProduct({{1000, 100000}, {static_cast<int>(SimdLevel::Scalar), static_cast<int>(SimdLevel::AVX512)}});
+
+// Single implied volatility requests through the batching service, per
+// thread count: submit 10k one at a time, then wait for all of them.
+// Compare with BM_ImpliedVolatility for the scalar solve.
+void BM_PricingServiceImpliedVol(benchmark::State& state) {
+    constexpr std::size_t n = 10000;
+    std::vector<Contract> contracts = makeContracts(n);
+    std::vector<double> price(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const Contract& c = contracts[i];
+        price[i] = BlackScholesOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type).price();
+    }
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(0)));
+    PricingService service(pool);
+    std::vector<PricingFuture<ImpliedVolResult>> futures(n);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < n; ++i) {
+            const Contract& c = contracts[i];
+            futures[i] = service.impliedVolatility(price[i], c.spot, c.strike, c.rate, c.time, c.type);
+        }
+        service.flush();
+        for (const PricingFuture<ImpliedVolResult>& future : futures) {
+            benchmark::DoNotOptimize(future.get());
+        }
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_PricingServiceImpliedVol)->Arg(1)->Arg(4)->UseRealTime();
+
+// A 1M-position file priced from its mapping into a mapped result file, per
+// thread count; the file is written once and stays in the page cache
+void BM_StreamingPricer(benchmark::State& state) {
+    constexpr std::size_t n = 1000000;
+    static const std::string positionsPath = [] {
+        std::string path = (std::filesystem::temp_directory_path() / "options_pricing_bench_positions.bin").string();
+        writePositionFile(path, makeBatch(n).view());
+        return path;
+    }();
+    std::string resultsPath = (std::filesystem::temp_directory_path() / "options_pricing_bench_results.bin").string();
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(0)));
+    StreamingSettings settings;
+    settings.columns = state.range(1) ? ResultColumns::All : ResultColumns::Price;
+    StreamingPricer pricer(settings);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pricer.run(positionsPath, resultsPath, pool));
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_StreamingPricer)->ArgsProduct({{1, 4}, {0, 1}})->UseRealTime();
+
+// Surface lookups for a mixed book against a 10 x 41 grid, then a batch price off them
+void BM_VolatilitySurfaceLookup(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    std::vector<double> expiries = {0.05, 0.1, 0.25, 0.5, 0.75, 1.0, 1.5, 2.0, 3.0, 5.0};
+    std::vector<double> strikes, grid;
+    for (int i = 0; i <= 40; ++i) {
+        strikes.push_back(50.0 + 2.5 * i);
+    }
+    for (double t : expiries) {
+        for (double k : strikes) {
+            double x = std::log(k / 100.0);
+            grid.push_back(0.2 - 0.05 * x + 0.1 * x * x / std::sqrt(t));
+        }
+    }
+    VolatilitySurface surface(expiries, strikes, grid);
+    OptionBatch batch = makeBatch(n);
+    OptionBatchView view = batch.view();
+    std::vector<double> vol(n), price(n);
+    view.volatility = vol.data();
+    for (auto _ : state) {
+        surface.volatilities(view, vol.data());
+        BatchBlackScholes::price(view, price.data());
+        benchmark::DoNotOptimize(price.data());
+        benchmark::ClobberMemory();
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_VolatilitySurfaceLookup)->Arg(1000)->Arg(100000);
+
+// Monte Carlo; the argument is the thread count, counters are per path
+
+void BM_MonteCarloEuropean(benchmark::State& state) {
+    MonteCarloSettings settings;
+    settings.maxPaths = 1 << 18;
+    MonteCarloOption option(100.0, 105.0, 0.05, 0.2, 1.0, OptionType::Call, settings);
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option.simulate(pool));
+    }
+    reportPerOption(state, static_cast<double>(settings.maxPaths));
+}
+BENCHMARK(BM_MonteCarloEuropean)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+void BM_MonteCarloAsian(benchmark::State& state) {
+    MonteCarloSettings settings;
+    settings.maxPaths = 1 << 16;
+    settings.timeSteps = 52;
+    settings.controlVariate = true;
+    MonteCarloOption option(100.0, 105.0, 0.05, 0.2, 1.0, OptionType::Call, settings);
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option.simulatePayoff(ArithmeticAsianCallPayoff{105.0}, pool));
+    }
+    reportPerOption(state, static_cast<double>(settings.maxPaths));
+}
+BENCHMARK(BM_MonteCarloAsian)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Same Asian with scrambled Sobol points; standard_error shows what the paths buy
+void BM_QuasiMonteCarloAsian(benchmark::State& state) {
+    MonteCarloSettings settings;
+    settings.maxPaths = 1 << 16;
+    settings.timeSteps = 52;
+    settings.sampling = MonteCarloSampling::Sobol;
+    MonteCarloOption option(100.0, 105.0, 0.05, 0.2, 1.0, OptionType::Call, settings);
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(0)));
+    MonteCarloResult result = {0.0, 0.0, 0};
+    for (auto _ : state) {
+        result = option.simulatePayoff(ArithmeticAsianCallPayoff{105.0}, pool);
+        benchmark::DoNotOptimize(result);
+    }
+    reportPerOption(state, static_cast<double>(settings.maxPaths));
+    state.counters["standard_error"] = result.standardError;
+}
+BENCHMARK(BM_QuasiMonteCarloAsian)->Arg(1)->Arg(2)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// BM_MonteCarloAsian's paths with pathwise delta, vega, rho and theta
+void BM_MonteCarloAsianSensitivities(benchmark::State& state) {
+    MonteCarloSettings settings;
+    settings.maxPaths = 1 << 16;
+    settings.timeSteps = 52;
+    settings.controlVariate = true;
+    MonteCarloOption option(100.0, 105.0, 0.05, 0.2, 1.0, OptionType::Call, settings);
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(option.sensitivitiesPayoff(ArithmeticAsianCallPayoff{105.0}, pool));
+    }
+    reportPerOption(state, static_cast<double>(settings.maxPaths));
+}
+BENCHMARK(BM_MonteCarloAsianSensitivities)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Portfolios at 1k/100k/1M positions; the second argument is the thread count
+
+void BM_PortfolioValue(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const OptionPortfolio& portfolio = cachedPortfolio(n);
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(1)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(portfolio.totalValue(pool));
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_PortfolioValue)
+    ->ArgsProduct({{1000, 100000, 1000000}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Building and tearing down a 1M-position book: the factory by name (0), by
+// PricingMethod (1), or emplaced into the portfolio's arena (2)
+void BM_PortfolioBuild(benchmark::State& state) {
+    constexpr std::size_t n = 1000000;
+    static const std::vector<Contract> contracts = makeContracts(n);
+    int path = static_cast<int>(state.range(0));
+    OptionPortfolio portfolio;
+    for (auto _ : state) {
+        portfolio.reserve(n);
+        for (const Contract& c : contracts) {
+            if (path == 0) {
+                portfolio.addOption(OptionFactory::createOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type,
+                                                                ExerciseType::European, "BlackScholes"));
+            } else if (path == 1) {
+                portfolio.addOption(OptionFactory::createOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type,
+                                                                ExerciseType::European, PricingMethod::BlackScholes));
+            } else {
+                portfolio.emplaceOption(c.spot, c.strike, c.rate, c.vol, c.time, c.type, ExerciseType::European,
+                                        PricingMethod::BlackScholes);
+            }
+        }
+        portfolio.clear();
+    }
+    state.SetLabel(path == 0 ? "string" : path == 1 ? "enum" : "arena");
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_PortfolioBuild)->Arg(0)->Arg(1)->Arg(2)->Unit(benchmark::kMillisecond);
+
+void BM_GroupedPortfolioRisk(benchmark::State& state) {
+    std::size_t n = static_cast<std::size_t>(state.range(0));
+    const GroupedPortfolio& portfolio = cachedGroupedPortfolio(n);
+    WorkStealingPool pool(static_cast<std::size_t>(state.range(1)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(portfolio.risk(pool));
+    }
+    reportPerOption(state, static_cast<double>(n));
+}
+BENCHMARK(BM_GroupedPortfolioRisk)
+    ->ArgsProduct({{1000, 100000, 1000000}, {1, 2, 4, 8}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Scenario queries on 40 American tree puts, by Taylor expansion (0) or full repricing (1)
+void BM_PortfolioScenario(benchmark::State& state) {
+    bool full = state.range(0) != 0;
+    OptionPortfolio portfolio;
+    for (int i = 0; i < 40; ++i) {
+        portfolio.addOption(std::make_unique<BinomialTreeOption>(100.0, 80.0 + i, 0.05, 0.2, 1.0, OptionType::Put,
+                                                                 ExerciseType::American, 200u));
+    }
+    portfolio.snapshotGreeks();
+    RiskScenario scenario{0.02, 0.01, 1.0 / 365.0};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(full ? portfolio.fullScenarioValue(scenario) : portfolio.scenarioValue(scenario));
+    }
+    state.SetLabel(full ? "full" : "taylor");
+    state.counters["max_abs_error"] = portfolio.taylorErrorStats().maxAbsError;
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_PortfolioScenario)->Arg(0)->Arg(1);
+
+// One spot tick on a 5000-position book over 500 underlyings and three
+// expiries each; the argument selects a full revaluation (0) or the
+// incremental one (1). Counters are per tick.
+void BM_IncrementalPortfolioTick(benchmark::State& state) {
+    bool incremental = state.range(0) != 0;
+    const std::size_t underlyings = 500;
+    const double expiries[3] = {0.25, 0.5, 1.0};
+    IncrementalPortfolio book;
+    for (std::size_t u = 0; u < underlyings; ++u) {
+        book.addUnderlying(100.0, 0.05, 0.2);
+    }
+    for (std::size_t i = 0; i < 5000; ++i) {
+        bool american = i % 4 == 3;
+        book.addPosition(i % underlyings, 80.0 + static_cast<double>(i % 41), expiries[i % 3],
+                         i % 2 ? OptionType::Put : OptionType::Call,
+                         american ? ExerciseType::American : ExerciseType::European,
+                         american ? "BaroneAdesiWhaley" : "BlackScholes");
+    }
+    book.risk();
+    std::size_t tick = 0;
+    for (auto _ : state) {
+        std::size_t u = tick++ % underlyings;
+        book.updateSpot(u, 100.0 + 0.01 * static_cast<double>(tick % 7));
+        if (!incremental) {
+            for (std::size_t other = 0; other < underlyings; ++other) {
+                book.updateSpot(other, 100.0 + 0.01 * static_cast<double>(tick % 7));
+            }
+        }
+        benchmark::DoNotOptimize(book.risk());
+    }
+    state.SetLabel(incremental ? "incremental" : "full");
+    reportPerOption(state, 1);
+}
+BENCHMARK(BM_IncrementalPortfolioTick)->Arg(0)->Arg(1);
+
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::AddCustomContext("simd_level", simdLevelToString(activeSimdLevel()));
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
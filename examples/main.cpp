@@ -5,6 +5,8 @@
  * to price various options and calculate Greeks.
  */
 
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
 #include <iomanip>
 #include <memory>
@@ -20,6 +22,7 @@
 // #include <OptionsPricing/Portfolio.hpp>
 
 #include "options_pricing.h"
+#include "OptionsPricing/PositionFile.hpp"
 
 // Using the namespace to simplify code
 using namespace OptionsPricing;
@@ -181,6 +184,15 @@ void binomialTreeExample() {
     std::cout << "Early Exercise Premium (Call): " << callPremium << "\n";
     std::cout << "Early Exercise Premium (Put): " << putPremium << "\n";
     std::cout << std::endl;
+    
+    // A strike ladder of American puts, all on the put's lattice
+    std::vector<double> ladderStrikes = {90.0, 95.0, 100.0, 105.0, 110.0};
+    std::vector<double> ladderPrices = amPutOption.priceStrikes(ladderStrikes);
+    std::cout << "American Put Strike Ladder (one lattice):\n";
+    for (std::size_t i = 0; i < ladderStrikes.size(); ++i) {
+        std::cout << "  K = " << ladderStrikes[i] << ": " << ladderPrices[i] << "\n";
+    }
+    std::cout << std::endl;
     };
 
 // Example 3: Trinomial Tree for American options
@@ -359,6 +371,33 @@ void optionFactoryAndPortfolioExample() {
     std::cout << "Portfolio Delta: " << portfolioDelta << "\n";
     std::cout << "Portfolio Gamma: " << portfolioGamma << "\n";
     std::cout << std::endl;
+    
+    // Scenario P&L from cached Greeks, against full repricing
+    portfolio.snapshotGreeks();
+    std::cout << "Spot Shift\tTaylor P&L\tFull P&L\n";
+    for (double shift = -0.1; shift <= 0.101; shift += 0.05) {
+        RiskScenario scenario{shift, 0.0, 1.0 / 365.0};
+        ScenarioResult taylor = portfolio.scenarioValue(scenario);
+        ScenarioResult full = portfolio.fullScenarioValue(scenario);
+        std::cout << shift * 100.0 << "%\t\t" << taylor.pnl << (taylor.repriced ? " (repriced)" : "")
+                  << "\t" << full.pnl << "\n";
+    }
+    std::cout << "Max Taylor error seen: " << portfolio.taylorErrorStats().maxAbsError << "\n";
+    std::cout << std::endl;
+    
+    // The same book kept live against market updates
+    IncrementalPortfolio live;
+    std::size_t underlying = live.addUnderlying(100.0, 0.05, 0.2);
+    live.addPosition(underlying, 100.0, 1.0, OptionType::Call, ExerciseType::European, "BlackScholes", 100, 1.0);
+    live.addPosition(underlying, 90.0, 1.0, OptionType::Put, ExerciseType::European, "BlackScholes", 100, 2.0);
+    live.addPosition(underlying, 110.0, 1.0, OptionType::Call, ExerciseType::American, "BinomialTree", 100, 1.0);
+    live.addPosition(underlying, 100.0, 1.0, OptionType::Put, ExerciseType::American, "TrinomialTree", 80, 1.0);
+    std::cout << "Live Book Value: " << live.risk().value << "\n";
+    live.updateSpot(underlying, 101.0);
+    PositionRisk ticked = live.risk();
+    std::cout << "After a spot tick to 101: " << ticked.value << " (delta " << ticked.delta
+              << ", " << live.lastRevalued() << " positions repriced)\n";
+    std::cout << std::endl;
 };
 
 // Example 6: Convergence Analysis
@@ -397,6 +436,26 @@ void convergenceAnalysisExample() {
     }
     std::cout << std::endl;
     
+    // Leisen-Reimer with Richardson extrapolation converges without the odd/even oscillation
+    std::cout << "Leisen-Reimer + Richardson Convergence Analysis:\n";
+    std::cout << "Steps\tPrice\t\tError\t\tRelative Error\n";
+    
+    for (unsigned int steps = 11; steps <= 1000; steps = 2 * steps - 1) {
+        BinomialTreeSettings settings;
+        settings.steps = steps;
+        settings.parametrization = BinomialParametrization::LeisenReimer;
+        settings.richardson = true;
+        BinomialTreeOption lrOption(spot, strike, riskFreeRate, volatility,
+                                    timeToMaturity, OptionType::Call,
+                                    ExerciseType::European, settings);
+        double lrPrice = lrOption.price();
+        double error = std::abs(lrPrice - bsPrice);
+        double relError = error / bsPrice * 100.0;
+        
+        std::cout << steps << "\t" << lrPrice << "\t" << error << "\t" << relError << "%\n";
+    }
+    std::cout << std::endl;
+    
     // Convergence analysis for trinomial tree
     std::cout << "Trinomial Tree Convergence Analysis:\n";
     std::cout << "Steps\tPrice\t\tError\t\tRelative Error\n";
@@ -414,6 +473,334 @@ void convergenceAnalysisExample() {
     std::cout << std::endl;
 };
 
+// Example 7: Batch Black-Scholes over structure-of-arrays inputs
+void batchBlackScholesExample() {
+    std::cout << "==========================================\n";
+    std::cout << "Example 7: Batch Black-Scholes Pricing\n";
+    std::cout << "==========================================\n";
+    
+    // A small strike ladder of calls and puts
+    OptionBatch batch;
+    for (double strike = 80.0; strike <= 120.0; strike += 10.0) {
+        batch.add(100.0, strike, 0.05, 0.2, 1.0, OptionType::Call);
+        batch.add(100.0, strike, 0.05, 0.2, 1.0, OptionType::Put);
+    }
+    BatchBlackScholes::validateInputs(batch.view());
+    
+    std::vector<double> prices = BatchBlackScholes::price(batch);
+    OptionBatchView view = batch.view();
+    
+    // The same batch in single precision, for screening
+    std::vector<float> floatPrices = BatchBlackScholes::price(FloatOptionBatch(view));
+    
+    std::cout << "SIMD level: " << simdLevelToString(activeSimdLevel()) << "\n";
+    std::cout << "Strike\tType\tBatch\t\tFloat\t\tScalar\n";
+    for (std::size_t i = 0; i < view.size; ++i) {
+        BlackScholesOption option(view.spot[i], view.strike[i], view.riskFreeRate[i],
+                                  view.volatility[i], view.timeToMaturity[i], view.type[i]);
+        std::cout << view.strike[i] << "\t" << optionTypeToString(view.type[i]) << "\t"
+                  << prices[i] << "\t\t" << floatPrices[i] << "\t\t" << option.price() << "\n";
+    }
+    std::cout << std::endl;
+};
+
+// Example 8: Monte Carlo for European and Asian options
+void monteCarloExample() {
+    std::cout << "==========================================\n";
+    std::cout << "Example 8: Monte Carlo Pricing\n";
+    std::cout << "==========================================\n";
+    
+    MonteCarloSettings settings;
+    settings.maxPaths = 1 << 20;
+    settings.targetStandardError = 0.01;
+    MonteCarloOption european(100.0, 105.0, 0.05, 0.2, 1.0, OptionType::Call, settings);
+    MonteCarloResult result = european.simulate();
+    BlackScholesOption reference(100.0, 105.0, 0.05, 0.2, 1.0, OptionType::Call);
+    std::cout << "European call: " << result.price << " +/- " << result.standardError
+              << " (" << result.paths << " paths), Black-Scholes: " << reference.price() << "\n";
+    
+    // Weekly-averaged Asian call, with the vanilla call as control variate
+    settings.timeSteps = 52;
+    settings.controlVariate = true;
+    MonteCarloOption asian(100.0, 105.0, 0.05, 0.2, 1.0, OptionType::Call, settings);
+    WorkStealingPool pool;
+    result = asian.simulatePayoff(ArithmeticAsianCallPayoff{105.0}, pool);
+    std::cout << "Asian call:    " << result.price << " +/- " << result.standardError
+              << " (" << result.paths << " paths)\n";
+    
+    // Same Asian with scrambled Sobol points; the error is the spread over scramblings
+    settings.sampling = MonteCarloSampling::Sobol;
+    settings.controlVariate = false;
+    MonteCarloOption quasi(100.0, 105.0, 0.05, 0.2, 1.0, OptionType::Call, settings);
+    result = quasi.simulatePayoff(ArithmeticAsianCallPayoff{105.0}, pool);
+    std::cout << "Asian call QMC: " << result.price << " +/- " << result.standardError
+              << " (" << result.paths << " paths)\n";
+    std::cout << std::endl;
+};
+
+// Example 9: American put on a finite-difference grid against the binomial tree
+void finiteDifferenceExample() {
+    std::cout << "==========================================\n";
+    std::cout << "Example 9: Finite-Difference American Put\n";
+    std::cout << "==========================================\n";
+    
+    BinomialTreeOption tree(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American, 1000);
+    std::cout << "Binomial (1000 steps): " << tree.price() << "\n";
+    std::cout << "Space\tTime\tPrice\t\tDelta\t\tGamma\t\tTheta\n";
+    for (unsigned int space = 100; space <= 1600; space *= 2) {
+        FiniteDifferenceSettings settings;
+        settings.spaceSteps = space;
+        settings.timeSteps = space / 8;
+        FiniteDifferenceOption option(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put,
+                                      ExerciseType::American, settings);
+        FiniteDifferenceOption::GridGreeks greeks = option.gridGreeks();
+        std::cout << space << "\t" << settings.timeSteps << "\t" << greeks.value << "\t" << greeks.delta
+                  << "\t" << greeks.gamma << "\t" << greeks.theta << "\n";
+    }
+    
+    // A strike ladder on one grid
+    FiniteDifferenceOption ladder(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American);
+    std::vector<double> strikes = {80.0, 90.0, 100.0, 110.0, 120.0};
+    std::vector<double> prices = ladder.priceStrikes(strikes);
+    std::cout << "Strike\tPrice\n";
+    for (std::size_t i = 0; i < strikes.size(); ++i) {
+        std::cout << strikes[i] << "\t" << prices[i] << "\n";
+    }
+    std::cout << std::endl;
+};
+
+// Example 10: Closed-form American approximations against the finite-difference grid
+void americanApproximationExample() {
+    std::cout << "==========================================\n";
+    std::cout << "Example 10: American Approximations\n";
+    std::cout << "==========================================\n";
+    
+    OptionBatch batch;
+    for (double strike = 80.0; strike <= 120.0; strike += 10.0) {
+        batch.add(100.0, strike, 0.05, 0.2, 1.0, OptionType::Put);
+    }
+    std::vector<double> whaley = BatchAmericanApproximation::price(batch, AmericanApproximation::BaroneAdesiWhaley);
+    std::vector<double> stensland = BatchAmericanApproximation::price(batch, AmericanApproximation::BjerksundStensland);
+    
+    std::cout << "Strike\tBAW\t\tBS2002\t\tGrid\n";
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        double strike = 80.0 + 10.0 * i;
+        FiniteDifferenceOption grid(100.0, strike, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American);
+        std::cout << strike << "\t" << whaley[i] << "\t" << stensland[i] << "\t" << grid.price() << "\n";
+    }
+    std::cout << std::endl;
+};
+
+// Example 11: Fitting a volatility surface to quotes and pricing off it
+void volatilitySurfaceExample() {
+    std::cout << "==========================================\n";
+    std::cout << "Example 11: Volatility Surface\n";
+    std::cout << "==========================================\n";
+    
+    // Quotes from a smile that steepens towards short expiries
+    std::vector<double> expiries = {0.25, 0.5, 1.0};
+    std::vector<double> strikes = {80.0, 90.0, 100.0, 110.0, 120.0};
+    std::vector<double> quotes;
+    std::vector<OptionType> types;
+    for (double t : expiries) {
+        for (double k : strikes) {
+            double x = std::log(k / 100.0);
+            OptionType type = k < 100.0 ? OptionType::Put : OptionType::Call;
+            double vol = 0.2 - 0.05 * x + 0.1 * x * x / std::sqrt(t);
+            quotes.push_back(BlackScholesOption(100.0, k, 0.05, vol, t, type).price());
+            types.push_back(type);
+        }
+    }
+    
+    VolatilitySurface surface(expiries, strikes, std::vector<double>(quotes.size(), 0.2));
+    std::size_t converged = surface.fitImpliedVolatilities(quotes.data(), types.data(), 100.0, 0.05);
+    std::cout << "Converged nodes: " << converged << " of " << quotes.size() << "\n";
+    
+    std::cout << "Strike\tT = 0.25\tT = 0.75\n";
+    for (double k = 85.0; k <= 115.0; k += 10.0) {
+        std::cout << k << "\t" << surface.volatility(k, 0.25) << "\t" << surface.volatility(k, 0.75) << "\n";
+    }
+    std::cout << std::endl;
+};
+
+// Example 12: Adjoint sensitivities from each engine against Black-Scholes
+void adjointSensitivitiesExample() {
+    std::cout << "==========================================\n";
+    std::cout << "Example 12: Adjoint Sensitivities\n";
+    std::cout << "==========================================\n";
+    
+    BinomialTreeSettings treeSettings;
+    treeSettings.steps = 1001;
+    treeSettings.parametrization = BinomialParametrization::LeisenReimer;
+    BinomialTreeOption binomial(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::European,
+                                treeSettings);
+    TrinomialTreeOption trinomial(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::European, 400);
+    FiniteDifferenceOption grid(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::European);
+    MonteCarloSettings mcSettings;
+    mcSettings.sampling = MonteCarloSampling::Sobol;
+    MonteCarloOption monteCarlo(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, mcSettings);
+    
+    auto print = [](const char* engine, const Sensitivities& s) {
+        std::cout << engine << "\t" << s.price << "\t" << s.delta << "\t" << s.vega << "\t"
+                  << s.rho << "\t" << s.theta << "\n";
+    };
+    std::cout << "Engine\t\tPrice\tDelta\tVega\tRho\tTheta\n";
+    print("Black-Scholes", BlackScholesOption(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put).sensitivities());
+    print("Binomial", binomial.sensitivities());
+    print("Trinomial", trinomial.sensitivities());
+    print("Grid\t", grid.sensitivities());
+    print("Monte Carlo", monteCarlo.sensitivities().estimate);
+    
+    // American put: delta, theta and vega from the sweep, gamma from the lattice
+    BinomialTreeOption american(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American, 1000);
+    BinomialTreeOption::Greeks greeks = american.calculateGreeks(TreeGreeksMethod::Adjoint);
+    std::cout << "American put delta " << greeks.delta << ", gamma " << greeks.gamma
+              << ", theta " << greeks.theta << ", vega " << greeks.vega << "\n";
+
+    // A coarse tree at a high rate and low vol has a negative branch
+    // probability, so node adjoints go negative; the sweep still matches bumps
+    auto coarse = [](double spot) {
+        return BinomialTreeOption(spot, 100.0, 0.30, 0.01, 1.0, OptionType::Call, ExerciseType::European, 4);
+    };
+    double bumpedDelta = (coarse(100.01).price() - coarse(99.99).price()) / 0.02;
+    std::cout << "Negative-probability tree delta " << coarse(100.0).sensitivities().delta
+              << ", central bump " << bumpedDelta << "\n";
+    std::cout << std::endl;
+};
+
+// Example 13: Streaming a position file through the batch kernels
+void streamingPricerExample() {
+    std::cout << "==========================================\n";
+    std::cout << "Example 13: Streaming a Position File\n";
+    std::cout << "==========================================\n";
+    
+    std::string positionsPath = (std::filesystem::temp_directory_path() / "example_positions.bin").string();
+    std::string resultsPath = (std::filesystem::temp_directory_path() / "example_results.bin").string();
+    
+    // A 200k-position book written straight into the mapped file
+    const std::size_t count = 200000;
+    {
+        PositionFileWriter writer(positionsPath, count);
+        for (std::size_t i = 0; i < count; ++i) {
+            double strike = 80.0 + static_cast<double>(i % 41);
+            writer.set(i, 100.0, strike, 0.05, 0.2, 0.25 + static_cast<double>(i % 8) * 0.25,
+                       i % 2 == 0 ? OptionType::Call : OptionType::Put);
+        }
+    }
+    
+    WorkStealingPool pool(4);
+    StreamingSettings settings;
+    settings.columns = ResultColumns::Price | ResultColumns::Delta | ResultColumns::Vega;
+    StreamingPricer(settings).run(positionsPath, resultsPath, pool);
+    
+    {
+        ResultFile results(resultsPath);
+        PositionFile positions(positionsPath);
+        const double* price = results.column(ResultColumns::Price);
+        const double* delta = results.column(ResultColumns::Delta);
+        double value = 0.0;
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            value += price[i];
+        }
+        OptionBatchView first = positions.chunk(0, 1);
+        BlackScholesOption check(first.spot[0], first.strike[0], first.riskFreeRate[0], first.volatility[0],
+                                 first.timeToMaturity[0], first.type[0]);
+        std::cout << "Positions: " << results.size() << ", book value: " << value << "\n";
+        std::cout << "First position: price " << price[0] << " (scalar " << check.price() << "), delta "
+                  << delta[0] << "\n";
+    }
+    std::remove(positionsPath.c_str());
+    std::remove(resultsPath.c_str());
+    std::cout << std::endl;
+};
+
+// Example 14: Engine counters and latency, exported for Prometheus
+void metricsExample() {
+    std::cout << "==========================================\n";
+    std::cout << "Example 14: Engine Metrics\n";
+    std::cout << "==========================================\n";
+    
+    if (!metricsEnabled) {
+        std::cout << "Built without OPTIONS_PRICING_ENABLE_METRICS; counters stay at zero\n";
+        std::cout << std::endl;
+        return;
+    }
+    
+    MetricsSnapshot before = metricsSnapshot();
+    BinomialTreeOption american(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American, 500);
+    american.price();
+    american.price();
+    ImpliedVolatilityCalculator::calculateImpliedVolatility(10.45, 100.0, 100.0, 0.05, 1.0, OptionType::Call);
+    try {
+        // Below intrinsic: no volatility fits
+        ImpliedVolatilityCalculator::calculateImpliedVolatility(0.01, 150.0, 100.0, 0.05, 1.0, OptionType::Call);
+    } catch (const std::exception&) {
+    }
+    MetricsSnapshot delta = metricsSnapshot().since(before);
+    
+    const EngineMetrics& tree = delta[MetricEngine::BinomialTree];
+    const EngineMetrics& iv = delta[MetricEngine::ImpliedVolatility];
+    std::cout << "Binomial tree: " << tree[MetricCounter::Calls] << " calls, " << tree[MetricCounter::Nodes]
+              << " nodes, " << tree.latency.sumNanos / 1000 << " us\n";
+    std::cout << "Implied volatility: " << iv[MetricCounter::Calls] << " calls, "
+              << iv[MetricCounter::Iterations] << " iterations, " << iv[MetricCounter::Failures]
+              << " failures\n";
+    
+    std::string text = prometheusMetrics();
+    std::cout << text.substr(0, text.find("# HELP", 1));
+    std::cout << std::endl;
+};
+
+// Example 15: Single requests batched by the pricing service
+void pricingServiceExample() {
+    std::cout << "==========================================\n";
+    std::cout << "Example 15: Pricing Service\n";
+    std::cout << "==========================================\n";
+    
+    WorkStealingPool pool(4);
+    PricingServiceSettings settings;
+    settings.window = std::chrono::microseconds(100);
+    settings.tree.steps = 500;
+    PricingService service(pool, settings);
+    
+    // Callers submit one request at a time; the service batches them
+    std::vector<PricingFuture<double>> americanPuts;
+    for (double strike = 90.0; strike <= 110.0; strike += 5.0) {
+        americanPuts.push_back(
+            service.priceTree(100.0, strike, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American));
+    }
+    PricingFuture<BlackScholesOption::FullGreeks> greeks =
+        service.greeks(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Call);
+    PricingFuture<ImpliedVolResult> iv = service.impliedVolatility(10.45, 100.0, 100.0, 0.05, 1.0, OptionType::Call);
+    
+    std::cout << "American puts, strikes 90-110:";
+    for (const PricingFuture<double>& put : americanPuts) {
+        std::cout << " " << put.get();
+    }
+    std::cout << "\nATM call delta " << greeks.get().delta << ", implied volatility of 10.45: "
+              << iv.get().volatility << "\n";
+    std::cout << std::endl;
+};
+
+void exerciseBoundaryExample() {
+    std::cout << "==========================================\n";
+    std::cout << "Example 16: Early-Exercise Boundary\n";
+    std::cout << "==========================================\n";
+    
+    BinomialTreeOption put(100.0, 100.0, 0.05, 0.2, 1.0, OptionType::Put, ExerciseType::American, 1000);
+    ExerciseBoundary boundary;
+    BinomialTreeOption::Workspace workspace;
+    double value = put.price(workspace, boundary);
+    
+    // Exercise is optimal at or below the critical spot of each step
+    std::cout << "American put " << value << "; critical spot by time:\n";
+    for (double time : {0.25, 0.5, 0.75, 0.95}) {
+        std::size_t step = static_cast<std::size_t>(time / boundary.dt + 0.5);
+        std::cout << "  t = " << time << ": " << boundary.spots[step] << "\n";
+    }
+    std::cout << std::endl;
+};
+
 int main() {
     try {
         // Run all examples
@@ -423,6 +810,16 @@ int main() {
         impliedVolatilityExample();
         optionFactoryAndPortfolioExample();
         convergenceAnalysisExample();
+        batchBlackScholesExample();
+        monteCarloExample();
+        finiteDifferenceExample();
+        americanApproximationExample();
+        volatilitySurfaceExample();
+        adjointSensitivitiesExample();
+        streamingPricerExample();
+        metricsExample();
+        pricingServiceExample();
+        exerciseBoundaryExample();
         
         return 0;
     } catch (const std::exception& e) {
@@ -0,0 +1,152 @@
+#ifndef OPTIONS_PRICING_ADJOINT_HPP
+#define OPTIONS_PRICING_ADJOINT_HPP
+
+#include <cmath>
+#include <cstddef>
+
+namespace OptionsPricing {
+
+// Price and first-order sensitivities from one adjoint (reverse-mode) sweep,
+// in the units of BlackScholesOption::Greeks: vega and rho per 1% change,
+// theta per year of calendar time (minus the derivative in maturity)
+struct Sensitivities {
+    double price;
+    double delta;
+    double vega;
+    double rho;
+    double theta;
+};
+
+namespace detail {
+
+// Raw derivatives with respect to spot, volatility, rate and maturity
+enum AdjointInput : std::size_t { AdjointSpot, AdjointVolatility, AdjointRate, AdjointMaturity, adjointInputs };
+
+inline Sensitivities sensitivitiesFrom(double price, const double* derivatives) {
+    return {price, derivatives[AdjointSpot], derivatives[AdjointVolatility] / 100.0,
+            derivatives[AdjointRate] / 100.0, -derivatives[AdjointMaturity]};
+}
+
+inline void derivativesFrom(const Sensitivities& s, double* derivatives) {
+    derivatives[AdjointSpot] = s.delta;
+    derivatives[AdjointVolatility] = 100.0 * s.vega;
+    derivatives[AdjointRate] = 100.0 * s.rho;
+    derivatives[AdjointMaturity] = -s.theta;
+}
+
+// Forward-mode dual number carrying derivatives in N directions. The engines
+// write their O(1) lattice and grid set-up once over Dual, so the adjoint
+// sweeps only have to be written by hand for the O(steps^2) parts.
+template <std::size_t N>
+struct Dual {
+    double v;
+    double d[N];
+
+    Dual(double value = 0.0) : v(value), d{} {}
+
+    // An input: value with a unit derivative in direction k
+    static Dual variable(double value, std::size_t k) {
+        Dual x(value);
+        x.d[k] = 1.0;
+        return x;
+    }
+};
+
+template <std::size_t N>
+Dual<N> scaled(const Dual<N>& a, double value, double slope) {
+    Dual<N> r(value);
+    for (std::size_t k = 0; k < N; ++k) {
+        r.d[k] = slope * a.d[k];
+    }
+    return r;
+}
+
+template <std::size_t N>
+Dual<N> operator+(const Dual<N>& a, const Dual<N>& b) {
+    Dual<N> r(a.v + b.v);
+    for (std::size_t k = 0; k < N; ++k) {
+        r.d[k] = a.d[k] + b.d[k];
+    }
+    return r;
+}
+
+template <std::size_t N>
+Dual<N> operator-(const Dual<N>& a, const Dual<N>& b) {
+    Dual<N> r(a.v - b.v);
+    for (std::size_t k = 0; k < N; ++k) {
+        r.d[k] = a.d[k] - b.d[k];
+    }
+    return r;
+}
+
+template <std::size_t N>
+Dual<N> operator-(const Dual<N>& a) {
+    return scaled(a, -a.v, -1.0);
+}
+
+template <std::size_t N>
+Dual<N> operator*(const Dual<N>& a, const Dual<N>& b) {
+    Dual<N> r(a.v * b.v);
+    for (std::size_t k = 0; k < N; ++k) {
+        r.d[k] = a.d[k] * b.v + a.v * b.d[k];
+    }
+    return r;
+}
+
+template <std::size_t N>
+Dual<N> operator/(const Dual<N>& a, const Dual<N>& b) {
+    Dual<N> r(a.v / b.v);
+    for (std::size_t k = 0; k < N; ++k) {
+        r.d[k] = (a.d[k] - r.v * b.d[k]) / b.v;
+    }
+    return r;
+}
+
+template <std::size_t N> Dual<N> operator+(const Dual<N>& a, double b) { return a + Dual<N>(b); }
+template <std::size_t N> Dual<N> operator+(double a, const Dual<N>& b) { return Dual<N>(a) + b; }
+template <std::size_t N> Dual<N> operator-(const Dual<N>& a, double b) { return a - Dual<N>(b); }
+template <std::size_t N> Dual<N> operator-(double a, const Dual<N>& b) { return Dual<N>(a) - b; }
+template <std::size_t N> Dual<N> operator*(const Dual<N>& a, double b) { return scaled(a, a.v * b, b); }
+template <std::size_t N> Dual<N> operator*(double a, const Dual<N>& b) { return scaled(b, a * b.v, a); }
+template <std::size_t N> Dual<N> operator/(const Dual<N>& a, double b) { return scaled(a, a.v / b, 1.0 / b); }
+template <std::size_t N> Dual<N> operator/(double a, const Dual<N>& b) { return Dual<N>(a) / b; }
+
+template <std::size_t N>
+Dual<N> exp(const Dual<N>& a) {
+    double e = std::exp(a.v);
+    return scaled(a, e, e);
+}
+
+template <std::size_t N>
+Dual<N> log(const Dual<N>& a) {
+    return scaled(a, std::log(a.v), 1.0 / a.v);
+}
+
+template <std::size_t N>
+Dual<N> sqrt(const Dual<N>& a) {
+    double s = std::sqrt(a.v);
+    return scaled(a, s, 0.5 / s);
+}
+
+// Magnitude of a with the sign of b, which is locally constant
+template <std::size_t N>
+Dual<N> copysign(const Dual<N>& a, const Dual<N>& b) {
+    return std::signbit(a.v) == std::signbit(b.v) ? a : -a;
+}
+
+template <std::size_t N>
+double dot(const Dual<N>& a, const double* weights) {
+    double sum = 0.0;
+    for (std::size_t k = 0; k < N; ++k) {
+        sum += a.d[k] * weights[k];
+    }
+    return sum;
+}
+
+using AdjointDual = Dual<adjointInputs>;
+
+} // namespace detail
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_ADJOINT_HPP
@@ -0,0 +1,215 @@
+#ifndef OPTIONS_PRICING_AMERICAN_APPROXIMATION_HPP
+#define OPTIONS_PRICING_AMERICAN_APPROXIMATION_HPP
+
+#include "Common.hpp"
+#include "BatchBlackScholes.hpp"
+#include "Metrics.hpp"
+#include "Simd.hpp"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace OptionsPricing {
+
+enum class AmericanApproximation {
+    BaroneAdesiWhaley,   // quadratic approximation, Newton solve for the critical price
+    BjerksundStensland   // 2002 two-step flat exercise boundary, closed form
+};
+
+namespace detail {
+
+// Genz's Gauss-Legendre rule for the bivariate normal, specialised to the
+// single correlation rho = sqrt(t1 / T) = sqrt((sqrt(5) - 1) / 2) that
+// Bjerksund-Stensland needs, so the sines are taken once rather than per
+// call. At that rho twelve points already agree with Genz's twenty to 1e-15.
+struct BivariateQuadrature {
+    static constexpr std::size_t points = 12;
+    double sine[points];
+    double inverseCosine2[points];  // 1 / (1 - sine^2)
+    double weight[points];
+    double scale;                   // asin(rho) / (4 pi)
+};
+
+inline BivariateQuadrature makeStenslandQuadrature() {
+    static const double nodes[6] = {
+        -0.9815606342467191, -0.9041172563704750, -0.7699026741943050,
+        -0.5873179542866171, -0.3678314989981802, -0.1252334085114692};
+    static const double weights[6] = {
+        0.04717533638651177, 0.1069393259953183, 0.1600783285433464,
+        0.2031674267230659, 0.2334925365383547, 0.2491470458134029};
+
+    BivariateQuadrature q;
+    double asr = std::asin(std::sqrt(0.5 * (std::sqrt(5.0) - 1.0)));
+    for (std::size_t i = 0; i < 6; ++i) {
+        double sines[2] = {std::sin(asr * (nodes[i] + 1.0) / 2.0), std::sin(asr * (1.0 - nodes[i]) / 2.0)};
+        for (std::size_t k = 0; k < 2; ++k) {
+            q.sine[2 * i + k] = sines[k];
+            q.inverseCosine2[2 * i + k] = 1.0 / (1.0 - sines[k] * sines[k]);
+            q.weight[2 * i + k] = weights[i];
+        }
+    }
+    q.scale = asr / (4.0 * PI);
+    return q;
+}
+
+inline const BivariateQuadrature& stenslandQuadrature() {
+    static const BivariateQuadrature q = makeStenslandQuadrature();
+    return q;
+}
+
+} // namespace detail
+
+namespace simd {
+
+namespace scalar {
+#include "detail/AmericanApproximationKernels.inl"
+} // namespace scalar
+
+#if defined(OPTIONS_PRICING_SIMD_X86)
+OPTIONS_PRICING_BEGIN_TARGET_AVX2
+namespace avx2 {
+#include "detail/AmericanApproximationKernels.inl"
+} // namespace avx2
+OPTIONS_PRICING_END_TARGET
+
+OPTIONS_PRICING_BEGIN_TARGET_AVX512
+namespace avx512 {
+#include "detail/AmericanApproximationKernels.inl"
+} // namespace avx512
+OPTIONS_PRICING_END_TARGET_AVX512
+#endif
+
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+namespace neon {
+#include "detail/AmericanApproximationKernels.inl"
+} // namespace neon
+#endif
+
+} // namespace simd
+
+namespace detail {
+
+// Kernel dispatch for contracts [begin, end), without the metrics hooks
+inline void americanApproximationRange(const OptionBatchView& batch, double* out, AmericanApproximation method,
+                                       std::size_t begin, std::size_t end, SimdLevel level) {
+    switch (resolveSimdLevel(level)) {
+#if defined(OPTIONS_PRICING_SIMD_X86)
+        case SimdLevel::AVX512:
+            simd::avx512::americanApproximationBatch(batch, out, method, begin, end);
+            return;
+        case SimdLevel::AVX2:
+            simd::avx2::americanApproximationBatch(batch, out, method, begin, end);
+            return;
+#endif
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+        case SimdLevel::NEON:
+            simd::neon::americanApproximationBatch(batch, out, method, begin, end);
+            return;
+#endif
+        default:
+            simd::scalar::americanApproximationBatch(batch, out, method, begin, end);
+            return;
+    }
+}
+
+} // namespace detail
+
+// Batch American pricer over the same structure-of-arrays inputs as
+// BatchBlackScholes, one vector of contracts at a time. Calls, and puts at
+// non-positive rates, are never exercised early and get the Black-Scholes
+// price. Inputs are not validated on the hot path.
+class BatchAmericanApproximation {
+public:
+    static void price(const OptionBatchView& batch, double* out, AmericanApproximation method) {
+        price(batch, out, method, activeSimdLevel());
+    }
+
+    // Same, but with an explicit instruction set (clamped to what the CPU supports)
+    static void price(const OptionBatchView& batch, double* out, AmericanApproximation method, SimdLevel level) {
+        priceRange(batch, out, method, 0, batch.size, level);
+    }
+
+    static std::vector<double> price(const OptionBatch& batch, AmericanApproximation method) {
+        std::vector<double> out(batch.size());
+        price(batch.view(), out.data(), method);
+        return out;
+    }
+
+    // Price contracts [begin, end) only; lets callers split a batch across threads
+    static void priceRange(const OptionBatchView& batch, double* out, AmericanApproximation method,
+                           std::size_t begin, std::size_t end, SimdLevel level) {
+        PricingProbe probe(MetricEngine::AmericanApproximation);
+        recordMetric(MetricEngine::AmericanApproximation, MetricCounter::Contracts, end - begin);
+        detail::americanApproximationRange(batch, out, method, begin, end, level);
+    }
+};
+
+// Closed-form American option engine.
+//
+// Barone-Adesi-Whaley adds a quadratic early-exercise premium to the
+// Black-Scholes price and solves for the critical spot with a few Newton
+// steps. Bjerksund-Stensland (2002) values exercise at a two-step flat
+// boundary, which makes it a lower bound on the true price. Against a
+// converged lattice, over strikes 80-120 on a spot of 100, vols 0.15-0.5 and
+// rates up to 10%, both are within about 0.13 up to one year; at three years
+// Bjerksund-Stensland stays within 0.4 while Barone-Adesi-Whaley overprices
+// by up to 0.5. Barone-Adesi-Whaley takes about a microsecond per put alone;
+// Bjerksund-Stensland needs twenty bivariate normals, about five microseconds
+// alone and under one per contract batched with AVX-512.
+// Delta and gamma come from central differences in spot, evaluated together
+// in one vector pass.
+class AmericanApproximationOption : public Option {
+public:
+    AmericanApproximationOption(double spot, double strike, double riskFreeRate,
+                                double volatility, double timeToMaturity, OptionType type,
+                                AmericanApproximation method = AmericanApproximation::BjerksundStensland)
+        : Option(spot, strike, riskFreeRate, volatility, timeToMaturity,
+                 type, ExerciseType::American), method_(method) {}
+
+    double price() const override {
+        PricingProbe probe(MetricEngine::AmericanApproximation);
+        double value;
+        priceAt(&spot_, &value, 1);
+        return value;
+    }
+
+    double delta() const override { return risk().delta; }
+    double gamma() const override { return risk().gamma; }
+
+    PositionRisk risk() const override {
+        PricingProbe probe(MetricEngine::AmericanApproximation);
+        double h = spot_ * 0.001;
+        double spots[3] = {spot_, spot_ + h, spot_ - h};
+        double values[3];
+        priceAt(spots, values, 3);
+        return {values[0], (values[1] - values[2]) / (2.0 * h),
+                (values[1] - 2.0 * values[0] + values[2]) / (h * h)};
+    }
+
+    std::unique_ptr<Option> withMarket(double spot, double volatility, double timeToMaturity) const override {
+        return std::make_unique<AmericanApproximationOption>(spot, strike_, riskFreeRate_, volatility,
+                                                             timeToMaturity, type_, method_);
+    }
+    
+    AmericanApproximation method() const { return method_; }
+
+private:
+    AmericanApproximation method_;
+
+    // Price at each of the given spots with this contract's other terms
+    void priceAt(const double* spots, double* out, std::size_t count) const {
+        double strikes[3] = {strike_, strike_, strike_};
+        double rates[3] = {riskFreeRate_, riskFreeRate_, riskFreeRate_};
+        double vols[3] = {volatility_, volatility_, volatility_};
+        double times[3] = {timeToMaturity_, timeToMaturity_, timeToMaturity_};
+        OptionType types[3] = {type_, type_, type_};
+        OptionBatchView batch{spots, strikes, rates, vols, times, types, count};
+        // A single price runs scalar; a risk() triple fills one vector
+        detail::americanApproximationRange(batch, out, method_, 0, count,
+                                           count == 1 ? SimdLevel::Scalar : activeSimdLevel());
+    }
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_AMERICAN_APPROXIMATION_HPP
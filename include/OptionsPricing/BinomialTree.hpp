@@ -2,96 +2,307 @@
 #define OPTIONS_PRICING_BINOMIAL_TREE_HPP
 
 #include "Common.hpp"
+#include "Adjoint.hpp"
+#include "BlackScholes.hpp"
+#include "LatticeCache.hpp"
+#include "Metrics.hpp"
+#include "Payoff.hpp"
+#include "Simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <vector>
 
 namespace OptionsPricing {
 
+// How the tree's up/down moves and probabilities are chosen
+enum class BinomialParametrization {
+    CoxRossRubinstein,  // u = exp(sigma * sqrt(dt)); error oscillates with odd/even steps
+    LeisenReimer        // Peizer-Pratt inversion centred on the strike; odd steps, smooth convergence
+};
+
+struct BinomialTreeSettings {
+    unsigned int steps = 1000;  // rounded up to odd for Leisen-Reimer
+    BinomialParametrization parametrization = BinomialParametrization::CoxRossRubinstein;
+    bool richardson = false;      // extrapolate from steps and about steps / 2
+    bool controlVariate = false;  // American only: correct by Black-Scholes minus the European tree
+};
+
+namespace detail {
+// Strikes per interleaved group in BinomialTreeOption::priceStrikes()
+constexpr std::size_t binomialLadderWidth = 8;
+} // namespace detail
+
+namespace simd {
+
+namespace scalar {
+#include "detail/BinomialLadderKernels.inl"
+} // namespace scalar
+
+#if defined(OPTIONS_PRICING_SIMD_X86)
+OPTIONS_PRICING_BEGIN_TARGET_AVX2
+namespace avx2 {
+#include "detail/BinomialLadderKernels.inl"
+} // namespace avx2
+OPTIONS_PRICING_END_TARGET
+
+OPTIONS_PRICING_BEGIN_TARGET_AVX512
+namespace avx512 {
+#include "detail/BinomialLadderKernels.inl"
+} // namespace avx512
+OPTIONS_PRICING_END_TARGET_AVX512
+#endif
 
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+namespace neon {
+#include "detail/BinomialLadderKernels.inl"
+} // namespace neon
+#endif
+
+} // namespace simd
+
+// Binomial lattice engine.
+//
+// Cox-Ross-Rubinstein is the textbook tree. Its error oscillates between
+// odd and even step counts, so it needs thousands of steps for penny
+// accuracy. Leisen-Reimer puts the strike in the middle of the terminal
+// nodes and matches the Black-Scholes probabilities, so European error
+// falls as 1/steps^2 without oscillating. That smooth error is what makes
+// Richardson extrapolation work: it combines the prices at steps and about
+// steps / 2 to cancel the leading error term. For American options the
+// control variate reprices the European contract on the same lattice and
+// adds the Black-Scholes minus tree difference, removing most of the
+// lattice error that both share. With all three, about 100 steps is within
+// 1e-3 of the converged price of an ATM American put.
 class BinomialTreeOption : public Option {
 public:
     BinomialTreeOption(double spot, double strike, double riskFreeRate, 
                        double volatility, double timeToMaturity, 
                        OptionType type, ExerciseType exerciseType, 
                        unsigned int steps = 1000)
-        : Option(spot, strike, riskFreeRate, volatility, timeToMaturity, 
-                 type, exerciseType), steps_(steps) {}
+        : BinomialTreeOption(spot, strike, riskFreeRate, volatility, timeToMaturity,
+                             type, exerciseType, settingsWithSteps(steps)) {}
+    
+    BinomialTreeOption(double spot, double strike, double riskFreeRate,
+                       double volatility, double timeToMaturity,
+                       OptionType type, ExerciseType exerciseType,
+                       BinomialTreeSettings settings)
+        : Option(spot, strike, riskFreeRate, volatility, timeToMaturity,
+                 type, exerciseType), settings_(settings) {
+        if (settings_.parametrization == BinomialParametrization::LeisenReimer) {
+            settings_.steps |= 1u;
+        }
+        if (settings_.steps == 0 || (settings_.richardson && settings_.steps < 2)) {
+            throw std::invalid_argument("Binomial tree needs at least one step, two with Richardson extrapolation");
+        }
+    }
+    
+    // Scratch buffers for price(). Reusing one across calls means repeated
+    // pricing performs no heap allocations once the buffers, and the
+    // thread's LatticeParameterCache entries, have grown.
+    struct Workspace {
+        std::vector<double> optionValues;
+        std::vector<double> powers;  // (d / u)^i for Leisen-Reimer; CRR powers live in LatticeParameterCache
+        std::vector<double> exerciseValues;  // payoff at every node spot, split by parity
+        std::vector<double> nodeSpots;       // priceStrikes(): every node spot, split by parity
+        std::vector<double> ladderValues;    // priceStrikes(): node values interleaved by strike
+        std::vector<double> nodeValues;      // sensitivities(): checkpointed steps and the stretch replayed
+        std::vector<double> nodeAdjoints;    // sensitivities(): node adjoints of two steps
+        std::vector<unsigned char> exercised;  // sensitivities(): early-exercise flags of that stretch
+    };
     
     // Price the option using binomial tree method
     double price() const override {
-        double dt = timeToMaturity_ / steps_;
-        double u = exp(volatility_ * sqrt(dt));
-        double d = 1.0 / u;
-        double p = (exp(riskFreeRate_ * dt) - d) / (u - d);
-        
-        // Initialize terminal stock prices
-        std::vector<double> stockPrices(steps_ + 1);
-        for (unsigned int i = 0; i <= steps_; ++i) {
-            stockPrices[i] = spot_ * pow(u, steps_ - i) * pow(d, i);
+        return price(threadWorkspace());
+    }
+    
+    // Price using caller-supplied scratch buffers
+    double price(Workspace& workspace) const {
+        PricingProbe probe(MetricEngine::BinomialTree);
+        if (!settings_.richardson && !useControlVariate()) {
+            return backwardInduction(workspace, nullptr, settings_.steps);
         }
-        
-        // option vslue (payoffs) at maturity
-        std::vector<double> optionValues(steps_ + 1);
-        for (unsigned int i = 0; i <= steps_; ++i) {
-            if (type_ == OptionType::Call) {
-                optionValues[i] = std::max(0.0, stockPrices[i] - strike_);
-            } else {  // Put
-                optionValues[i] = std::max(0.0, strike_ - stockPrices[i]);
+        return corrected(workspace, nullptr).value;
+    }
+    
+    // Price as above and record the early-exercise boundary of the tree at
+    // settings().steps, the fine tree under Richardson extrapolation. An
+    // American put at a positive rate is priced with the exercised region
+    // pruned either way (see detail::TreeExercise), so the boundary costs
+    // one spot per step.
+    double price(Workspace& workspace, ExerciseBoundary& boundary) const {
+        PricingProbe probe(MetricEngine::BinomialTree);
+        boundary.dt = timeToMaturity_ / settings_.steps;
+        boundary.spots.assign(settings_.steps, std::numeric_limits<double>::quiet_NaN());
+        if (!settings_.richardson && !useControlVariate()) {
+            return backwardInduction(workspace, nullptr, settings_.steps, &boundary);
+        }
+        return corrected(workspace, nullptr, &boundary).value;
+    }
+    
+    ExerciseBoundary exerciseBoundary() const {
+        ExerciseBoundary boundary;
+        price(threadWorkspace(), boundary);
+        return boundary;
+    }
+    
+    // Price a custom payoff (digital, power, ...) on this option's tree and
+    // exercise style; the option's own strike and type are not used, except
+    // to centre a Leisen-Reimer tree. Richardson extrapolation applies, the
+    // control variate does not.
+    template <typename Payoff>
+    double pricePayoff(const Payoff& payoff) const {
+        return pricePayoff(payoff, threadWorkspace());
+    }
+    
+    template <typename Payoff>
+    double pricePayoff(const Payoff& payoff, Workspace& workspace) const {
+        PricingProbe probe(MetricEngine::BinomialTree);
+        double value = dispatchExercise(workspace, nullptr, payoff, settings_.steps);
+        if (!settings_.richardson) {
+            return value;
+        }
+        unsigned int coarse = coarseSteps();
+        return extrapolate(value, dispatchExercise(workspace, nullptr, payoff, coarse), coarse);
+    }
+    
+    static constexpr std::size_t ladderWidth = detail::binomialLadderWidth;
+    
+    // Price this tree at every strike in [strikes, strikes + count), as a call
+    // or put per types[i] (or this option's type when types is null), on one
+    // Cox-Ross-Rubinstein lattice. Strikes run through the backward induction
+    // ladderWidth at a time, interleaved so each node update is a few SIMD
+    // vectors, which makes a group cost little more than one tree. Richardson
+    // extrapolation and the control variate apply per strike as in price().
+    // Leisen-Reimer trees are centred on their strike, so with that
+    // parametrization each strike gets its own tree. The option's own strike
+    // is not used.
+    void priceStrikes(const double* strikes, const OptionType* types, std::size_t count, double* out,
+                      Workspace& workspace) const {
+        PricingProbe probe(MetricEngine::BinomialTree);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!(strikes[i] > 0.0)) {
+                throw std::invalid_argument("Strike price must be positive");
             }
         }
-        
-        // Work backwards through the tree
-        for (int j = steps_ - 1; j >= 0; --j) {
-            for (int i = 0; i <= j; ++i) {
-                // calc stock price at this node
-                double stockPrice = spot_ * pow(u, j - i) * pow(d, i);
-                
-                // calc option value (risk-neutral valuation formula)
-                double optionValue = exp(-riskFreeRate_ * dt) * 
-                                    (p * optionValues[i] + (1.0 - p) * optionValues[i + 1]);
-                                    // (weighted average of up and down nodes)
-                
-                // For American options, check if early exercise is optimal
-                if (exerciseType_ == ExerciseType::American) {
-                    if (type_ == OptionType::Call) {
-                        optionValue = std::max(optionValue, stockPrice - strike_);
-                    } else {  // Put
-                        optionValue = std::max(optionValue, strike_ - stockPrice);
-                    }
-                }
-                
-                optionValues[i] = optionValue;
+        if (settings_.parametrization == BinomialParametrization::LeisenReimer) {
+            for (std::size_t i = 0; i < count; ++i) {
+                BinomialTreeOption single(spot_, strikes[i], riskFreeRate_, volatility_, timeToMaturity_,
+                                          types ? types[i] : type_, exerciseType_, settings_);
+                out[i] = single.price(workspace);
             }
+            return;
         }
         
-        return optionValues[0];
+        for (std::size_t i = 0; i < count; i += ladderWidth) {
+            // Pad a short last group by repeating its final strike
+            double group[ladderWidth];
+            OptionType groupTypes[ladderWidth];
+            for (std::size_t k = 0; k < ladderWidth; ++k) {
+                std::size_t source = std::min(i + k, count - 1);
+                group[k] = strikes[source];
+                groupTypes[k] = types ? types[source] : type_;
+            }
+            double values[ladderWidth];
+            ladderGroup(group, groupTypes, workspace, values);
+            for (std::size_t k = 0; k < ladderWidth && i + k < count; ++k) {
+                out[i + k] = values[k];
+            }
+        }
+    }
+    
+    std::vector<double> priceStrikes(const std::vector<double>& strikes) const {
+        std::vector<double> out(strikes.size());
+        priceStrikes(strikes.data(), nullptr, strikes.size(), out.data(), threadWorkspace());
+        return out;
+    }
+    
+    std::vector<double> priceStrikes(const std::vector<double>& strikes, const std::vector<OptionType>& types) const {
+        if (types.size() != strikes.size()) {
+            throw std::invalid_argument("Need one option type per strike");
+        }
+        std::vector<double> out(strikes.size());
+        priceStrikes(strikes.data(), types.data(), strikes.size(), out.data(), threadWorkspace());
+        return out;
+    }
+    
+    // Price with delta, vega, rho and theta from one adjoint sweep. The
+    // induction runs forward once, then a reverse pass carries the
+    // derivative of the price in each node value back down the tree,
+    // collecting it on the branch probabilities, the moves and the spot; the
+    // O(1) set-up runs over dual numbers to finish the chain rule. That costs
+    // three and a half to four and a half prices, against eight repricings
+    // for bumped Greeks. Richardson extrapolation and the control variate
+    // apply as in price(). The result is the exact derivative of the tree
+    // price, so with Cox-Ross-Rubinstein vega and theta carry the odd/even
+    // oscillation that a bump of a percent or so smooths over.
+    Sensitivities sensitivities() const {
+        return sensitivities(threadWorkspace());
+    }
+    
+    Sensitivities sensitivities(Workspace& workspace) const {
+        PricingProbe probe(MetricEngine::BinomialTree);
+        double derivatives[detail::adjointInputs];
+        double value = adjointCorrectedTree(workspace, settings_.steps, derivatives);
+        if (settings_.richardson) {
+            unsigned int coarse = coarseSteps();
+            double coarseDerivatives[detail::adjointInputs];
+            double coarseValue = adjointCorrectedTree(workspace, coarse, coarseDerivatives);
+            value = extrapolate(value, coarseValue, coarse);
+            for (std::size_t k = 0; k < detail::adjointInputs; ++k) {
+                derivatives[k] = extrapolate(derivatives[k], coarseDerivatives[k], coarse);
+            }
+        }
+        return detail::sensitivitiesFrom(value, derivatives);
+    }
+    
+    // Per 1% change in the rate, from the adjoint sweep
+    double rho() const { return sensitivities().rho; }
+    
+    unsigned int steps() const { return settings_.steps; }
+    
+    const BinomialTreeSettings& settings() const { return settings_; }
+    
+    // About steps^2 / 2 nodes of two multiply-adds each, per induction
+    double pricingCost() const override {
+        double n = static_cast<double>(settings_.steps);
+        double inductions = (settings_.richardson ? 1.25 : 1.0) * (useControlVariate() ? 2.0 : 1.0);
+        return 1.0 + inductions * n * (n + 1.0) / 64.0;
+    }
+    
+    std::unique_ptr<Option> withMarket(double spot, double volatility, double timeToMaturity) const override {
+        return std::make_unique<BinomialTreeOption>(spot, strike_, riskFreeRate_, volatility, timeToMaturity,
+                                                    type_, exerciseType_, settings_);
     }
     
     // Calculate delta using finite difference method
-    double delta() const {
+    double delta() const override {
         double h = spot_ * 0.001;  // Small price change
         
         BinomialTreeOption optionUp(spot_ + h, strike_, riskFreeRate_, 
                                    volatility_, timeToMaturity_, 
-                                   type_, exerciseType_, steps_);
+                                   type_, exerciseType_, settings_);
         
         BinomialTreeOption optionDown(spot_ - h, strike_, riskFreeRate_, 
                                      volatility_, timeToMaturity_, 
-                                     type_, exerciseType_, steps_);
+                                     type_, exerciseType_, settings_);
         
         return (optionUp.price() - optionDown.price()) / (2.0 * h);
     }
     
     // Calculate gamma using finite difference method
-    double gamma() const {
+    double gamma() const override {
         double h = spot_ * 0.001;  // Small price change
         
         BinomialTreeOption optionUp(spot_ + h, strike_, riskFreeRate_, 
                                    volatility_, timeToMaturity_, 
-                                   type_, exerciseType_, steps_);
+                                   type_, exerciseType_, settings_);
         
         BinomialTreeOption optionDown(spot_ - h, strike_, riskFreeRate_, 
                                      volatility_, timeToMaturity_, 
-                                     type_, exerciseType_, steps_);
+                                     type_, exerciseType_, settings_);
         
         return (optionUp.price() - 2.0 * price() + optionDown.price()) / (h * h);
     }
@@ -106,7 +317,7 @@ public:
         
         BinomialTreeOption optionLess(spot_, strike_, riskFreeRate_, 
                                      volatility_, timeToMaturity_ - h, 
-                                     type_, exerciseType_, steps_);
+                                     type_, exerciseType_, settings_);
         
         return (optionLess.price() - price()) / h;
     }
@@ -117,11 +328,11 @@ public:
         
         BinomialTreeOption optionUp(spot_, strike_, riskFreeRate_, 
                                    volatility_ + h, timeToMaturity_, 
-                                   type_, exerciseType_, steps_);
+                                   type_, exerciseType_, settings_);
         
         BinomialTreeOption optionDown(spot_, strike_, riskFreeRate_, 
                                      volatility_ - h, timeToMaturity_, 
-                                     type_, exerciseType_, steps_);
+                                     type_, exerciseType_, settings_);
         
         return (optionUp.price() - optionDown.price()) / (2.0 * h * 100.0);  // Divided by 100 for 1% change
     }
@@ -138,8 +349,805 @@ public:
         return {delta(), gamma(), theta(), vega()};
     }
     
+    // Greeks with a choice of method. The lattice methods read delta, gamma
+    // and theta off the nodes at steps 1 and 2 of a single backward induction
+    // instead of repricing eight times.
+    Greeks calculateGreeks(TreeGreeksMethod method) const {
+        if (method == TreeGreeksMethod::Adjoint) {
+            Sensitivities s = sensitivities();
+            return {s.delta, hasLatticeGreeks() ? latticeGreeks().gamma : gamma(), s.theta, s.vega};
+        }
+        if (method == TreeGreeksMethod::FiniteDifference || !hasLatticeGreeks()) {
+            return calculateGreeks();
+        }
+        
+        LatticeGreeks lattice = latticeGreeks();
+        Greeks greeks;
+        greeks.delta = lattice.delta;
+        greeks.gamma = lattice.gamma;
+        greeks.theta = lattice.theta;
+        if (method == TreeGreeksMethod::LatticeAnalyticVega) {
+            greeks.vega = greeks.gamma * volatility_ * spot_ * spot_ * timeToMaturity_ / 100.0;
+        } else {
+            greeks.vega = vega();
+        }
+        return greeks;
+    }
+    
+    // Price, delta and gamma from one backward induction (lattice Greeks)
+    PositionRisk risk() const override {
+        if (!hasLatticeGreeks()) {
+            return Option::risk();
+        }
+        LatticeGreeks lattice = latticeGreeks();
+        return {lattice.value, lattice.delta, lattice.gamma};
+    }
+    
 private:
-    unsigned int steps_;
+    BinomialTreeSettings settings_;
+    
+    static BinomialTreeSettings settingsWithSteps(unsigned int steps) {
+        BinomialTreeSettings settings;
+        settings.steps = steps;
+        return settings;
+    }
+    
+    // Option values at the first two time steps, for lattice Greeks
+    struct EarlyNodes {
+        double step1[2];  // up, down
+        double step2[3];  // up-up, up-down, down-down
+        double dt;
+        double u;
+        double d;
+    };
+    
+    struct LatticeGreeks {
+        double value;
+        double delta;
+        double gamma;
+        double theta;
+    };
+    
+    bool useControlVariate() const {
+        return settings_.controlVariate && exerciseType_ == ExerciseType::American;
+    }
+    
+    // Lattice Greeks need two steps in every tree that goes into them
+    bool hasLatticeGreeks() const {
+        return (settings_.richardson ? coarseSteps() : settings_.steps) >= 2;
+    }
+    
+    // Roughly half the steps, odd again for Leisen-Reimer
+    unsigned int coarseSteps() const {
+        unsigned int coarse = std::max(1u, settings_.steps / 2);
+        if (settings_.parametrization == BinomialParametrization::LeisenReimer) {
+            coarse |= 1u;
+        }
+        return coarse;
+    }
+    
+    // Cancel the leading error term between the fine and the coarse tree. It
+    // falls as 1/steps^2 for Leisen-Reimer and as 1/steps otherwise; American
+    // prices converge at first order under either parametrization.
+    double extrapolate(double fine, double coarse, unsigned int coarseSteps) const {
+        double order = (settings_.parametrization == BinomialParametrization::LeisenReimer &&
+                        exerciseType_ == ExerciseType::European) ? 2.0 : 1.0;
+        double ratio = std::pow(static_cast<double>(settings_.steps) / coarseSteps, order);
+        return fine + (fine - coarse) / (ratio - 1.0);
+    }
+    
+    LatticeGreeks extrapolate(const LatticeGreeks& fine, const LatticeGreeks& coarse,
+                              unsigned int coarseSteps) const {
+        return {extrapolate(fine.value, coarse.value, coarseSteps),
+                extrapolate(fine.delta, coarse.delta, coarseSteps),
+                extrapolate(fine.gamma, coarse.gamma, coarseSteps),
+                extrapolate(fine.theta, coarse.theta, coarseSteps)};
+    }
+    
+    // One tree, with the control variate applied when enabled
+    LatticeGreeks correctedTree(Workspace& workspace, EarlyNodes* nodes, unsigned int steps,
+                                ExerciseBoundary* boundary = nullptr) const {
+        EarlyNodes early;
+        LatticeGreeks greeks;
+        greeks.value = backwardInduction(workspace, nodes ? &early : nullptr, steps, boundary);
+        if (nodes) {
+            greeks = greeksFrom(greeks.value, early);
+        }
+        if (useControlVariate()) {
+            BlackScholesOption european(spot_, strike_, riskFreeRate_, volatility_, timeToMaturity_, type_);
+            LatticeGreeks tree;
+            tree.value = type_ == OptionType::Call
+                ? inductionKernel<false>(workspace, nodes ? &early : nullptr, CallPayoff{strike_}, steps)
+                : inductionKernel<false>(workspace, nodes ? &early : nullptr, PutPayoff{strike_}, steps);
+            greeks.value += european.price() - tree.value;
+            if (nodes) {
+                tree = greeksFrom(tree.value, early);
+                BlackScholesOption::Greeks exact = european.calculateGreeks();
+                greeks.delta += exact.delta - tree.delta;
+                greeks.gamma += exact.gamma - tree.gamma;
+                greeks.theta += exact.theta - tree.theta;
+            }
+        }
+        return greeks;
+    }
+    
+    // Every tree the settings ask for, combined. Greeks are only filled in
+    // when withGreeks is set, which needs hasLatticeGreeks(). The boundary, if
+    // asked for, is the fine tree's.
+    LatticeGreeks corrected(Workspace& workspace, EarlyNodes* withGreeks,
+                            ExerciseBoundary* boundary = nullptr) const {
+        LatticeGreeks fine = correctedTree(workspace, withGreeks, settings_.steps, boundary);
+        if (!settings_.richardson) {
+            return fine;
+        }
+        unsigned int coarse = coarseSteps();
+        return extrapolate(fine, correctedTree(workspace, withGreeks, coarse), coarse);
+    }
+    
+    // Needs hasLatticeGreeks()
+    LatticeGreeks latticeGreeks() const {
+        PricingProbe probe(MetricEngine::BinomialTree);
+        EarlyNodes nodes;
+        return corrected(threadWorkspace(), &nodes);
+    }
+    
+    // Delta and gamma from the nodes at steps 1 and 2, theta from the middle
+    // node two steps on. Leisen-Reimer moves have u * d != 1, so that node is
+    // slightly off spot and theta takes out the delta over the difference.
+    LatticeGreeks greeksFrom(double value, const EarlyNodes& nodes) const {
+        double spotUp = spot_ * nodes.u;
+        double spotDown = spot_ * nodes.d;
+        double spotUpUp = spotUp * nodes.u;
+        double spotMiddle = spotUp * nodes.d;
+        double spotDownDown = spotDown * nodes.d;
+        
+        LatticeGreeks greeks;
+        greeks.value = value;
+        greeks.delta = (nodes.step1[0] - nodes.step1[1]) / (spotUp - spotDown);
+        double deltaUp = (nodes.step2[0] - nodes.step2[1]) / (spotUpUp - spotMiddle);
+        double deltaDown = (nodes.step2[1] - nodes.step2[2]) / (spotMiddle - spotDownDown);
+        greeks.gamma = (deltaUp - deltaDown) / (0.5 * (spotUpUp - spotDownDown));
+        greeks.theta = (nodes.step2[1] - greeks.delta * (spotMiddle - spot_) - value) / (2.0 * nodes.dt);
+        return greeks;
+    }
+    
+    static Workspace& threadWorkspace() {
+        thread_local Workspace workspace;
+        return workspace;
+    }
+    
+    static std::uint64_t treeNodes(unsigned int steps) {
+        return (static_cast<std::uint64_t>(steps) + 1) * (steps + 2) / 2;
+    }
+    
+    // Pick the payoff and exercise policies once per price, not per node
+    double backwardInduction(Workspace& workspace, EarlyNodes* nodes, unsigned int steps,
+                             ExerciseBoundary* boundary = nullptr) const {
+        if (type_ == OptionType::Call) {
+            return dispatchExercise(workspace, nodes, CallPayoff{strike_}, steps, boundary);
+        }
+        return dispatchExercise(workspace, nodes, PutPayoff{strike_}, steps, boundary);
+    }
+    
+    template <typename Payoff>
+    double dispatchExercise(Workspace& workspace, EarlyNodes* nodes, const Payoff& payoff,
+                            unsigned int steps, ExerciseBoundary* boundary = nullptr) const {
+        if (exerciseType_ == ExerciseType::American) {
+            return inductionKernel<true>(workspace, nodes, payoff, steps, boundary);
+        }
+        return inductionKernel<false>(workspace, nodes, payoff, steps);
+    }
+    
+    // One ladder group through every tree the settings ask for
+    void ladderGroup(const double* strikes, const OptionType* types, Workspace& workspace, double* out) const {
+        bool american = exerciseType_ == ExerciseType::American;
+        ladderTree(strikes, types, settings_.steps, american, workspace, out);
+        if (useControlVariate()) {
+            addControlVariate(strikes, types, settings_.steps, workspace, out);
+        }
+        if (!settings_.richardson) {
+            return;
+        }
+        unsigned int coarse = coarseSteps();
+        double coarseValues[ladderWidth];
+        ladderTree(strikes, types, coarse, american, workspace, coarseValues);
+        if (useControlVariate()) {
+            addControlVariate(strikes, types, coarse, workspace, coarseValues);
+        }
+        for (std::size_t k = 0; k < ladderWidth; ++k) {
+            out[k] = extrapolate(out[k], coarseValues[k], coarse);
+        }
+    }
+    
+    // Black-Scholes minus the European ladder on the same lattice
+    void addControlVariate(const double* strikes, const OptionType* types, unsigned int steps,
+                           Workspace& workspace, double* values) const {
+        double european[ladderWidth];
+        ladderTree(strikes, types, steps, false, workspace, european);
+        for (std::size_t k = 0; k < ladderWidth; ++k) {
+            BlackScholesOption exact(spot_, strikes[k], riskFreeRate_, volatility_, timeToMaturity_, types[k]);
+            values[k] += exact.price() - european[k];
+        }
+    }
+    
+    void ladderTree(const double* strikes, const OptionType* types, unsigned int steps, bool american,
+                    Workspace& workspace, double* out) const {
+        recordMetric(MetricEngine::BinomialTree, MetricCounter::Nodes, treeNodes(steps) * ladderWidth);
+        const LatticeParameters& lattice = coxRossRubinstein(steps);
+        const int n = static_cast<int>(steps);
+        
+        // Node spots in the parity-split order of the exercise table in inductionKernel()
+        std::vector<double>& nodeSpots = workspace.nodeSpots;
+        nodeSpots.resize(2 * steps + 1);
+        for (int q = 0; q <= n; ++q) {
+            nodeSpots[q] = spot_ * lattice.powers[2 * n - 2 * q];
+        }
+        for (int q = 0; q < n; ++q) {
+            nodeSpots[n + 1 + q] = spot_ * lattice.powers[2 * n - 1 - 2 * q];
+        }
+        
+        double sign[ladderWidth], signedStrike[ladderWidth];
+        for (std::size_t k = 0; k < ladderWidth; ++k) {
+            sign[k] = types[k] == OptionType::Call ? 1.0 : -1.0;
+            signedStrike[k] = sign[k] * strikes[k];
+        }
+        std::vector<double>& values = workspace.ladderValues;
+        values.resize((steps + 1) * ladderWidth);
+        
+        if (american) {
+            ladderKernel<true>(nodeSpots.data(), sign, signedStrike, lattice.up, lattice.down, n, values.data());
+        } else {
+            ladderKernel<false>(nodeSpots.data(), sign, signedStrike, lattice.up, lattice.down, n, values.data());
+        }
+        std::copy(values.begin(), values.begin() + ladderWidth, out);
+    }
+    
+    template <bool American>
+    static void ladderKernel(const double* nodeSpots, const double* sign, const double* signedStrike,
+                             double pUp, double pDown, int n, double* values) {
+        switch (activeSimdLevel()) {
+#if defined(OPTIONS_PRICING_SIMD_X86)
+            case SimdLevel::AVX512:
+                simd::avx512::binomialLadder<American>(nodeSpots, sign, signedStrike, pUp, pDown, n, values);
+                return;
+            case SimdLevel::AVX2:
+                simd::avx2::binomialLadder<American>(nodeSpots, sign, signedStrike, pUp, pDown, n, values);
+                return;
+#endif
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+            case SimdLevel::NEON:
+                simd::neon::binomialLadder<American>(nodeSpots, sign, signedStrike, pUp, pDown, n, values);
+                return;
+#endif
+            default:
+                simd::scalar::binomialLadder<American>(nodeSpots, sign, signedStrike, pUp, pDown, n, values);
+                return;
+        }
+    }
+    
+    // Peizer-Pratt method 2 inversion of the binomial distribution, for odd n
+    template <typename Real>
+    static Real peizerPratt(const Real& z, double n) {
+        using std::copysign;
+        using std::exp;
+        using std::sqrt;
+        Real t = z / (n + 1.0 / 3.0 + 0.1 / (n + 1.0));
+        return 0.5 + copysign(0.5 * sqrt(1.0 - exp(-t * t * (n + 1.0 / 6.0))), z);
+    }
+    
+    // The moves and discounted branch probabilities of one tree, over double
+    // for pricing or over detail::AdjointDual for sensitivities(). Node (j, i)
+    // sits at spot * exp(j * logUp + i * logRatio).
+    template <typename Real>
+    struct TreeMoves {
+        Real dt;
+        Real u;
+        Real d;
+        Real logUp;
+        Real logRatio;
+        Real pUp;
+        Real pDown;
+    };
+    
+    template <typename Real>
+    static TreeMoves<Real> coxRossRubinsteinMoves(const Real& volatility, const Real& riskFreeRate,
+                                                  const Real& timeToMaturity, unsigned int steps) {
+        using std::exp;
+        using std::sqrt;
+        TreeMoves<Real> moves;
+        moves.dt = timeToMaturity / steps;
+        Real dx = volatility * sqrt(moves.dt);
+        moves.u = exp(dx);
+        moves.d = 1.0 / moves.u;
+        Real p = (exp(riskFreeRate * moves.dt) - moves.d) / (moves.u - moves.d);
+        
+        // Discounted branch probabilities, hoisted out of the node loop
+        Real discount = exp(-riskFreeRate * moves.dt);
+        moves.logUp = dx;
+        moves.logRatio = -2.0 * dx;
+        moves.pUp = discount * p;
+        moves.pDown = discount * (1.0 - p);
+        return moves;
+    }
+    
+    template <typename Real>
+    TreeMoves<Real> leisenReimerMoves(const Real& spot, const Real& volatility, const Real& riskFreeRate,
+                                      const Real& timeToMaturity, unsigned int steps) const {
+        using std::exp;
+        using std::log;
+        using std::sqrt;
+        TreeMoves<Real> moves;
+        moves.dt = timeToMaturity / steps;
+        Real growth = exp(riskFreeRate * moves.dt);
+        Real volSqrtT = volatility * sqrt(timeToMaturity);
+        Real d1 = (log(spot / strike_) + (riskFreeRate + 0.5 * volatility * volatility) * timeToMaturity) /
+                  volSqrtT;
+        Real p = peizerPratt(d1 - volSqrtT, steps);
+        moves.u = growth * peizerPratt(d1, steps) / p;
+        moves.d = (growth - p * moves.u) / (1.0 - p);
+        
+        Real discount = 1.0 / growth;
+        moves.pUp = discount * p;
+        moves.pDown = discount * (1.0 - p);
+        moves.logRatio = log(moves.d / moves.u);
+        moves.logUp = log(moves.u);
+        return moves;
+    }
+    
+    // Cox-Ross-Rubinstein moves, probabilities and power table, which depend
+    // on spot and strike not at all and are shared through the cache
+    const LatticeParameters& coxRossRubinstein(unsigned int steps) const {
+        LatticeKey key{LatticeFamily::CoxRossRubinstein, volatility_, riskFreeRate_, timeToMaturity_, steps};
+        return LatticeParameterCache::lookup(key, [&](LatticeParameters& lattice) {
+            TreeMoves<double> moves = coxRossRubinsteinMoves(volatility_, riskFreeRate_, timeToMaturity_, steps);
+            lattice.dt = moves.dt;
+            lattice.u = moves.u;
+            lattice.up = moves.pUp;
+            lattice.down = moves.pDown;
+            
+            const int n = static_cast<int>(steps);
+            std::vector<double>& powers = lattice.powers;
+            powers.resize(2 * steps + 1);
+            powers[n] = 1.0;
+            for (int k = 1; k <= n; ++k) {
+                powers[n + k] = exp(k * moves.logUp);
+                powers[n - k] = 1.0 / powers[n + k];
+            }
+        });
+    }
+    
+    // One step of the pruned American put induction over nodes [0, j], given
+    // that the nodes of step j + 1 from `exercised` on are exercised. Nodes
+    // from there on are exercised again and skipped. Out-of-the-money nodes,
+    // where exercise pays nothing, take the continuation value unchecked, so
+    // only the band in between is compared. Returns the first node of this
+    // step's exercised run; values are valid up to and including it.
+    template <typename Exercise>
+    static int prunedPutStep(double* values, double pUp, double pDown, int j, int exercised,
+                             const Exercise& exercise) {
+        int end = std::min(exercised, j + 1);
+        // Put payoffs rise with i, so the first node in the money is a bisection away
+        int money = 0;
+        for (int high = end; money < high;) {
+            int middle = (money + high) / 2;
+            if (exercise(middle) > 0.0) {
+                high = middle;
+            } else {
+                money = middle + 1;
+            }
+        }
+        for (int i = 0; i < money; ++i) {
+            values[i] = pUp * values[i] + pDown * values[i + 1];
+        }
+        for (int i = money; i < end; ++i) {
+            values[i] = std::max(pUp * values[i] + pDown * values[i + 1], exercise(i));
+        }
+        int first = end;
+        while (first > money && values[first - 1] == exercise(first - 1)) {
+            --first;
+        }
+        if (first == end && end <= j) {
+            values[end] = exercise(end);
+        }
+        return first;
+    }
+    
+    // Where a pruned put's exercised run starts at maturity: every node in
+    // the money, and put payoffs rise with the node index
+    static int firstInTheMoney(detail::TreeExercise exercise, const double* values, int n) {
+        if (exercise != detail::TreeExercise::PrunedPut) {
+            return 0;
+        }
+        return static_cast<int>(std::upper_bound(values, values + n + 1, 0.0) - values);
+    }
+    
+    // Lowest exercised node spot of step j for the node-by-node American
+    // induction, which only exposes a boundary for calls at negative rates
+    template <typename Exercise, typename NodeSpot>
+    static double lowestExercised(const double* values, int j, const Exercise& exercise,
+                                  const NodeSpot& nodeSpot) {
+        for (int i = j; i >= 0; --i) {
+            double value = exercise(i);
+            if (value > 0.0 && values[i] == value) {
+                return nodeSpot(i);
+            }
+        }
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    
+    template <bool American, typename Payoff>
+    double inductionKernel(Workspace& workspace, EarlyNodes* nodes, const Payoff& payoff,
+                           unsigned int steps, ExerciseBoundary* boundary = nullptr) const {
+        recordMetric(MetricEngine::BinomialTree, MetricCounter::Nodes, treeNodes(steps));
+        if (settings_.parametrization == BinomialParametrization::LeisenReimer) {
+            return leisenReimerKernel<American>(workspace, nodes, payoff, steps, boundary);
+        }
+        const LatticeParameters& lattice = coxRossRubinstein(steps);
+        double dt = lattice.dt;
+        double u = lattice.u;
+        double pUp = lattice.up;
+        double pDown = lattice.down;
+        
+        // Node (j, i) sits at spot * u^(j - 2i); one power table serves every step
+        const int n = static_cast<int>(steps);
+        const std::vector<double>& powers = lattice.powers;
+        
+        // Payoff at every node spot. Entry k = 2n - 2q of the power table goes
+        // to slot q, and k = 2n - 1 - 2q to slot n + 1 + q, so the nodes of
+        // any one step read a contiguous run of this table.
+        std::vector<double>& exerciseValues = workspace.exerciseValues;
+        exerciseValues.resize(2 * steps + 1);
+        for (int q = 0; q <= n; ++q) {
+            exerciseValues[q] = payoff(spot_ * powers[2 * n - 2 * q]);
+        }
+        for (int q = 0; q < n; ++q) {
+            exerciseValues[n + 1 + q] = payoff(spot_ * powers[2 * n - 1 - 2 * q]);
+        }
+        
+        // option value (payoffs) at maturity
+        std::vector<double>& optionValues = workspace.optionValues;
+        optionValues.assign(exerciseValues.begin(), exerciseValues.begin() + n + 1);
+        
+        if (nodes) {
+            nodes->dt = dt;
+            nodes->u = u;
+            nodes->d = 1.0 / u;
+            if (n == 2) {
+                std::copy(optionValues.begin(), optionValues.begin() + 3, nodes->step2);
+            }
+        }
+        
+        // Work backwards through the tree. With the policies fixed at compile
+        // time the inner loop has no branches; the European one vectorizes.
+        double* values = optionValues.data();
+        detail::TreeExercise exercise = American
+            ? detail::treeExercise<Payoff>(riskFreeRate_, std::min(pUp, pDown))
+            : detail::TreeExercise::European;
+        int exercised = firstInTheMoney(exercise, values, n);
+        for (int j = n - 1; j >= 0; --j) {
+            if (exercise == detail::TreeExercise::European) {
+                for (int i = 0; i <= j; ++i) {
+                    values[i] = pUp * values[i] + pDown * values[i + 1];
+                }
+            } else {
+                int parity = (n - j) & 1;
+                const double* row = exerciseValues.data() + (parity ? n + 1 : 0) + (n - j - parity) / 2;
+                auto exerciseAt = [row](int i) { return row[i]; };
+                auto nodeSpot = [&](int i) { return spot_ * powers[n + j - 2 * i]; };
+                if (exercise == detail::TreeExercise::PrunedPut) {
+                    exercised = prunedPutStep(values, pUp, pDown, j, exercised, exerciseAt);
+                    if (nodes && j <= 2 && exercised <= j) {
+                        std::copy(row + exercised, row + j + 1, values + exercised);
+                    }
+                    if (boundary) {
+                        boundary->spots[j] = exercised <= j ? nodeSpot(exercised)
+                                                            : std::numeric_limits<double>::quiet_NaN();
+                    }
+                } else {
+                    for (int i = 0; i <= j; ++i) {
+                        values[i] = std::max(pUp * values[i] + pDown * values[i + 1], row[i]);
+                    }
+                    if (boundary) {
+                        boundary->spots[j] = lowestExercised(values, j, exerciseAt, nodeSpot);
+                    }
+                }
+            }
+            
+            if (nodes && j == 2) {
+                std::copy(optionValues.begin(), optionValues.begin() + 3, nodes->step2);
+            } else if (nodes && j == 1) {
+                std::copy(optionValues.begin(), optionValues.begin() + 2, nodes->step1);
+            }
+        }
+        
+        return optionValues[0];
+    }
+    
+    // Leisen-Reimer moves do not recombine on spot (u * d != 1), so node
+    // (j, i) sits at spot * u^j * (d / u)^i and the exercise value is taken
+    // in the node loop from one table of (d / u)^i.
+    template <bool American, typename Payoff>
+    double leisenReimerKernel(Workspace& workspace, EarlyNodes* nodes, const Payoff& payoff,
+                              unsigned int steps, ExerciseBoundary* boundary) const {
+        TreeMoves<double> moves = leisenReimerMoves(spot_, volatility_, riskFreeRate_, timeToMaturity_, steps);
+        double pUp = moves.pUp;
+        double pDown = moves.pDown;
+        
+        const int n = static_cast<int>(steps);
+        double logRatio = moves.logRatio;
+        double logUp = moves.logUp;
+        std::vector<double>& ratios = workspace.powers;
+        ratios.resize(steps + 1);
+        for (int i = 0; i <= n; ++i) {
+            ratios[i] = exp(i * logRatio);
+        }
+        
+        std::vector<double>& optionValues = workspace.optionValues;
+        optionValues.resize(steps + 1);
+        double* values = optionValues.data();
+        const double* ratio = ratios.data();
+        double top = spot_ * exp(n * logUp);
+        for (int i = 0; i <= n; ++i) {
+            values[i] = payoff(top * ratio[i]);
+        }
+        
+        if (nodes) {
+            nodes->dt = moves.dt;
+            nodes->u = moves.u;
+            nodes->d = moves.d;
+            if (n == 2) {
+                std::copy(optionValues.begin(), optionValues.begin() + 3, nodes->step2);
+            }
+        }
+        
+        detail::TreeExercise exercise = American
+            ? detail::treeExercise<Payoff>(riskFreeRate_, std::min(pUp, pDown))
+            : detail::TreeExercise::European;
+        int exercised = firstInTheMoney(exercise, values, n);
+        for (int j = n - 1; j >= 0; --j) {
+            if (exercise == detail::TreeExercise::European) {
+                for (int i = 0; i <= j; ++i) {
+                    values[i] = pUp * values[i] + pDown * values[i + 1];
+                }
+            } else {
+                top = spot_ * exp(j * logUp);
+                auto nodeSpot = [top, ratio](int i) { return top * ratio[i]; };
+                auto exerciseAt = [&](int i) { return payoff(nodeSpot(i)); };
+                if (exercise == detail::TreeExercise::PrunedPut) {
+                    exercised = prunedPutStep(values, pUp, pDown, j, exercised, exerciseAt);
+                    for (int i = exercised; nodes && j <= 2 && i <= j; ++i) {
+                        values[i] = exerciseAt(i);
+                    }
+                    if (boundary) {
+                        boundary->spots[j] = exercised <= j ? nodeSpot(exercised)
+                                                            : std::numeric_limits<double>::quiet_NaN();
+                    }
+                } else {
+                    for (int i = 0; i <= j; ++i) {
+                        values[i] = std::max(pUp * values[i] + pDown * values[i + 1], exerciseAt(i));
+                    }
+                    if (boundary) {
+                        boundary->spots[j] = lowestExercised(values, j, exerciseAt, nodeSpot);
+                    }
+                }
+            }
+            
+            if (nodes && j == 2) {
+                std::copy(optionValues.begin(), optionValues.begin() + 3, nodes->step2);
+            } else if (nodes && j == 1) {
+                std::copy(optionValues.begin(), optionValues.begin() + 2, nodes->step1);
+            }
+        }
+        
+        return optionValues[0];
+    }
+    
+    // One tree's price and raw derivatives, with the control variate applied
+    // when enabled
+    double adjointCorrectedTree(Workspace& workspace, unsigned int steps, double* derivatives) const {
+        double value = adjointInduction(workspace, exerciseType_ == ExerciseType::American, steps, derivatives);
+        if (useControlVariate()) {
+            BlackScholesOption european(spot_, strike_, riskFreeRate_, volatility_, timeToMaturity_, type_);
+            Sensitivities exact = european.sensitivities();
+            double exactDerivatives[detail::adjointInputs];
+            detail::derivativesFrom(exact, exactDerivatives);
+            double tree[detail::adjointInputs];
+            value += exact.price - adjointInduction(workspace, false, steps, tree);
+            for (std::size_t k = 0; k < detail::adjointInputs; ++k) {
+                derivatives[k] += exactDerivatives[k] - tree[k];
+            }
+        }
+        return value;
+    }
+    
+    double adjointInduction(Workspace& workspace, bool american, unsigned int steps, double* derivatives) const {
+        if (type_ == OptionType::Call) {
+            return american ? adjointKernel<true>(workspace, CallPayoff{strike_}, steps, derivatives)
+                            : adjointKernel<false>(workspace, CallPayoff{strike_}, steps, derivatives);
+        }
+        return american ? adjointKernel<true>(workspace, PutPayoff{strike_}, steps, derivatives)
+                        : adjointKernel<false>(workspace, PutPayoff{strike_}, steps, derivatives);
+    }
+    
+    // Price of one tree, writing its derivatives in spot, volatility, rate
+    // and maturity. A continuation node passes its adjoint to its two
+    // children and adds adjoint * child value to the probabilities' adjoints;
+    // exercised and terminal nodes hand adjoint * payoff slope to the node
+    // spot, and so to the spot and the two log-moves. The node values and
+    // spots are computed exactly as in the pricing kernels, so the price
+    // matches price() for the same tree.
+    template <bool American, typename Payoff>
+    double adjointKernel(Workspace& workspace, const Payoff& payoff, unsigned int steps,
+                         double* derivatives) const {
+        recordMetric(MetricEngine::BinomialTree, MetricCounter::Nodes, treeNodes(steps));
+        using detail::AdjointDual;
+        AdjointDual spot = AdjointDual::variable(spot_, detail::AdjointSpot);
+        AdjointDual volatility = AdjointDual::variable(volatility_, detail::AdjointVolatility);
+        AdjointDual rate = AdjointDual::variable(riskFreeRate_, detail::AdjointRate);
+        AdjointDual maturity = AdjointDual::variable(timeToMaturity_, detail::AdjointMaturity);
+        bool leisenReimer = settings_.parametrization == BinomialParametrization::LeisenReimer;
+        TreeMoves<AdjointDual> moves = leisenReimer
+            ? leisenReimerMoves(spot, volatility, rate, maturity, steps)
+            : coxRossRubinsteinMoves(volatility, rate, maturity, steps);
+        
+        const int n = static_cast<int>(steps);
+        TreeAdjoints adjoints;
+        if (leisenReimer) {
+            std::vector<double>& tops = workspace.nodeSpots;
+            std::vector<double>& ratios = workspace.powers;
+            tops.resize(steps + 1);
+            ratios.resize(steps + 1);
+            for (int i = 0; i <= n; ++i) {
+                tops[i] = spot_ * exp(i * moves.logUp.v);
+                ratios[i] = exp(i * moves.logRatio.v);
+            }
+            auto nodeSpot = [&](int j, int i) { return tops[j] * ratios[i]; };
+            adjoints = adjointSweep<American>(workspace, payoff, nodeSpot, n, moves.pUp.v, moves.pDown.v);
+        } else {
+            const double* powers = coxRossRubinstein(steps).powers.data();
+            auto nodeSpot = [&](int j, int i) { return spot_ * powers[n + j - 2 * i]; };
+            adjoints = adjointSweep<American>(workspace, payoff, nodeSpot, n, moves.pUp.v, moves.pDown.v);
+        }
+        
+        for (std::size_t k = 0; k < detail::adjointInputs; ++k) {
+            derivatives[k] = adjoints.pUp * moves.pUp.d[k] + adjoints.pDown * moves.pDown.d[k] +
+                             adjoints.logUp * moves.logUp.d[k] + adjoints.logRatio * moves.logRatio.d[k];
+        }
+        derivatives[detail::AdjointSpot] += adjoints.logSpot / spot_;
+        return adjoints.value;
+    }
+    
+    // A tree's value and its adjoints with respect to the log node spots'
+    // three terms and the two discounted probabilities
+    struct TreeAdjoints {
+        double value;
+        double logSpot;
+        double logUp;
+        double logRatio;
+        double pUp;
+        double pDown;
+    };
+    
+    // The reverse pass walks from the root and needs step j + 1's values at
+    // step j. Keeping the whole lattice falls out of cache within a few
+    // hundred steps, so the forward pass keeps only every stride-th step and
+    // the reverse pass recomputes one stride at a time from its checkpoint:
+    // one extra induction for about 2 * steps^1.5 doubles.
+    template <bool American, typename Payoff, typename NodeSpot>
+    TreeAdjoints adjointSweep(Workspace& workspace, const Payoff& payoff, const NodeSpot& nodeSpot,
+                              int n, double pUp, double pDown) const {
+        constexpr double negligibleAdjoint = 1e-280;
+        const int stride = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(n))));
+        const std::size_t width = std::size_t(n) + 1;
+        const int checkpointCount = n / stride;
+        
+        // Rows 0..checkpointCount hold steps m * stride, then stride + 1 rows
+        // for the stretch being replayed
+        std::vector<double>& values = workspace.nodeValues;
+        values.resize((checkpointCount + stride + 2) * width);
+        double* checkpoints = values.data();
+        double* stretch = checkpoints + (checkpointCount + 1) * width;
+        std::vector<unsigned char>& exercised = workspace.exercised;
+        if constexpr (American) {
+            exercised.resize(stride * width);
+        }
+        
+        auto terminal = [&](double* level) {
+            for (int i = 0; i <= n; ++i) {
+                level[i] = payoff(nodeSpot(n, i));
+            }
+        };
+        auto induct = [&](int j, const double* next, double* level, unsigned char* flags) {
+            for (int i = 0; i <= j; ++i) {
+                double continuation = pUp * next[i] + pDown * next[i + 1];
+                if constexpr (American) {
+                    double exercise = payoff(nodeSpot(j, i));
+                    flags[i] = continuation < exercise;
+                    level[i] = std::max(continuation, exercise);
+                } else {
+                    level[i] = continuation;
+                }
+            }
+        };
+        
+        // Forward induction, two stretch rows as the working pair
+        double* next = stretch;
+        double* level = stretch + width;
+        terminal(next);
+        if (n % stride == 0) {
+            std::copy(next, next + width, checkpoints + checkpointCount * width);
+        }
+        for (int j = n - 1; j >= 0; --j) {
+            induct(j, next, level, exercised.data());
+            std::swap(next, level);
+            if (j % stride == 0) {
+                std::copy(next, next + j + 1, checkpoints + (j / stride) * width);
+            }
+        }
+        
+        TreeAdjoints result{next[0], 0.0, 0.0, 0.0, 0.0, 0.0};
+        auto payoffNode = [&](int j, int i, double a) {
+            double s = nodeSpot(j, i);
+            double slope = a * payoff.derivative(s) * s;
+            result.logSpot += slope;
+            result.logUp += j * slope;
+            result.logRatio += i * slope;
+        };
+        
+        // Reverse pass from the root, one stride at a time
+        std::vector<double>& nodeAdjoints = workspace.nodeAdjoints;
+        nodeAdjoints.resize(2 * width);
+        double* adjoint = nodeAdjoints.data();
+        double* nextAdjoint = adjoint + width;
+        adjoint[0] = 1.0;
+        for (int base = 0; base < n; base += stride) {
+            int top = std::min(base + stride, n);
+            double* topRow = stretch + (top - base) * width;
+            if (top % stride == 0) {
+                std::copy(checkpoints + (top / stride) * width, checkpoints + (top / stride) * width + top + 1,
+                          topRow);
+            } else {
+                terminal(topRow);
+            }
+            for (int j = top - 1; j > base; --j) {
+                induct(j, stretch + (j + 1 - base) * width, stretch + (j - base) * width,
+                       exercised.data() + (j - base) * width);
+            }
+            if constexpr (American) {
+                // The stretch's first step only for its exercise flags
+                induct(base, stretch + width, stretch, exercised.data());
+            }
+            
+            for (int j = base; j < top; ++j) {
+                const double* values = stretch + (j + 1 - base) * width;
+                const unsigned char* flags = exercised.data() + (j - base) * width;
+                std::fill(nextAdjoint, nextAdjoint + j + 2, 0.0);
+                for (int i = 0; i <= j; ++i) {
+                    // Tail adjoints decay like 2^-j and would otherwise go
+                    // subnormal past about a thousand steps
+                    double a = adjoint[i];
+                    if (std::fabs(a) < negligibleAdjoint) {
+                        continue;
+                    }
+                    if constexpr (American) {
+                        if (flags[i]) {
+                            payoffNode(j, i, a);
+                            continue;
+                        }
+                    }
+                    result.pUp += a * values[i];
+                    result.pDown += a * values[i + 1];
+                    nextAdjoint[i] += pUp * a;
+                    nextAdjoint[i + 1] += pDown * a;
+                }
+                std::swap(adjoint, nextAdjoint);
+            }
+        }
+        for (int i = 0; i <= n; ++i) {
+            payoffNode(n, i, adjoint[i]);
+        }
+        return result;
+    }
 };
 
 
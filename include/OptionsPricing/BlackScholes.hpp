@@ -2,6 +2,8 @@
 #define OPTIONS_PRICING_BLACK_SCHOLES_HPP
 
 #include "Common.hpp"
+#include "Adjoint.hpp"
+#include "Metrics.hpp"
 
 namespace OptionsPricing {
 
@@ -13,77 +15,44 @@ public:
         : Option(spot, strike, riskFreeRate, volatility, timeToMaturity, 
                  type, ExerciseType::European) {}
     
-    // Price the option using Black-Scholes formula
+    // Price the option using Black-Scholes formula. This and risk() are
+    // counted but not timed: a PricingProbe would cost more than the formula.
     double price() const override {
+        recordMetric(MetricEngine::BlackScholes, MetricCounter::Calls);
         if (exerciseType_ != ExerciseType::European) {
             throw std::invalid_argument("Black-Scholes model only applicable for European options");
         }
         
-        double d1 = (log(spot_ / strike_) + (riskFreeRate_ + volatility_ * volatility_ / 2.0) * timeToMaturity_) / 
-                   (volatility_ * sqrt(timeToMaturity_));
-        double d2 = d1 - volatility_ * sqrt(timeToMaturity_);
-        
-        if (type_ == OptionType::Call) {
-            return spot_ * normalCDF(d1) - strike_ * exp(-riskFreeRate_ * timeToMaturity_) * normalCDF(d2);
-        } else {  // Put
-            return strike_ * exp(-riskFreeRate_ * timeToMaturity_) * normalCDF(-d2) - spot_ * normalCDF(-d1);
-        }
+        Terms t = terms();
+        return priceFrom(signedCDF(t.d1), signedCDF(t.d2), discount());
     }
     
     // Calculate delta
-    double delta() const {
-        double d1 = (log(spot_ / strike_) + (riskFreeRate_ + volatility_ * volatility_ / 2.0) * timeToMaturity_) / 
-                   (volatility_ * sqrt(timeToMaturity_));
-        
-        if (type_ == OptionType::Call) {
-            return normalCDF(d1);
-        } else {  // Put
-            return normalCDF(d1) - 1.0;
-        }
+    double delta() const override {
+        return deltaFrom(signedCDF(terms().d1));
     }
     
     // Calculate gamma
-    double gamma() const {
-        double d1 = (log(spot_ / strike_) + (riskFreeRate_ + volatility_ * volatility_ / 2.0) * timeToMaturity_) / 
-                   (volatility_ * sqrt(timeToMaturity_));
-        
-        return normalPDF(d1) / (spot_ * volatility_ * sqrt(timeToMaturity_));
+    double gamma() const override {
+        Terms t = terms();
+        return gammaFrom(t, normalPDF(t.d1));
     }
     
     // Calculate theta
     double theta() const {
-        double d1 = (log(spot_ / strike_) + (riskFreeRate_ + volatility_ * volatility_ / 2.0) * timeToMaturity_) / 
-                   (volatility_ * sqrt(timeToMaturity_));
-        double d2 = d1 - volatility_ * sqrt(timeToMaturity_);
-        
-        if (type_ == OptionType::Call) {
-            return -spot_ * normalPDF(d1) * volatility_ / (2.0 * sqrt(timeToMaturity_)) - 
-                   riskFreeRate_ * strike_ * exp(-riskFreeRate_ * timeToMaturity_) * normalCDF(d2);
-        } else {  // Put
-            return -spot_ * normalPDF(d1) * volatility_ / (2.0 * sqrt(timeToMaturity_)) + 
-                   riskFreeRate_ * strike_ * exp(-riskFreeRate_ * timeToMaturity_) * normalCDF(-d2);
-        }
+        Terms t = terms();
+        return thetaFrom(t, normalPDF(t.d1), signedCDF(t.d2), discount());
     }
     
     // Calculate vega
     double vega() const {
-        double d1 = (log(spot_ / strike_) + (riskFreeRate_ + volatility_ * volatility_ / 2.0) * timeToMaturity_) / 
-                   (volatility_ * sqrt(timeToMaturity_));
-        
-        return spot_ * sqrt(timeToMaturity_) * normalPDF(d1) / 100.0;  // Divided by 100 to represent 1% change
+        Terms t = terms();
+        return vegaFrom(t, normalPDF(t.d1));  // Per 1% change in volatility
     }
     
     // Calculate rho
     double rho() const {
-        double d1 = (log(spot_ / strike_) + (riskFreeRate_ + volatility_ * volatility_ / 2.0) * timeToMaturity_) / 
-                   (volatility_ * sqrt(timeToMaturity_));
-        double d2 = d1 - volatility_ * sqrt(timeToMaturity_);
-        
-        if (type_ == OptionType::Call) {
-            return strike_ * timeToMaturity_ * exp(-riskFreeRate_ * timeToMaturity_) * normalCDF(d2) / 100.0;
-        } else {  // Put
-            return -strike_ * timeToMaturity_ * exp(-riskFreeRate_ * timeToMaturity_) * normalCDF(-d2) / 100.0;
-        }
+        return rhoFrom(signedCDF(terms().d2), discount());  // Per 1% change in interest rate
     }
     
     // Calculate all Greeks at once
@@ -96,10 +65,126 @@ public:
     };
     
     Greeks calculateGreeks() const {
-        return {delta(), gamma(), theta(), vega(), rho()};
+        FullGreeks g = calculateAllGreeks();
+        return {g.delta, g.gamma, g.theta, g.vega, g.rho};
+    }
+    
+    // Closed-form first-order sensitivities, the reference for the numerical
+    // engines' sensitivities()
+    Sensitivities sensitivities() const {
+        FullGreeks g = calculateAllGreeks();
+        return {g.price, g.delta, g.vega, g.rho, g.theta};
+    }
+    
+    // Price, delta and gamma from one set of intermediates
+    PositionRisk risk() const override {
+        recordMetric(MetricEngine::BlackScholes, MetricCounter::Calls);
+        Terms t = terms();
+        double cdfD1 = signedCDF(t.d1);
+        return {priceFrom(cdfD1, signedCDF(t.d2), discount()), deltaFrom(cdfD1), gammaFrom(t, normalPDF(t.d1))};
+    }
+    
+    std::unique_ptr<Option> withMarket(double spot, double volatility, double timeToMaturity) const override {
+        return std::make_unique<BlackScholesOption>(spot, strike_, riskFreeRate_, volatility, timeToMaturity, type_);
+    }
+    
+    // Price plus first- and second-order Greeks. Vanna and volga use the same
+    // per-1% volatility scaling as vega; charm is dDelta/dt per year, matching
+    // the sign convention of theta.
+    struct FullGreeks {
+        double price;
+        double delta;
+        double gamma;
+        double theta;
+        double vega;
+        double rho;
+        double vanna;
+        double volga;
+        double charm;
+    };
+    
+    // Single pass: one log, sqrt and exp, and each normal CDF/PDF evaluated once
+    FullGreeks calculateAllGreeks() const {
+        Terms t = terms();
+        double df = discount();
+        double cdfD1 = signedCDF(t.d1);
+        double cdfD2 = signedCDF(t.d2);
+        double pdfD1 = normalPDF(t.d1);
+        
+        FullGreeks g;
+        g.price = priceFrom(cdfD1, cdfD2, df);
+        g.delta = deltaFrom(cdfD1);
+        g.gamma = gammaFrom(t, pdfD1);
+        g.theta = thetaFrom(t, pdfD1, cdfD2, df);
+        g.vega = vegaFrom(t, pdfD1);
+        g.rho = rhoFrom(cdfD2, df);
+        g.vanna = -pdfD1 * t.d2 / volatility_ / 100.0;
+        g.volga = spot_ * t.sqrtT * pdfD1 * t.d1 * t.d2 / volatility_ / 10000.0;
+        g.charm = -pdfD1 * (2.0 * riskFreeRate_ * timeToMaturity_ - t.d2 * t.volSqrtT) /
+                  (2.0 * timeToMaturity_ * t.volSqrtT);
+        return g;
+    }
+    
+private:
+    // Intermediates shared by the price and every Greek
+    struct Terms {
+        double sqrtT;
+        double volSqrtT;
+        double d1;
+        double d2;
+    };
+    
+    Terms terms() const {
+        Terms t;
+        t.sqrtT = sqrt(timeToMaturity_);
+        t.volSqrtT = volatility_ * t.sqrtT;
+        t.d1 = (log(spot_ / strike_) + (riskFreeRate_ + volatility_ * volatility_ / 2.0) * timeToMaturity_) / 
+               t.volSqrtT;
+        t.d2 = t.d1 - t.volSqrtT;
+        return t;
+    }
+    
+    double discount() const {
+        return exp(-riskFreeRate_ * timeToMaturity_);
+    }
+    
+    // N(d) for calls, N(-d) for puts
+    double signedCDF(double d) const {
+        return (type_ == OptionType::Call) ? normalCDF(d) : normalCDF(-d);
+    }
+    
+    double priceFrom(double cdfD1, double cdfD2, double df) const {
+        if (type_ == OptionType::Call) {
+            return spot_ * cdfD1 - strike_ * df * cdfD2;
+        } else {  // Put
+            return strike_ * df * cdfD2 - spot_ * cdfD1;
+        }
+    }
+    
+    double deltaFrom(double cdfD1) const {
+        return (type_ == OptionType::Call) ? cdfD1 : -cdfD1;
+    }
+    
+    double gammaFrom(const Terms& t, double pdfD1) const {
+        return pdfD1 / (spot_ * t.volSqrtT);
+    }
+    
+    double thetaFrom(const Terms& t, double pdfD1, double cdfD2, double df) const {
+        double decay = -spot_ * pdfD1 * volatility_ / (2.0 * t.sqrtT);
+        double carry = riskFreeRate_ * strike_ * df * cdfD2;
+        return (type_ == OptionType::Call) ? decay - carry : decay + carry;
+    }
+    
+    double vegaFrom(const Terms& t, double pdfD1) const {
+        return spot_ * t.sqrtT * pdfD1 / 100.0;
+    }
+    
+    double rhoFrom(double cdfD2, double df) const {
+        double rho = strike_ * timeToMaturity_ * df * cdfD2 / 100.0;
+        return (type_ == OptionType::Call) ? rho : -rho;
     }
 };
 
 } // namespace OptionsPricing
 
-#endif // OPTIONS_PRICING_BLACK_SCHOLES_HPP
\ No newline at end of file
+#endif // OPTIONS_PRICING_BLACK_SCHOLES_HPP
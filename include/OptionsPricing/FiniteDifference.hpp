@@ -0,0 +1,658 @@
+#ifndef OPTIONS_PRICING_FINITE_DIFFERENCE_HPP
+#define OPTIONS_PRICING_FINITE_DIFFERENCE_HPP
+
+#include "Common.hpp"
+#include "Adjoint.hpp"
+#include "Metrics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace OptionsPricing {
+
+// How the American constraint V >= payoff is imposed at each time step
+enum class EarlyExerciseSolver {
+    BrennanSchwartz,  // one tridiagonal solve, projecting during back-substitution
+    PSOR              // projected successive over-relaxation, iterated to tolerance
+};
+
+struct FiniteDifferenceSettings {
+    unsigned int timeSteps = 50;
+    unsigned int spaceSteps = 400;    // log-spot intervals, rounded up to even
+    double width = 5.0;               // grid half-width in standard deviations, sigma * sqrt(T)
+    double timeGrading = 2.0;         // tau_n = T * (n / N)^grading; 1 gives uniform steps
+    unsigned int rannacherSteps = 2;  // leading steps taken as two implicit half-steps each
+    EarlyExerciseSolver solver = EarlyExerciseSolver::BrennanSchwartz;
+    double relaxation = 1.2;          // PSOR over-relaxation factor, in (0, 2)
+    double tolerance = 1e-12;         // PSOR stop on the largest node update
+    unsigned int maxIterations = 1000;
+};
+
+// Crank-Nicolson finite-difference engine for the Black-Scholes PDE in log
+// spot.
+//
+// The grid is uniform in x = log(S) and has the spot on its centre node, so
+// value, delta and gamma are read off the three centre nodes and theta off
+// the last two time steps, with no repricing. Payoffs are averaged over each
+// grid cell and the first steps are fully implicit (Rannacher), which damps
+// the kink at the strike and gives smooth second-order convergence where the
+// trees oscillate. Time steps are graded towards expiry, where the American
+// exercise boundary moves fastest; without grading the American error is
+// first order in the time step. Every step is a single Thomas sweep, and for
+// American options Brennan-Schwartz applies the exercise constraint inside
+// that sweep. The grid depends on the strike only through its width, so
+// priceStrikes() values a whole strike ladder on one grid and workspace.
+class FiniteDifferenceOption : public Option {
+public:
+    FiniteDifferenceOption(double spot, double strike, double riskFreeRate,
+                           double volatility, double timeToMaturity,
+                           OptionType type, ExerciseType exerciseType,
+                           FiniteDifferenceSettings settings = FiniteDifferenceSettings())
+        : Option(spot, strike, riskFreeRate, volatility, timeToMaturity,
+                 type, exerciseType), settings_(settings) {
+        if (settings_.timeSteps == 0) {
+            throw std::invalid_argument("Finite differences need at least one time step");
+        }
+        if (settings_.spaceSteps < 4) {
+            throw std::invalid_argument("Finite differences need at least four space steps");
+        }
+        if (!(settings_.width > 0.0)) {
+            throw std::invalid_argument("Finite-difference grid width must be positive");
+        }
+        if (!(settings_.timeGrading >= 1.0)) {
+            throw std::invalid_argument("Finite-difference time grading must be at least 1");
+        }
+        if (!(settings_.relaxation > 0.0 && settings_.relaxation < 2.0)) {
+            throw std::invalid_argument("PSOR relaxation must lie in (0, 2)");
+        }
+        settings_.spaceSteps += settings_.spaceSteps % 2;
+    }
+
+    // Strikes a ladder solves side by side, sharing every tridiagonal sweep
+    static constexpr unsigned int ladderWidth = 4;
+
+    // Scratch buffers for price(), 5 * (spaceSteps + 1) doubles; priceStrikes()
+    // needs ladderWidth times as much for the per-strike arrays. Reusing one
+    // across calls means repeated pricing performs no heap allocations.
+    struct Workspace {
+        // One theta-scheme step as sensitivities() records it
+        struct Step {
+            double tau;
+            double theta;
+            double h;
+        };
+        
+        std::vector<double> values;          // [node][strike]
+        std::vector<double> rhs;             // [node][strike]
+        std::vector<double> exerciseValues;  // [node][strike]
+        std::vector<double> pivotsCrankNicolson;  // inverted Thomas pivots, per node
+        std::vector<double> pivotsImplicit;
+        std::vector<double> levels;       // sensitivities(): the grid before and after every step
+        std::vector<Step> steps;          // sensitivities(): the steps between those levels
+        std::vector<double> adjoints;     // sensitivities(): derivative of the price in each node value
+        std::vector<double> multipliers;  // sensitivities(): transposed solve of one step
+    };
+
+    // Bytes of scratch memory a price() call with these settings needs
+    static std::size_t workspaceBytes(const FiniteDifferenceSettings& settings) {
+        std::size_t nodes = settings.spaceSteps + settings.spaceSteps % 2 + 1;
+        return 5 * nodes * sizeof(double);
+    }
+
+    // Value, delta, gamma and theta straight off the final grid
+    struct GridGreeks {
+        double value;
+        double delta;
+        double gamma;
+        double theta;
+    };
+
+    double price() const override {
+        return price(threadWorkspace());
+    }
+
+    double price(Workspace& workspace) const {
+        return gridGreeks(workspace).value;
+    }
+
+    GridGreeks gridGreeks() const {
+        return gridGreeks(threadWorkspace());
+    }
+
+    GridGreeks gridGreeks(Workspace& workspace) const {
+        PricingProbe probe(MetricEngine::FiniteDifference);
+        GridGreeks greeks;
+        solve<1>(&strike_, gridFor(&strike_, 1), workspace, &greeks);
+        return greeks;
+    }
+
+    // Price with vega and rho from one adjoint sweep back through the
+    // recorded steps, and delta and theta off the grid. The grid is held
+    // where this volatility and maturity put it, so vega and rho are the
+    // derivatives of the discrete scheme: each step's solve is transposed,
+    // with exercised nodes dropped, and the sweep collects the derivative in
+    // the generator's three coefficients and in the boundary values. That
+    // costs about two and a half prices and keeps (time steps + Rannacher
+    // steps + 1) * nodes doubles, against four repricings for central bumps.
+    Sensitivities sensitivities() const {
+        return sensitivities(threadWorkspace());
+    }
+    
+    Sensitivities sensitivities(Workspace& workspace) const {
+        PricingProbe probe(MetricEngine::FiniteDifference);
+        Grid grid = gridFor(&strike_, 1);
+        GridGreeks greeks;
+        solve<1>(&strike_, grid, workspace, &greeks, true);
+        double derivatives[2];
+        adjointSweep(grid, workspace, derivatives);
+        return {greeks.value, greeks.delta, derivatives[0] / 100.0, derivatives[1] / 100.0, greeks.theta};
+    }
+    
+    double delta() const override { return gridGreeks().delta; }
+    double gamma() const override { return gridGreeks().gamma; }
+    double theta() const { return gridGreeks().theta; }
+
+    PositionRisk risk() const override {
+        GridGreeks greeks = gridGreeks();
+        return {greeks.value, greeks.delta, greeks.gamma};
+    }
+
+    // Price this contract at every strike in [strikes, strikes + count) on one
+    // grid wide enough for all of them. Strikes go through the solver
+    // ladderWidth at a time, so the serial Thomas recurrences of several
+    // strikes overlap. The option's own strike is not used.
+    void priceStrikes(const double* strikes, std::size_t count, double* out, Workspace& workspace) const {
+        PricingProbe probe(MetricEngine::FiniteDifference);
+        if (count == 0) {
+            return;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            if (!(strikes[i] > 0.0)) {
+                throw std::invalid_argument("Strike price must be positive");
+            }
+        }
+        Grid grid = gridFor(strikes, count);
+        for (std::size_t i = 0; i < count; i += ladderWidth) {
+            GridGreeks greeks[ladderWidth];
+            if (i + 1 == count) {
+                solve<1>(strikes + i, grid, workspace, greeks);
+                out[i] = greeks[0].value;
+                break;
+            }
+            // Pad a short last group by repeating its final strike
+            double group[ladderWidth];
+            for (unsigned int k = 0; k < ladderWidth; ++k) {
+                group[k] = strikes[std::min(i + k, count - 1)];
+            }
+            solve<ladderWidth>(group, grid, workspace, greeks);
+            for (unsigned int k = 0; k < ladderWidth && i + k < count; ++k) {
+                out[i + k] = greeks[k].value;
+            }
+        }
+    }
+
+    std::vector<double> priceStrikes(const std::vector<double>& strikes) const {
+        std::vector<double> out(strikes.size());
+        priceStrikes(strikes.data(), strikes.size(), out.data(), threadWorkspace());
+        return out;
+    }
+
+    // Each node-step is a row update and two serial sweeps, about a third of a
+    // closed-form evaluation
+    double pricingCost() const override {
+        return 1.0 + static_cast<double>(settings_.timeSteps) * settings_.spaceSteps / 3.0;
+    }
+
+    std::unique_ptr<Option> withMarket(double spot, double volatility, double timeToMaturity) const override {
+        return std::make_unique<FiniteDifferenceOption>(spot, strike_, riskFreeRate_, volatility, timeToMaturity,
+                                                        type_, exerciseType_, settings_);
+    }
+
+    const FiniteDifferenceSettings& settings() const { return settings_; }
+
+private:
+    FiniteDifferenceSettings settings_;
+
+    // Node i sits at x = xMin + i * dx, node `centre` at log(spot)
+    struct Grid {
+        double xMin;
+        double dx;
+        unsigned int nodes;
+        unsigned int centre;
+    };
+
+    // Constant rows -lower * V[i-1] + diagonal * V[i] - upper * V[i+1] of
+    // (I - theta * h * L) for one step length h
+    struct Stencil {
+        double lower;
+        double diagonal;
+        double upper;
+    };
+
+    static Workspace& threadWorkspace() {
+        thread_local Workspace workspace;
+        return workspace;
+    }
+
+    Grid gridFor(const double* strikes, std::size_t count) const {
+        // Wide enough that every strike sits well inside the grid
+        double farthest = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            farthest = std::max(farthest, std::fabs(std::log(strikes[i] / spot_)));
+        }
+        double halfWidth = settings_.width * volatility_ * std::sqrt(timeToMaturity_) + farthest;
+        unsigned int centre = settings_.spaceSteps / 2;
+        double dx = halfWidth / centre;
+        return {std::log(spot_) - centre * dx, dx, settings_.spaceSteps + 1, centre};
+    }
+
+    // Generator coefficients of V_tau = 0.5 sigma^2 V_xx + (r - 0.5 sigma^2) V_x - r V
+    void generator(const Grid& grid, double& a, double& b, double& c) const {
+        double diffusion = 0.5 * volatility_ * volatility_ / (grid.dx * grid.dx);
+        double drift = (riskFreeRate_ - 0.5 * volatility_ * volatility_) / (2.0 * grid.dx);
+        a = diffusion - drift;
+        b = -2.0 * diffusion - riskFreeRate_;
+        c = diffusion + drift;
+    }
+
+    Stencil stencil(const Grid& grid, double theta, double h) const {
+        double a, b, c;
+        generator(grid, a, b, c);
+        return {theta * h * a, 1.0 - theta * h * b, theta * h * c};
+    }
+
+    // Inverted Thomas pivots for the interior rows 1 .. nodes - 2. Only the
+    // product lower * upper enters, so the same pivots, read from the other
+    // end, serve the top-down elimination Brennan-Schwartz needs for puts.
+    // The pivots settle geometrically on the fixed point of p = d - lu / p,
+    // within a few dozen rows, after which the rest are copied.
+    static void factor(const Stencil& s, unsigned int nodes, std::vector<double>& inversePivots) {
+        inversePivots.resize(nodes);
+        const double product = s.lower * s.upper;
+        double pivot = s.diagonal;
+        double inverse = 1.0 / pivot;
+        inversePivots[1] = inverse;
+        unsigned int i = 2;
+        for (; i + 1 < nodes; ++i) {
+            double next = s.diagonal - product * inverse;
+            inverse = 1.0 / next;
+            inversePivots[i] = inverse;
+            bool settled = std::fabs(next - pivot) <= 4e-16 * next;
+            pivot = next;
+            if (settled) {
+                break;
+            }
+        }
+        for (++i; i + 1 < nodes; ++i) {
+            inversePivots[i] = inversePivots[i - 1];
+        }
+    }
+
+    // Cell average of the payoff over [x - dx/2, x + dx/2], which keeps the
+    // strike kink from spoiling second-order convergence
+    double averagePayoff(double strike, double x, double dx) const {
+        double left = x - 0.5 * dx;
+        double right = x + 0.5 * dx;
+        double logStrike = std::log(strike);
+        double expLeft = std::exp(left);
+        double expRight = std::exp(right);
+        if (type_ == OptionType::Call) {
+            if (logStrike <= left) return (expRight - expLeft) / dx - strike;
+            if (logStrike >= right) return 0.0;
+            return (expRight - strike - strike * (right - logStrike)) / dx;
+        }
+        if (logStrike >= right) return strike - (expRight - expLeft) / dx;
+        if (logStrike <= left) return 0.0;
+        return (strike * (logStrike - left) - (strike - expLeft)) / dx;
+    }
+
+    // Dirichlet values at both ends, tau years before expiry
+    void boundaries(double strike, double tau, double lowSpot, double highSpot,
+                    double& low, double& high) const {
+        double discountedStrike = strike * std::exp(-riskFreeRate_ * tau);
+        if (type_ == OptionType::Call) {
+            low = 0.0;
+            high = std::max(highSpot - discountedStrike, 0.0);
+            if (exerciseType_ == ExerciseType::American) {
+                high = std::max(high, highSpot - strike);
+            }
+        } else {
+            low = std::max(discountedStrike - lowSpot, 0.0);
+            if (exerciseType_ == ExerciseType::American) {
+                low = std::max(low, strike - lowSpot);
+            }
+            high = 0.0;
+        }
+    }
+
+    // Derivative in the rate of the Dirichlet values boundaries() sets
+    void boundaryRateSlopes(double strike, double tau, double lowSpot, double highSpot,
+                            double& low, double& high) const {
+        double discountedStrike = strike * std::exp(-riskFreeRate_ * tau);
+        bool american = exerciseType_ == ExerciseType::American;
+        low = 0.0;
+        high = 0.0;
+        if (type_ == OptionType::Call) {
+            if (highSpot > discountedStrike && (!american || discountedStrike <= strike)) {
+                high = tau * discountedStrike;
+            }
+        } else if (discountedStrike > lowSpot && (!american || discountedStrike > strike)) {
+            low = -tau * discountedStrike;
+        }
+    }
+
+    // One theta-scheme step of length h, from values at tau - h to tau, for
+    // Lanes strikes stored side by side at every node
+    template <unsigned int Lanes>
+    void step(Workspace& ws, const Grid& grid, const double* strikes, double tau, double theta, double h,
+              const Stencil& s, const std::vector<double>& inversePivots) const {
+        const unsigned int last = grid.nodes - 1;
+        double* v = ws.values.data();
+        double* rhs = ws.rhs.data();
+
+        double a, b, c;
+        generator(grid, a, b, c);
+        double explicitPart = (1.0 - theta) * h;
+        for (unsigned int i = 1; i < last; ++i) {
+            for (unsigned int k = 0; k < Lanes; ++k) {
+                const double* u = v + i * Lanes + k;
+                rhs[i * Lanes + k] = u[0] + explicitPart * (a * u[-static_cast<int>(Lanes)] + b * u[0] + c * u[Lanes]);
+            }
+        }
+        double lowSpot = std::exp(grid.xMin);
+        double highSpot = std::exp(grid.xMin + last * grid.dx);
+        for (unsigned int k = 0; k < Lanes; ++k) {
+            double low, high;
+            boundaries(strikes[k], tau, lowSpot, highSpot, low, high);
+            v[k] = low;
+            v[last * Lanes + k] = high;
+            rhs[Lanes + k] += s.lower * low;
+            rhs[(last - 1) * Lanes + k] += s.upper * high;
+        }
+
+        bool american = exerciseType_ == ExerciseType::American;
+        if (!american) {
+            solveBottomUp<Lanes, false>(ws, s, inversePivots, last);
+        } else if (settings_.solver == EarlyExerciseSolver::PSOR) {
+            solvePSOR<Lanes>(ws, s, last);
+        } else if (type_ == OptionType::Put) {
+            solveTopDown<Lanes>(ws, s, inversePivots, last);
+        } else {
+            solveBottomUp<Lanes, true>(ws, s, inversePivots, last);
+        }
+    }
+
+    // Thomas: eliminate upwards from row 1, back-substitute from the top. For
+    // a call the exercise region is at the top, where back-substitution starts.
+    // The running values stay in registers and the eliminated right-hand side
+    // is stored pre-divided by its pivot, so each sweep is one multiply-add
+    // deep per row.
+    template <unsigned int Lanes, bool Project>
+    static void solveBottomUp(Workspace& ws, const Stencil& s, const std::vector<double>& inversePivots,
+                              unsigned int last) {
+        double* v = ws.values.data();
+        double* y = ws.rhs.data();
+        const double* exercise = ws.exerciseValues.data();
+        const double* inverse = inversePivots.data();
+        double carry[Lanes];
+        for (unsigned int k = 0; k < Lanes; ++k) {
+            carry[k] = y[Lanes + k];
+            y[Lanes + k] *= inverse[1];
+        }
+        for (unsigned int i = 2; i < last; ++i) {
+            double m = s.lower * inverse[i - 1];
+            for (unsigned int k = 0; k < Lanes; ++k) {
+                carry[k] = y[i * Lanes + k] + m * carry[k];
+                y[i * Lanes + k] = carry[k] * inverse[i];
+            }
+        }
+        for (unsigned int k = 0; k < Lanes; ++k) {
+            carry[k] = v[last * Lanes + k];
+        }
+        for (unsigned int i = last - 1; i >= 1; --i) {
+            double m = s.upper * inverse[i];
+            for (unsigned int k = 0; k < Lanes; ++k) {
+                carry[k] = y[i * Lanes + k] + m * carry[k];
+                if (Project) {
+                    carry[k] = std::max(carry[k], exercise[i * Lanes + k]);
+                }
+                v[i * Lanes + k] = carry[k];
+            }
+        }
+    }
+
+    // Mirror image: eliminate downwards from the top row and back-substitute
+    // from row 1, so a put's exercise region near zero is resolved first
+    template <unsigned int Lanes>
+    static void solveTopDown(Workspace& ws, const Stencil& s, const std::vector<double>& inversePivots,
+                             unsigned int last) {
+        double* v = ws.values.data();
+        double* y = ws.rhs.data();
+        const double* exercise = ws.exerciseValues.data();
+        const double* inverse = inversePivots.data();
+        double carry[Lanes];
+        for (unsigned int k = 0; k < Lanes; ++k) {
+            carry[k] = y[(last - 1) * Lanes + k];
+            y[(last - 1) * Lanes + k] *= inverse[1];
+        }
+        for (unsigned int i = last - 2; i >= 1; --i) {
+            double m = s.upper * inverse[last - i - 1];
+            for (unsigned int k = 0; k < Lanes; ++k) {
+                carry[k] = y[i * Lanes + k] + m * carry[k];
+                y[i * Lanes + k] = carry[k] * inverse[last - i];
+            }
+        }
+        for (unsigned int k = 0; k < Lanes; ++k) {
+            carry[k] = v[k];
+        }
+        for (unsigned int i = 1; i < last; ++i) {
+            double m = s.lower * inverse[last - i];
+            for (unsigned int k = 0; k < Lanes; ++k) {
+                carry[k] = std::max(y[i * Lanes + k] + m * carry[k], exercise[i * Lanes + k]);
+                v[i * Lanes + k] = carry[k];
+            }
+        }
+    }
+
+    // Projected Gauss-Seidel with over-relaxation, warm-started from the
+    // previous time level
+    template <unsigned int Lanes>
+    void solvePSOR(Workspace& ws, const Stencil& s, unsigned int last) const {
+        double* v = ws.values.data();
+        const double* y = ws.rhs.data();
+        const double* exercise = ws.exerciseValues.data();
+        const double omega = settings_.relaxation;
+        for (unsigned int iteration = 0; iteration < settings_.maxIterations; ++iteration) {
+            double largest = 0.0;
+            for (unsigned int i = 1; i < last; ++i) {
+                for (unsigned int k = 0; k < Lanes; ++k) {
+                    double* u = v + i * Lanes + k;
+                    double gaussSeidel = (y[i * Lanes + k] + s.lower * u[-static_cast<int>(Lanes)] +
+                                          s.upper * u[Lanes]) / s.diagonal;
+                    double next = std::max(u[0] + omega * (gaussSeidel - u[0]), exercise[i * Lanes + k]);
+                    largest = std::max(largest, std::fabs(next - u[0]));
+                    u[0] = next;
+                }
+            }
+            if (largest <= settings_.tolerance) {
+                recordMetric(MetricEngine::FiniteDifference, MetricCounter::Iterations, iteration + 1);
+                return;
+            }
+        }
+        recordMetric(MetricEngine::FiniteDifference, MetricCounter::Iterations, settings_.maxIterations);
+    }
+
+    // Roll the terminal payoffs of Lanes strikes back to today on one grid,
+    // tau_n = T * (n / N)^grading
+    template <unsigned int Lanes>
+    void solve(const double* strikes, const Grid& grid, Workspace& ws, GridGreeks* out, bool record = false) const {
+        const unsigned int nodes = grid.nodes;
+        const unsigned int steps = settings_.timeSteps;
+        const unsigned int rannacher = std::min(settings_.rannacherSteps, steps);
+        // Rannacher steps are taken as two half steps
+        recordMetric(MetricEngine::FiniteDifference, MetricCounter::Nodes,
+                     static_cast<std::uint64_t>(nodes) * Lanes * (steps + rannacher));
+
+        ws.values.resize(static_cast<std::size_t>(nodes) * Lanes);
+        ws.rhs.resize(static_cast<std::size_t>(nodes) * Lanes);
+        ws.exerciseValues.resize(static_cast<std::size_t>(nodes) * Lanes);
+        double sign = (type_ == OptionType::Call) ? 1.0 : -1.0;
+        for (unsigned int i = 0; i < nodes; ++i) {
+            double x = grid.xMin + i * grid.dx;
+            double spot = std::exp(x);
+            for (unsigned int k = 0; k < Lanes; ++k) {
+                ws.exerciseValues[i * Lanes + k] = std::max(sign * (spot - strikes[k]), 0.0);
+                ws.values[i * Lanes + k] = averagePayoff(strikes[k], x, grid.dx);
+            }
+        }
+
+        // Every level and step, for the adjoint sweep of sensitivities()
+        if (record) {
+            ws.levels.assign(ws.values.begin(), ws.values.end());
+            ws.steps.clear();
+        }
+        auto advance = [&](double to, double theta, double h, const Stencil& s, const std::vector<double>& pivots) {
+            step<Lanes>(ws, grid, strikes, to, theta, h, s, pivots);
+            if (record) {
+                ws.levels.insert(ws.levels.end(), ws.values.begin(), ws.values.end());
+                ws.steps.push_back({to, theta, h});
+            }
+        };
+
+        // Centre values and lengths of the last two steps, for theta
+        const std::size_t centre = static_cast<std::size_t>(grid.centre) * Lanes;
+        double previous[2][Lanes] = {};
+        double lengths[2] = {0.0, 0.0};
+        double tau = 0.0;
+        for (unsigned int n = 0; n < steps; ++n) {
+            for (unsigned int k = 0; k < Lanes; ++k) {
+                previous[1][k] = previous[0][k];
+                previous[0][k] = ws.values[centre + k];
+            }
+            double next = (n + 1 == steps)
+                ? timeToMaturity_
+                : timeToMaturity_ * std::pow(static_cast<double>(n + 1) / steps, settings_.timeGrading);
+            double h = next - tau;
+            lengths[1] = lengths[0];
+            lengths[0] = h;
+            if (n < rannacher) {
+                Stencil implicit = stencil(grid, 1.0, 0.5 * h);
+                factor(implicit, nodes, ws.pivotsImplicit);
+                advance(tau + 0.5 * h, 1.0, 0.5 * h, implicit, ws.pivotsImplicit);
+                advance(next, 1.0, 0.5 * h, implicit, ws.pivotsImplicit);
+            } else {
+                Stencil crankNicolson = stencil(grid, 0.5, h);
+                if (n == rannacher || settings_.timeGrading != 1.0) {
+                    factor(crankNicolson, nodes, ws.pivotsCrankNicolson);
+                }
+                advance(next, 0.5, h, crankNicolson, ws.pivotsCrankNicolson);
+            }
+            tau = next;
+        }
+
+        // Derivatives in log spot, converted to spot at the centre node; theta
+        // from a three-point backward difference when there are enough steps
+        double h1 = lengths[0];
+        double h2 = lengths[1];
+        for (unsigned int k = 0; k < Lanes; ++k) {
+            const double* v = ws.values.data() + centre + k;
+            double dVdx = (v[Lanes] - v[-static_cast<int>(Lanes)]) / (2.0 * grid.dx);
+            double d2Vdx2 = (v[Lanes] - 2.0 * v[0] + v[-static_cast<int>(Lanes)]) / (grid.dx * grid.dx);
+            out[k].value = v[0];
+            out[k].delta = dVdx / spot_;
+            out[k].gamma = (d2Vdx2 - dVdx) / (spot_ * spot_);
+            if (steps >= 2) {
+                out[k].theta = -(v[0] * (2.0 * h1 + h2) / (h1 * (h1 + h2)) -
+                                 previous[0][k] * (h1 + h2) / (h1 * h2) + previous[1][k] * h1 / (h2 * (h1 + h2)));
+            } else {
+                out[k].theta = (previous[0][k] - v[0]) / h1;
+            }
+        }
+    }
+
+    // Reverse pass over the steps solve() recorded for one strike, writing
+    // the derivatives of the centre value in volatility and rate. A step
+    // solves (I - theta h L) V' = (I + (1 - theta) h L) V + boundary terms on
+    // the nodes it does not exercise, so the derivative lambda in V' gives
+    // multipliers mu from the transposed system on those nodes, the
+    // coefficients a, b, c of L collect mu * (theta h V' + (1 - theta) h V)
+    // at the matching neighbour, and lambda in V is the explicit operator's
+    // transpose applied to mu.
+    void adjointSweep(const Grid& grid, Workspace& ws, double* derivatives) const {
+        const unsigned int nodes = grid.nodes;
+        const unsigned int last = nodes - 1;
+        const bool american = exerciseType_ == ExerciseType::American;
+        double a, b, c;
+        generator(grid, a, b, c);
+        double lowSpot = std::exp(grid.xMin);
+        double highSpot = std::exp(grid.xMin + last * grid.dx);
+        const double* exercise = ws.exerciseValues.data();
+
+        std::vector<double>& lambda = ws.adjoints;
+        std::vector<double>& mu = ws.multipliers;
+        lambda.assign(nodes, 0.0);
+        lambda[grid.centre] = 1.0;
+        mu.assign(nodes, 0.0);
+        double* pivots = ws.rhs.data();
+        double aAdjoint = 0.0, bAdjoint = 0.0, cAdjoint = 0.0, rateAdjoint = 0.0;
+        for (std::size_t n = ws.steps.size(); n-- > 0;) {
+            const Workspace::Step& step = ws.steps[n];
+            const double* v = ws.levels.data() + n * nodes;
+            const double* next = v + nodes;
+            double implicitPart = step.theta * step.h;
+            double explicitPart = (1.0 - step.theta) * step.h;
+
+            // Thomas on the transposed rows; an exercised node is held at its
+            // payoff and gets an identity row with no right-hand side
+            double pivot = 0.0;
+            double carry = 0.0;
+            for (unsigned int i = 1; i < last; ++i) {
+                bool held = american && next[i] <= exercise[i];
+                double lower = held ? 0.0 : -implicitPart * c;
+                double diagonal = held ? 1.0 : 1.0 - implicitPart * b;
+                double upper = held ? 0.0 : -implicitPart * a;
+                double inverse = 1.0 / (diagonal - lower * pivot);
+                pivot = upper * inverse;
+                carry = ((held ? 0.0 : lambda[i]) - lower * carry) * inverse;
+                pivots[i] = pivot;
+                mu[i] = carry;
+            }
+            for (unsigned int i = last - 2; i >= 1; --i) {
+                mu[i] -= pivots[i] * mu[i + 1];
+            }
+
+            for (unsigned int i = 1; i < last; ++i) {
+                aAdjoint += mu[i] * (implicitPart * next[i - 1] + explicitPart * v[i - 1]);
+                bAdjoint += mu[i] * (implicitPart * next[i] + explicitPart * v[i]);
+                cAdjoint += mu[i] * (implicitPart * next[i + 1] + explicitPart * v[i + 1]);
+            }
+            double lowSlope, highSlope;
+            boundaryRateSlopes(strike_, step.tau, lowSpot, highSpot, lowSlope, highSlope);
+            rateAdjoint += (lambda[0] + implicitPart * a * mu[1]) * lowSlope +
+                           (lambda[last] + implicitPart * c * mu[last - 1]) * highSlope;
+
+            lambda[0] = explicitPart * a * mu[1];
+            lambda[last] = explicitPart * c * mu[last - 1];
+            for (unsigned int i = 1; i < last; ++i) {
+                lambda[i] = mu[i] + explicitPart * (a * mu[i + 1] + b * mu[i] + c * mu[i - 1]);
+            }
+        }
+
+        // Chain rule through diffusion = sigma^2 / (2 dx^2) and
+        // drift = (r - sigma^2 / 2) / (2 dx)
+        double dx = grid.dx;
+        double diffusionSlope = volatility_ / (dx * dx);
+        double driftVolatilitySlope = -volatility_ / (2.0 * dx);
+        double driftRateSlope = 1.0 / (2.0 * dx);
+        derivatives[0] = aAdjoint * (diffusionSlope - driftVolatilitySlope) - 2.0 * bAdjoint * diffusionSlope +
+                         cAdjoint * (diffusionSlope + driftVolatilitySlope);
+        derivatives[1] = rateAdjoint - aAdjoint * driftRateSlope - bAdjoint + cAdjoint * driftRateSlope;
+    }
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_FINITE_DIFFERENCE_HPP
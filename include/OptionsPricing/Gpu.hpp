@@ -0,0 +1,80 @@
+#ifndef OPTIONS_PRICING_GPU_HPP
+#define OPTIONS_PRICING_GPU_HPP
+
+#include "BatchBlackScholes.hpp"
+#include "MonteCarlo.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+// CUDA offload for batch Black-Scholes and Monte Carlo. Unlike the rest of
+// the library this part is compiled: configure with
+// -DOPTIONS_PRICING_BUILD_CUDA=ON and link options_pricing_cuda, which also
+// defines OPTIONS_PRICING_HAS_CUDA. The header itself needs no CUDA headers.
+
+namespace OptionsPricing {
+
+struct GpuSettings {
+    int device = 0;
+    unsigned int streams = 4;                    // chunks in flight; copies on one overlap kernels on another
+    std::size_t chunkContracts = std::size_t(1) << 18;  // contracts per chunk
+};
+
+// Path payoffs the device simulates, on the option's own call/put type
+enum class GpuPathPayoff {
+    European,        // terminal spot
+    ArithmeticAsian  // average over the monitoring dates, as ArithmeticAsianCallPayoff
+};
+
+// True when a CUDA device is visible to the runtime
+bool gpuAvailable();
+
+// Batch pricing on a CUDA device.
+//
+// Batches are cut into chunks of chunkContracts and dealt round-robin to
+// the streams. Each stream owns pinned host staging and device buffers, so
+// a chunk's inputs go up, its kernel runs and its results come back with
+// cudaMemcpyAsync while the next chunk is being packed and other streams'
+// chunks are copying or computing. Greeks come back only for the outputs
+// requested, packed into one transfer. The device follows the same formulas
+// as BatchBlackScholes in double precision, with CUDA's normcdf, so results
+// agree with the CPU kernels to a few ulp.
+//
+// simulate() runs MonteCarloOption's Philox scheme on the device: the same
+// counters, antithetic mirroring and control variate, one thread block per
+// 256-path block. Per-block sums come back and are merged in block order
+// with the CPU estimator, so the stopping point and estimate match the CPU
+// engine up to the rounding of the device's exp and inverse normal CDF.
+// Sobol sampling stays on the CPU.
+//
+// A GpuPricer holds device memory and streams; use one per host thread.
+// CUDA failures throw std::runtime_error.
+class GpuPricer {
+public:
+    explicit GpuPricer(GpuSettings settings = GpuSettings());
+    ~GpuPricer();
+    GpuPricer(const GpuPricer&) = delete;
+    GpuPricer& operator=(const GpuPricer&) = delete;
+
+    // Price every contract in the batch, writing batch.size results to out
+    void price(const OptionBatchView& batch, double* out);
+
+    // Price and Greeks in FullGreeks units; null outputs are skipped
+    void greeks(const OptionBatchView& batch, const GreeksBatchOutput& out);
+
+    MonteCarloResult simulate(const MonteCarloOption& option,
+                              GpuPathPayoff payoff = GpuPathPayoff::European);
+
+    std::string deviceName() const;
+    const GpuSettings& settings() const { return settings_; }
+
+private:
+    struct Impl;
+
+    GpuSettings settings_;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_GPU_HPP
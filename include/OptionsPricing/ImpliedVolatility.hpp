@@ -2,9 +2,65 @@
 #define OPTIONS_PRICING_IMPLIED_VOLATILITY_HPP
 
 #include "BlackScholes.hpp"
+#include "Metrics.hpp"
+#include "Simd.hpp"
+#include <cstddef>
 
 namespace OptionsPricing {
 
+// Per-contract outcome of an implied volatility solve
+enum class ImpliedVolStatus {
+    Converged,       // price matched within tolerance
+    BelowIntrinsic,  // price at or below the no-arbitrage lower bound
+    AboveMaximum,    // price at or above spot (calls) or K * exp(-rT) (puts)
+    NotConverged,    // iteration limit reached
+    InvalidInput     // non-positive spot, strike or maturity, or non-finite price
+};
+
+struct ImpliedVolResult {
+    double volatility;  // 0 unless status is Converged
+    ImpliedVolStatus status;
+    unsigned int iterations;
+};
+
+// Non-owning structure-of-arrays view over a chain of quotes to invert
+struct ImpliedVolBatchView {
+    const double* price;
+    const double* spot;
+    const double* strike;
+    const double* riskFreeRate;
+    const double* timeToMaturity;
+    const OptionType* type;
+    std::size_t size;
+};
+
+namespace simd {
+
+namespace scalar {
+#include "detail/ImpliedVolatilityKernels.inl"
+} // namespace scalar
+
+#if defined(OPTIONS_PRICING_SIMD_X86)
+OPTIONS_PRICING_BEGIN_TARGET_AVX2
+namespace avx2 {
+#include "detail/ImpliedVolatilityKernels.inl"
+} // namespace avx2
+OPTIONS_PRICING_END_TARGET
+
+OPTIONS_PRICING_BEGIN_TARGET_AVX512
+namespace avx512 {
+#include "detail/ImpliedVolatilityKernels.inl"
+} // namespace avx512
+OPTIONS_PRICING_END_TARGET_AVX512
+#endif
+
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+namespace neon {
+#include "detail/ImpliedVolatilityKernels.inl"
+} // namespace neon
+#endif
+
+} // namespace simd
 
 class ImpliedVolatilityCalculator {
 public:
@@ -18,48 +74,89 @@ public:
         double tolerance = 1e-6,
         unsigned int maxIterations = 1000)
     {
-        // Init guess for imp vo
-        double volLow = 0.001;
-        double volHigh = 2.0;  // 200% volatility as upper bound
-        
-        BlackScholesOption optionLow(spot, strike, riskFreeRate, volLow, timeToMaturity, type);
-        BlackScholesOption optionHigh(spot, strike, riskFreeRate, volHigh, timeToMaturity, type);
+        ImpliedVolResult result = solve(targetPrice, spot, strike, riskFreeRate,
+                                        timeToMaturity, type, tolerance, maxIterations);
         
-        double priceLow = optionLow.price();
-        double priceHigh = optionHigh.price();
-        
-        // Check if target price is within bounds
-        if (targetPrice <= priceLow || targetPrice >= priceHigh) {
-            throw std::runtime_error("Target price is outside the bounds of possible option prices");
+        switch (result.status) {
+            case ImpliedVolStatus::Converged:
+                return result.volatility;
+            case ImpliedVolStatus::BelowIntrinsic:
+            case ImpliedVolStatus::AboveMaximum:
+                throw std::runtime_error("Target price is outside the bounds of possible option prices");
+            case ImpliedVolStatus::InvalidInput:
+                throw std::invalid_argument("Invalid inputs for implied volatility");
+            default:
+                throw std::runtime_error("Failed to converge to implied volatility within tolerance");
         }
-
-        // TODO: Implement Newton-Raphson method
-
-        // Binary search for imp vol
-        double vol = (volLow + volHigh) / 2.0;
-        
-        for (unsigned int i = 0; i < maxIterations; ++i) {
-            BlackScholesOption option(spot, strike, riskFreeRate, vol, timeToMaturity, type);
-            double price = option.price();
-            
-            if (std::abs(price - targetPrice) < tolerance) {
-                return vol;
-            }
-            
-            if (price < targetPrice) {
-                volLow = vol;
-            } else {
-                volHigh = vol;
+    }
+    
+    // Non-throwing solve: safeguarded Newton with analytic vega, reporting a status
+    static ImpliedVolResult solve(
+        double targetPrice,
+        double spot,
+        double strike,
+        double riskFreeRate,
+        double timeToMaturity,
+        OptionType type,
+        double tolerance = 1e-6,
+        unsigned int maxIterations = 100)
+    {
+        using namespace simd::scalar;
+        PricingProbe probe(MetricEngine::ImpliedVolatility);
+        ImpliedVolLanes r = impliedVolLanes(set1(targetPrice), set1(spot), set1(strike), set1(riskFreeRate),
+                                            set1(timeToMaturity), loadSign(&type), tolerance, maxIterations);
+        ImpliedVolResult result{r.volatility.v, static_cast<ImpliedVolStatus>(static_cast<int>(r.status.v)),
+                                static_cast<unsigned int>(r.iterations.v)};
+        recordMetric(MetricEngine::ImpliedVolatility, MetricCounter::Iterations, result.iterations);
+        if (result.status != ImpliedVolStatus::Converged) {
+            recordMetric(MetricEngine::ImpliedVolatility, MetricCounter::Failures);
+        }
+        return result;
+    }
+    
+    // Invert a whole chain at once, several quotes per vector register.
+    // status may be null if only the volatilities are wanted; failed
+    // elements get volatility 0 and a non-Converged status. Never throws.
+    static void calculateImpliedVolatilities(
+        const ImpliedVolBatchView& batch,
+        double* volatility,
+        ImpliedVolStatus* status,
+        double tolerance = 1e-6,
+        unsigned int maxIterations = 100,
+        SimdLevel level = activeSimdLevel())
+    {
+        PricingProbe probe(MetricEngine::ImpliedVolatility);
+        std::size_t n = batch.size;
+        recordMetric(MetricEngine::ImpliedVolatility, MetricCounter::Contracts, n);
+        switch (resolveSimdLevel(level)) {
+#if defined(OPTIONS_PRICING_SIMD_X86)
+            case SimdLevel::AVX512:
+                simd::avx512::impliedVolBatch(batch, volatility, status, tolerance, maxIterations, 0, n);
+                break;
+            case SimdLevel::AVX2:
+                simd::avx2::impliedVolBatch(batch, volatility, status, tolerance, maxIterations, 0, n);
+                break;
+#endif
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+            case SimdLevel::NEON:
+                simd::neon::impliedVolBatch(batch, volatility, status, tolerance, maxIterations, 0, n);
+                break;
+#endif
+            default:
+                simd::scalar::impliedVolBatch(batch, volatility, status, tolerance, maxIterations, 0, n);
+                break;
+        }
+        if (metricsEnabled && status) {
+            std::size_t failed = 0;
+            for (std::size_t i = 0; i < n; ++i) {
+                failed += status[i] != ImpliedVolStatus::Converged;
             }
-            
-            vol = (volLow + volHigh) / 2.0;
+            recordMetric(MetricEngine::ImpliedVolatility, MetricCounter::Failures, failed);
         }
-        
-        throw std::runtime_error("Failed to converge to implied volatility within tolerance");
     }
 };
 
 
 } // namespace OptionsPricing
 
-#endif // OPTIONS_PRICING_IMPLIED_VOLATILITY_HPP
\ No newline at end of file
+#endif // OPTIONS_PRICING_IMPLIED_VOLATILITY_HPP
@@ -0,0 +1,111 @@
+#ifndef OPTIONS_PRICING_LATTICE_CACHE_HPP
+#define OPTIONS_PRICING_LATTICE_CACHE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace OptionsPricing {
+
+// Which tree a cached set-up belongs to; each family builds its own moves
+enum class LatticeFamily { CoxRossRubinstein, Trinomial };
+
+// Everything about a recombining lattice that does not depend on spot or
+// strike: the step length, the discounted branch probabilities and the
+// powers of the up move that place every node relative to spot
+struct LatticeParameters {
+    double dt = 0.0;
+    double u = 0.0;
+    double up = 0.0;      // discounted branch probabilities
+    double middle = 0.0;  // trinomial only
+    double down = 0.0;
+    std::vector<double> powers;  // u^k for k in [-steps, steps], entry k + steps
+};
+
+struct LatticeKey {
+    LatticeFamily family;
+    double volatility;
+    double riskFreeRate;
+    double timeToMaturity;
+    unsigned int steps;
+
+    bool operator==(const LatticeKey& other) const {
+        return family == other.family && volatility == other.volatility &&
+               riskFreeRate == other.riskFreeRate && timeToMaturity == other.timeToMaturity &&
+               steps == other.steps;
+    }
+};
+
+// Per-thread least-recently-used cache of lattice set-ups. Spot bumps, strike
+// ladders and repeated pricing on one expiry share (vol, rate, T, steps), so
+// after the first tree they skip the 2 * steps exponentials of the power
+// table. Keys match exactly; any change in an input is a new entry.
+//
+// The reference lookup() returns stays valid until the next lookup() on the
+// same thread, which is all one backward induction needs.
+class LatticeParameterCache {
+public:
+    static constexpr std::size_t capacity = 8;
+
+    struct Stats {
+        std::uint64_t hits;
+        std::uint64_t misses;
+    };
+
+    // The cached set-up for key, calling build(parameters) to fill it on a miss
+    template <typename Build>
+    static const LatticeParameters& lookup(const LatticeKey& key, Build build) {
+        Cache& cache = threadCache();
+        ++cache.clock;
+        Entry* victim = &cache.entries[0];
+        for (Entry& entry : cache.entries) {
+            if (entry.lastUse != 0 && entry.key == key) {
+                entry.lastUse = cache.clock;
+                ++cache.stats.hits;
+                return entry.parameters;
+            }
+            if (entry.lastUse < victim->lastUse) {
+                victim = &entry;
+            }
+        }
+        ++cache.stats.misses;
+        victim->key = key;
+        victim->lastUse = cache.clock;
+        build(victim->parameters);
+        return victim->parameters;
+    }
+
+    // Drop every entry on this thread, releasing the power tables
+    static void clear() {
+        for (Entry& entry : threadCache().entries) {
+            entry.lastUse = 0;
+            entry.parameters = LatticeParameters();
+        }
+    }
+
+    // Hit and miss counts on this thread since it started
+    static Stats stats() { return threadCache().stats; }
+
+private:
+    struct Entry {
+        LatticeKey key{};
+        std::uint64_t lastUse = 0;  // 0 marks an empty slot
+        LatticeParameters parameters;
+    };
+
+    struct Cache {
+        std::array<Entry, capacity> entries;
+        std::uint64_t clock = 0;
+        Stats stats{0, 0};
+    };
+
+    static Cache& threadCache() {
+        thread_local Cache cache;
+        return cache;
+    }
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_LATTICE_CACHE_HPP
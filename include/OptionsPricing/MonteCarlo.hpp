@@ -0,0 +1,844 @@
+#ifndef OPTIONS_PRICING_MONTE_CARLO_HPP
+#define OPTIONS_PRICING_MONTE_CARLO_HPP
+
+#include "Common.hpp"
+#include "Adjoint.hpp"
+#include "BlackScholes.hpp"
+#include "Metrics.hpp"
+#include "Payoff.hpp"
+#include "Random.hpp"
+#include "Simd.hpp"
+#include "Sobol.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace OptionsPricing {
+
+namespace simd {
+
+namespace scalar {
+#include "detail/MonteCarloKernels.inl"
+} // namespace scalar
+
+#if defined(OPTIONS_PRICING_SIMD_X86)
+OPTIONS_PRICING_BEGIN_TARGET_AVX2
+namespace avx2 {
+#include "detail/MonteCarloKernels.inl"
+} // namespace avx2
+OPTIONS_PRICING_END_TARGET
+
+OPTIONS_PRICING_BEGIN_TARGET_AVX512
+namespace avx512 {
+#include "detail/MonteCarloKernels.inl"
+} // namespace avx512
+OPTIONS_PRICING_END_TARGET_AVX512
+#endif
+
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+namespace neon {
+#include "detail/MonteCarloKernels.inl"
+} // namespace neon
+#endif
+
+} // namespace simd
+
+// Path payoffs take the spots at every monitoring date t_1 .. t_n (spot at
+// t_0 excluded) and return the undiscounted payoff. For sensitivities() a
+// payoff also needs
+// `double adjoint(const double* spots, unsigned int count, double* slopes) const`,
+// which returns the payoff and writes its derivative in each spot.
+
+// Adapts a terminal payoff from Payoff.hpp to the path interface
+template <typename Payoff>
+struct TerminalPayoff {
+    Payoff payoff;
+    double operator()(const double* spots, unsigned int count) const { return payoff(spots[count - 1]); }
+    double adjoint(const double* spots, unsigned int count, double* slopes) const {
+        std::fill(slopes, slopes + count - 1, 0.0);
+        slopes[count - 1] = payoff.derivative(spots[count - 1]);
+        return payoff(spots[count - 1]);
+    }
+};
+
+// Arithmetic-average Asian options on the monitoring dates
+struct ArithmeticAsianCallPayoff {
+    double strike;
+    double operator()(const double* spots, unsigned int count) const {
+        double sum = 0.0;
+        for (unsigned int i = 0; i < count; ++i) {
+            sum += spots[i];
+        }
+        return std::max(0.0, sum / count - strike);
+    }
+    double adjoint(const double* spots, unsigned int count, double* slopes) const {
+        double value = (*this)(spots, count);
+        std::fill(slopes, slopes + count, value > 0.0 ? 1.0 / count : 0.0);
+        return value;
+    }
+};
+
+struct ArithmeticAsianPutPayoff {
+    double strike;
+    double operator()(const double* spots, unsigned int count) const {
+        double sum = 0.0;
+        for (unsigned int i = 0; i < count; ++i) {
+            sum += spots[i];
+        }
+        return std::max(0.0, strike - sum / count);
+    }
+    double adjoint(const double* spots, unsigned int count, double* slopes) const {
+        double value = (*this)(spots, count);
+        std::fill(slopes, slopes + count, value > 0.0 ? -1.0 / count : 0.0);
+        return value;
+    }
+};
+
+enum class MonteCarloSampling {
+    PseudoRandom,  // Philox streams
+    Sobol          // scrambled Sobol points on a Brownian bridge (randomized QMC)
+};
+
+struct MonteCarloSettings {
+    std::size_t maxPaths = 1 << 18;    // rounded up to whole blocks of 256 paths
+    unsigned int timeSteps = 1;        // evenly spaced monitoring dates per path
+    double targetStandardError = 0.0;  // stop once reached; 0 always runs maxPaths
+    bool antithetic = true;            // pseudo-random sampling only
+    bool controlVariate = false;       // Black-Scholes vanilla on the terminal spot
+    std::uint64_t seed = 0x5EED5EEDull;
+    MonteCarloSampling sampling = MonteCarloSampling::PseudoRandom;
+    unsigned int randomizations = 16;  // independent scramblings for the Sobol error estimate
+};
+
+struct MonteCarloResult {
+    double price;
+    double standardError;
+    std::size_t paths;
+};
+
+// Sensitivities with the standard error of each, in the same units
+struct MonteCarloSensitivities {
+    Sensitivities estimate;
+    Sensitivities standardError;
+    std::size_t paths;
+};
+
+// Monte Carlo engine for European and path-dependent payoffs under
+// geometric Brownian motion.
+//
+// Paths are simulated in blocks of 256: Philox4x32 uniforms keyed on the
+// seed and counted by (pair, time step, block), turned into normals and
+// exponentiated by the SIMD kernels for the running CPU. Block b always sees
+// the same numbers, so results do not depend on the executor or thread count.
+// Blocks are processed in rounds of 64 and the standard error is checked
+// after each round, which keeps early stopping reproducible too.
+//
+// The optional control variate is the discounted call/put payoff of this
+// option on the terminal spot, whose mean is the Black-Scholes price. On
+// the plain vanilla it reproduces Black-Scholes exactly; it earns its keep on
+// path-dependent payoffs such as Asians.
+//
+// With MonteCarloSampling::Sobol the normals come from Owen-scrambled Sobol
+// points instead, laid out on a Brownian bridge so the first dimensions
+// drive the terminal value and the coarse shape of the path. Time steps
+// beyond the 37 Sobol dimensions take Philox normals for the finest bridge
+// levels. Each of the `randomizations` scramblings is an unbiased estimate;
+// the price is their mean and the standard error comes from their spread.
+// Points per scrambling double each round (256, 512, ...) up to
+// maxPaths / randomizations, with the early-stop check after every round.
+//
+// sensitivities() differentiates every path in reverse (pathwise adjoints):
+// the payoff hands back its derivative in each simulated spot, and since
+// each spot is S0 * exp(X_t) with X_t linear in r and sigma and scaling
+// with sqrt(T), one pass per path turns those into delta, vega, rho and
+// theta. That costs twice the price on single-step paths and about a
+// quarter more on 52-step ones, where bumping needs eight runs. Pathwise
+// derivatives need a payoff continuous in spot, so digitals are out.
+class MonteCarloOption : public Option {
+public:
+    MonteCarloOption(double spot, double strike, double riskFreeRate,
+                     double volatility, double timeToMaturity,
+                     OptionType type, MonteCarloSettings settings = MonteCarloSettings())
+        : Option(spot, strike, riskFreeRate, volatility, timeToMaturity,
+                 type, ExerciseType::European), settings_(settings) {
+        if (settings_.maxPaths == 0) {
+            throw std::invalid_argument("Monte Carlo needs at least one path");
+        }
+        if (settings_.timeSteps == 0) {
+            throw std::invalid_argument("Monte Carlo needs at least one time step");
+        }
+        if (settings_.sampling == MonteCarloSampling::Sobol && settings_.randomizations < 2) {
+            throw std::invalid_argument("Quasi-Monte Carlo needs at least two randomizations");
+        }
+    }
+    
+    double price() const override {
+        return simulate().price;
+    }
+    
+    // Price with its standard error, for the option's own call/put payoff
+    MonteCarloResult simulate() const {
+        SerialExecutor serial;
+        return simulate(serial);
+    }
+    
+    MonteCarloResult simulate(Executor& executor) const {
+        if (type_ == OptionType::Call) {
+            return run(TerminalPayoff<CallPayoff>{{strike_}}, executor);
+        }
+        return run(TerminalPayoff<PutPayoff>{{strike_}}, executor);
+    }
+    
+    // Any path payoff: double operator()(const double* spots, unsigned int count) const
+    template <typename PathPayoff>
+    MonteCarloResult simulatePayoff(const PathPayoff& payoff) const {
+        SerialExecutor serial;
+        return run(payoff, serial);
+    }
+    
+    template <typename PathPayoff>
+    MonteCarloResult simulatePayoff(const PathPayoff& payoff, Executor& executor) const {
+        return run(payoff, executor);
+    }
+    
+    // Price with pathwise delta, vega, rho and theta from one run over the
+    // same paths, blocks and stopping rule as simulate(). Early stopping
+    // watches the price's standard error. With the control variate each
+    // sensitivity is regressed on the vanilla's own pathwise derivative,
+    // whose mean is the Black-Scholes Greek.
+    MonteCarloSensitivities sensitivities() const {
+        SerialExecutor serial;
+        return sensitivities(serial);
+    }
+    
+    MonteCarloSensitivities sensitivities(Executor& executor) const {
+        if (type_ == OptionType::Call) {
+            return runSensitivities(TerminalPayoff<CallPayoff>{{strike_}}, executor);
+        }
+        return runSensitivities(TerminalPayoff<PutPayoff>{{strike_}}, executor);
+    }
+    
+    // Any path payoff with an adjoint() member
+    template <typename PathPayoff>
+    MonteCarloSensitivities sensitivitiesPayoff(const PathPayoff& payoff) const {
+        SerialExecutor serial;
+        return runSensitivities(payoff, serial);
+    }
+    
+    template <typename PathPayoff>
+    MonteCarloSensitivities sensitivitiesPayoff(const PathPayoff& payoff, Executor& executor) const {
+        return runSensitivities(payoff, executor);
+    }
+    
+    // Bump-and-reprice with common random numbers; early stopping is turned
+    // off so both bumps use exactly the same paths
+    double delta() const override {
+        double h = spot_ * 0.01;
+        return (bumped(spot_ + h).price() - bumped(spot_ - h).price()) / (2.0 * h);
+    }
+    
+    double gamma() const override {
+        double h = spot_ * 0.01;
+        return (bumped(spot_ + h).price() - 2.0 * bumped(spot_).price() + bumped(spot_ - h).price()) / (h * h);
+    }
+    
+    // A path step costs a fraction of a closed-form evaluation
+    double pricingCost() const override {
+        return 1.0 + static_cast<double>(settings_.maxPaths) * settings_.timeSteps / 5.0;
+    }
+    
+    std::unique_ptr<Option> withMarket(double spot, double volatility, double timeToMaturity) const override {
+        return std::make_unique<MonteCarloOption>(spot, strike_, riskFreeRate_, volatility, timeToMaturity,
+                                                  type_, settings_);
+    }
+    
+    const MonteCarloSettings& settings() const { return settings_; }
+    
+private:
+    friend class GpuPricer;  // runs simulateBlock()'s scheme on the device, then estimate()
+    
+    static constexpr std::size_t blockPaths = 256;
+    static constexpr std::size_t blocksPerRound = 64;
+    
+    MonteCarloSettings settings_;
+    
+    // Running sums over samples of payoff y and control x
+    struct Accumulator {
+        double count = 0.0;
+        double sumY = 0.0;
+        double sumX = 0.0;
+        double sumYY = 0.0;
+        double sumXX = 0.0;
+        double sumXY = 0.0;
+        
+        void add(double y, double x) {
+            count += 1.0;
+            sumY += y;
+            sumX += x;
+            sumYY += y * y;
+            sumXX += x * x;
+            sumXY += x * y;
+        }
+        
+        void merge(const Accumulator& other) {
+            count += other.count;
+            sumY += other.sumY;
+            sumX += other.sumX;
+            sumYY += other.sumYY;
+            sumXX += other.sumXX;
+            sumXY += other.sumXY;
+        }
+    };
+    
+    // The price's sums followed by those of its raw derivatives in spot,
+    // volatility, rate and maturity, each paired with the control's
+    struct AdjointAccumulator {
+        static constexpr std::size_t outputs = 1 + detail::adjointInputs;
+        Accumulator sums[outputs];
+        
+        void merge(const AdjointAccumulator& other) {
+            for (std::size_t k = 0; k < outputs; ++k) {
+                sums[k].merge(other.sums[k]);
+            }
+        }
+    };
+    
+    struct BlockWorkspace {
+        std::vector<double> normals;
+        std::vector<double> logReturns;
+        std::vector<double> spots;     // [time step][path]
+        std::vector<double> logSpots;  // sensitivities(): log(S_t / S0), [time step][path]
+        std::vector<double> path;
+        std::vector<double> slopes;    // sensitivities(): payoff derivative in each spot of the path
+    };
+    
+    MonteCarloOption bumped(double spot) const {
+        MonteCarloSettings settings = settings_;
+        settings.targetStandardError = 0.0;
+        return MonteCarloOption(spot, strike_, riskFreeRate_, volatility_, timeToMaturity_, type_, settings);
+    }
+    
+    static void normalsFromUniforms(SimdLevel level, double* x, std::size_t n) {
+        switch (level) {
+#if defined(OPTIONS_PRICING_SIMD_X86)
+            case SimdLevel::AVX512:
+                simd::avx512::normalsFromUniforms(x, n);
+                return;
+            case SimdLevel::AVX2:
+                simd::avx2::normalsFromUniforms(x, n);
+                return;
+#endif
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+            case SimdLevel::NEON:
+                simd::neon::normalsFromUniforms(x, n);
+                return;
+#endif
+            default:
+                simd::scalar::normalsFromUniforms(x, n);
+                return;
+        }
+    }
+    
+    static void gbmStep(SimdLevel level, double* logReturn, double* spot, const double* z, double spot0,
+                        double drift, double diffusion, std::size_t n) {
+        switch (level) {
+#if defined(OPTIONS_PRICING_SIMD_X86)
+            case SimdLevel::AVX512:
+                simd::avx512::gbmStep(logReturn, spot, z, spot0, drift, diffusion, n);
+                return;
+            case SimdLevel::AVX2:
+                simd::avx2::gbmStep(logReturn, spot, z, spot0, drift, diffusion, n);
+                return;
+#endif
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+            case SimdLevel::NEON:
+                simd::neon::gbmStep(logReturn, spot, z, spot0, drift, diffusion, n);
+                return;
+#endif
+            default:
+                simd::scalar::gbmStep(logReturn, spot, z, spot0, drift, diffusion, n);
+                return;
+        }
+    }
+    
+    static void bridgeStep(SimdLevel level, double* out, const double* left, const double* right,
+                           const double* z, double leftWeight, double rightWeight, double stdDev,
+                           std::size_t n) {
+        switch (level) {
+#if defined(OPTIONS_PRICING_SIMD_X86)
+            case SimdLevel::AVX512:
+                simd::avx512::bridgeStep(out, left, right, z, leftWeight, rightWeight, stdDev, n);
+                return;
+            case SimdLevel::AVX2:
+                simd::avx2::bridgeStep(out, left, right, z, leftWeight, rightWeight, stdDev, n);
+                return;
+#endif
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+            case SimdLevel::NEON:
+                simd::neon::bridgeStep(out, left, right, z, leftWeight, rightWeight, stdDev, n);
+                return;
+#endif
+            default:
+                simd::scalar::bridgeStep(out, left, right, z, leftWeight, rightWeight, stdDev, n);
+                return;
+        }
+    }
+    
+    static void gbmFromBrownian(SimdLevel level, double* spot, const double* w, double spot0,
+                                double drift, double sigma, std::size_t n) {
+        switch (level) {
+#if defined(OPTIONS_PRICING_SIMD_X86)
+            case SimdLevel::AVX512:
+                simd::avx512::gbmFromBrownian(spot, w, spot0, drift, sigma, n);
+                return;
+            case SimdLevel::AVX2:
+                simd::avx2::gbmFromBrownian(spot, w, spot0, drift, sigma, n);
+                return;
+#endif
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+            case SimdLevel::NEON:
+                simd::neon::gbmFromBrownian(spot, w, spot0, drift, sigma, n);
+                return;
+#endif
+            default:
+                simd::scalar::gbmFromBrownian(spot, w, spot0, drift, sigma, n);
+                return;
+        }
+    }
+    
+    template <typename Stats, typename PathPayoff>
+    Stats simulateBlock(const PathPayoff& payoff, std::size_t block, SimdLevel level) const {
+        constexpr bool adjoint = std::is_same<Stats, AdjointAccumulator>::value;
+        thread_local BlockWorkspace workspace;
+        const unsigned int steps = settings_.timeSteps;
+        workspace.normals.resize(blockPaths);
+        workspace.logReturns.assign(blockPaths, 0.0);
+        workspace.spots.resize(static_cast<std::size_t>(steps) * blockPaths);
+        workspace.path.resize(steps);
+        if (adjoint) {
+            workspace.logSpots.resize(static_cast<std::size_t>(steps) * blockPaths);
+            workspace.slopes.resize(steps);
+        }
+        
+        double dt = timeToMaturity_ / steps;
+        double drift = (riskFreeRate_ - 0.5 * volatility_ * volatility_) * dt;
+        double diffusion = volatility_ * std::sqrt(dt);
+        const std::size_t drawn = settings_.antithetic ? blockPaths / 2 : blockPaths;
+        
+        Philox4x32 rng(settings_.seed);
+        double* z = workspace.normals.data();
+        for (unsigned int s = 0; s < steps; ++s) {
+            for (std::size_t i = 0; i < drawn; i += 2) {
+                rng.uniforms({static_cast<std::uint32_t>(i / 2), s, static_cast<std::uint32_t>(block),
+                              static_cast<std::uint32_t>(static_cast<std::uint64_t>(block) >> 32)},
+                             z[i], z[i + 1]);
+            }
+            normalsFromUniforms(level, z, drawn);
+            for (std::size_t i = drawn; i < blockPaths; ++i) {
+                z[i] = -z[i - drawn];
+            }
+            gbmStep(level, workspace.logReturns.data(), workspace.spots.data() + s * blockPaths, z,
+                    spot_, drift, diffusion, blockPaths);
+            if (adjoint) {
+                std::copy(workspace.logReturns.begin(), workspace.logReturns.end(),
+                          workspace.logSpots.begin() + s * blockPaths);
+            }
+        }
+        
+        return accumulate<Stats>(payoff, workspace, settings_.antithetic);
+    }
+    
+    template <typename Stats, typename PathPayoff>
+    Stats accumulate(const PathPayoff& payoff, BlockWorkspace& workspace, bool mirrored) const {
+        if constexpr (std::is_same<Stats, AdjointAccumulator>::value) {
+            return accumulateAdjoint(payoff, workspace, mirrored);
+        } else {
+            return accumulatePrice(payoff, workspace, mirrored);
+        }
+    }
+    
+    // Discounted payoff and control per path of a simulated block; with
+    // mirrored paths each antithetic pair forms one sample
+    template <typename PathPayoff>
+    Accumulator accumulatePrice(const PathPayoff& payoff, BlockWorkspace& workspace, bool mirrored) const {
+        const unsigned int steps = settings_.timeSteps;
+        const std::size_t drawn = mirrored ? blockPaths / 2 : blockPaths;
+        double discount = std::exp(-riskFreeRate_ * timeToMaturity_);
+        const double* terminal = workspace.spots.data() + static_cast<std::size_t>(steps - 1) * blockPaths;
+        double sign = (type_ == OptionType::Call) ? 1.0 : -1.0;
+        auto evaluate = [&](std::size_t i, double& y, double& x) {
+            for (unsigned int s = 0; s < steps; ++s) {
+                workspace.path[s] = workspace.spots[s * blockPaths + i];
+            }
+            y = discount * payoff(workspace.path.data(), steps);
+            x = discount * std::max(0.0, sign * (terminal[i] - strike_));
+        };
+        
+        Accumulator stats;
+        for (std::size_t i = 0; i < drawn; ++i) {
+            double y, x;
+            evaluate(i, y, x);
+            if (mirrored) {
+                double yMirror, xMirror;
+                evaluate(i + drawn, yMirror, xMirror);
+                y = 0.5 * (y + yMirror);
+                x = 0.5 * (x + xMirror);
+            }
+            stats.add(y, x);
+        }
+        return stats;
+    }
+    
+    // As accumulatePrice(), adding each path's raw derivatives. With
+    // slope_t the derivative of the discounted payoff in S_t, S_t = S0 e^X_t
+    // and t the monitoring time, the path contributes
+    //   d/dS0    = sum slope_t S_t / S0
+    //   d/dsigma = sum slope_t S_t (X_t - (r + sigma^2 / 2) t) / sigma
+    //   d/dr     = sum slope_t S_t t - T y
+    //   d/dT     = sum slope_t S_t ((r - sigma^2 / 2) t + X_t) / (2T) - r y
+    // and likewise the control through its terminal spot alone.
+    template <typename PathPayoff>
+    AdjointAccumulator accumulateAdjoint(const PathPayoff& payoff, BlockWorkspace& workspace,
+                                         bool mirrored) const {
+        const unsigned int steps = settings_.timeSteps;
+        const std::size_t drawn = mirrored ? blockPaths / 2 : blockPaths;
+        const double r = riskFreeRate_;
+        const double sigma = volatility_;
+        const double T = timeToMaturity_;
+        const double dt = T / steps;
+        double discount = std::exp(-r * T);
+        double sign = (type_ == OptionType::Call) ? 1.0 : -1.0;
+        auto derivatives = [&](double y, double spotSum, double timeSum, double logSum, double* out) {
+            out[detail::AdjointSpot] = spotSum / spot_;
+            out[detail::AdjointVolatility] = (logSum - (r + 0.5 * sigma * sigma) * timeSum) / sigma;
+            out[detail::AdjointRate] = timeSum - T * y;
+            out[detail::AdjointMaturity] = ((r - 0.5 * sigma * sigma) * timeSum + logSum) / (2.0 * T) - r * y;
+        };
+        // Discounted payoff and control in [0], their derivatives after
+        auto evaluate = [&](std::size_t i, double* y, double* x) {
+            for (unsigned int s = 0; s < steps; ++s) {
+                workspace.path[s] = workspace.spots[s * blockPaths + i];
+            }
+            y[0] = discount * payoff.adjoint(workspace.path.data(), steps, workspace.slopes.data());
+            double spotSum = 0.0, timeSum = 0.0, logSum = 0.0;
+            for (unsigned int s = 0; s < steps; ++s) {
+                double weighted = discount * workspace.slopes[s] * workspace.path[s];
+                spotSum += weighted;
+                timeSum += weighted * (s + 1) * dt;
+                logSum += weighted * workspace.logSpots[s * blockPaths + i];
+            }
+            derivatives(y[0], spotSum, timeSum, logSum, y + 1);
+            
+            double terminal = workspace.path[steps - 1];
+            x[0] = discount * std::max(0.0, sign * (terminal - strike_));
+            double weighted = x[0] > 0.0 ? discount * sign * terminal : 0.0;
+            derivatives(x[0], weighted, weighted * T,
+                        weighted * workspace.logSpots[static_cast<std::size_t>(steps - 1) * blockPaths + i], x + 1);
+        };
+        
+        constexpr std::size_t outputs = AdjointAccumulator::outputs;
+        AdjointAccumulator stats;
+        for (std::size_t i = 0; i < drawn; ++i) {
+            double y[outputs], x[outputs];
+            evaluate(i, y, x);
+            if (mirrored) {
+                double yMirror[outputs], xMirror[outputs];
+                evaluate(i + drawn, yMirror, xMirror);
+                for (std::size_t k = 0; k < outputs; ++k) {
+                    y[k] = 0.5 * (y[k] + yMirror[k]);
+                    x[k] = 0.5 * (x[k] + xMirror[k]);
+                }
+            }
+            for (std::size_t k = 0; k < outputs; ++k) {
+                stats.sums[k].add(y[k], x[k]);
+            }
+        }
+        return stats;
+    }
+    
+    // Block of 256 consecutive points of one scrambled Sobol sequence. Sobol
+    // dimension d feeds bridge step d; later steps use Philox normals.
+    template <typename Stats, typename PathPayoff>
+    Stats simulateQuasiBlock(const PathPayoff& payoff, const SobolSequence& sobol,
+                             const BrownianBridge& bridge, const std::uint32_t* scrambles,
+                             unsigned int replicate, std::size_t block, SimdLevel level) const {
+        constexpr bool adjoint = std::is_same<Stats, AdjointAccumulator>::value;
+        thread_local BlockWorkspace workspace;
+        const unsigned int steps = settings_.timeSteps;
+        const std::size_t rows = static_cast<std::size_t>(steps) * blockPaths;
+        workspace.normals.resize(rows);
+        workspace.logReturns.resize(rows);  // Brownian motion, [time step][path]
+        workspace.spots.resize(rows);
+        workspace.path.resize(steps);
+        if (adjoint) {
+            workspace.logSpots.resize(rows);
+            workspace.slopes.resize(steps);
+        }
+        
+        std::uint32_t first = static_cast<std::uint32_t>(block * blockPaths);
+        for (unsigned int d = 0; d < steps; ++d) {
+            double* z = workspace.normals.data() + d * blockPaths;
+            if (d < sobol.dimensions()) {
+                std::uint32_t x = sobol.point(first, d);
+                for (std::size_t i = 0; i < blockPaths; ++i) {
+                    z[i] = (owenScramble(x, scrambles[d]) + 0.5) * 0x1p-32;
+                    x = sobol.next(x, first + static_cast<std::uint32_t>(i), d);
+                }
+            } else {
+                Philox4x32 rng(settings_.seed);
+                for (std::size_t i = 0; i < blockPaths; i += 2) {
+                    rng.uniforms({static_cast<std::uint32_t>(i / 2), d, static_cast<std::uint32_t>(block),
+                                  replicate | 0x80000000u},
+                                 z[i], z[i + 1]);
+                }
+            }
+        }
+        normalsFromUniforms(level, workspace.normals.data(), rows);
+        
+        double* w = workspace.logReturns.data();
+        for (unsigned int i = 0; i < bridge.size(); ++i) {
+            const BrownianBridge::Step& step = bridge.steps()[i];
+            bridgeStep(level, w + step.bridge * blockPaths,
+                       step.left != BrownianBridge::none ? w + step.left * blockPaths : nullptr,
+                       step.right != BrownianBridge::none ? w + step.right * blockPaths : nullptr,
+                       workspace.normals.data() + i * blockPaths, step.leftWeight, step.rightWeight,
+                       step.stdDev, blockPaths);
+        }
+        double dt = timeToMaturity_ / steps;
+        double drift = (riskFreeRate_ - 0.5 * volatility_ * volatility_) * dt;
+        for (unsigned int s = 0; s < steps; ++s) {
+            gbmFromBrownian(level, workspace.spots.data() + s * blockPaths, w + s * blockPaths, spot_,
+                            drift * (s + 1), volatility_, blockPaths);
+        }
+        if (adjoint) {
+            for (std::size_t k = 0; k < rows; ++k) {
+                workspace.logSpots[k] = drift * (k / blockPaths + 1) + volatility_ * w[k];
+            }
+        }
+        return accumulate<Stats>(payoff, workspace, false);
+    }
+    
+    // Estimate and standard error from the running sums
+    static MonteCarloResult estimate(const Accumulator& a, bool controlVariate, double controlMean,
+                                     std::size_t paths) {
+        double n = a.count;
+        double meanY = a.sumY / n;
+        double variance = (a.sumYY - n * meanY * meanY) / std::max(n - 1.0, 1.0);
+        double price = meanY;
+        if (controlVariate) {
+            double meanX = a.sumX / n;
+            double varianceX = (a.sumXX - n * meanX * meanX) / std::max(n - 1.0, 1.0);
+            double covariance = (a.sumXY - n * meanX * meanY) / std::max(n - 1.0, 1.0);
+            if (varianceX > 0.0) {
+                double beta = covariance / varianceX;
+                price = meanY - beta * (meanX - controlMean);
+                variance -= beta * covariance;
+            }
+        }
+        return {price, std::sqrt(std::max(variance, 0.0) / n), paths};
+    }
+    
+    double controlMean() const {
+        return settings_.controlVariate
+            ? BlackScholesOption(spot_, strike_, riskFreeRate_, volatility_, timeToMaturity_, type_).price()
+            : 0.0;
+    }
+    
+    // The control's mean for each AdjointAccumulator output: the
+    // Black-Scholes price and its raw derivatives
+    void controlMeans(double* means) const {
+        if (!settings_.controlVariate) {
+            std::fill(means, means + AdjointAccumulator::outputs, 0.0);
+            return;
+        }
+        Sensitivities exact =
+            BlackScholesOption(spot_, strike_, riskFreeRate_, volatility_, timeToMaturity_, type_).sensitivities();
+        means[0] = exact.price;
+        detail::derivativesFrom(exact, means + 1);
+    }
+    
+    // One estimate per AdjointAccumulator output, in reporting units
+    static MonteCarloSensitivities sensitivitiesFrom(const MonteCarloResult* results) {
+        constexpr std::size_t outputs = AdjointAccumulator::outputs;
+        double values[outputs], errors[outputs];
+        for (std::size_t k = 0; k < outputs; ++k) {
+            values[k] = results[k].price;
+            errors[k] = results[k].standardError;
+        }
+        MonteCarloSensitivities out;
+        out.estimate = detail::sensitivitiesFrom(values[0], values + 1);
+        out.standardError = detail::sensitivitiesFrom(errors[0], errors + 1);
+        out.standardError.theta = -out.standardError.theta;  // an error, not a derivative
+        out.paths = results[0].paths;
+        return out;
+    }
+    
+    static double priceError(const MonteCarloResult& result) { return result.standardError; }
+    static double priceError(const MonteCarloSensitivities& result) { return result.standardError.price; }
+    
+    template <typename PathPayoff>
+    MonteCarloResult run(const PathPayoff& payoff, Executor& executor) const {
+        PricingProbe probe(MetricEngine::MonteCarlo);
+        bool controlVariate = settings_.controlVariate;
+        double controlMean = this->controlMean();
+        if (settings_.sampling == MonteCarloSampling::Sobol) {
+            return runQuasi<Accumulator>(payoff, executor,
+                                         [&](const std::vector<Accumulator>& totals, std::size_t paths) {
+                                             return estimateQuasi(totals, controlMean, paths);
+                                         });
+        }
+        return runPseudo<Accumulator>(payoff, executor, [&](const Accumulator& total, std::size_t paths) {
+            return estimate(total, controlVariate, controlMean, paths);
+        });
+    }
+    
+    template <typename PathPayoff>
+    MonteCarloSensitivities runSensitivities(const PathPayoff& payoff, Executor& executor) const {
+        PricingProbe probe(MetricEngine::MonteCarlo);
+        constexpr std::size_t outputs = AdjointAccumulator::outputs;
+        bool controlVariate = settings_.controlVariate;
+        double means[outputs];
+        controlMeans(means);
+        if (settings_.sampling == MonteCarloSampling::Sobol) {
+            std::vector<Accumulator> output;
+            return runQuasi<AdjointAccumulator>(
+                payoff, executor, [&](const std::vector<AdjointAccumulator>& totals, std::size_t paths) {
+                    MonteCarloResult results[outputs];
+                    output.resize(totals.size());
+                    for (std::size_t k = 0; k < outputs; ++k) {
+                        for (std::size_t r = 0; r < totals.size(); ++r) {
+                            output[r] = totals[r].sums[k];
+                        }
+                        results[k] = estimateQuasi(output, means[k], paths);
+                    }
+                    return sensitivitiesFrom(results);
+                });
+        }
+        return runPseudo<AdjointAccumulator>(
+            payoff, executor, [&](const AdjointAccumulator& total, std::size_t paths) {
+                MonteCarloResult results[outputs];
+                for (std::size_t k = 0; k < outputs; ++k) {
+                    results[k] = estimate(total.sums[k], controlVariate, means[k], paths);
+                }
+                return sensitivitiesFrom(results);
+            });
+    }
+    
+    // Philox blocks in rounds, with finish(totals, paths) giving the result
+    // checked for early stopping after each
+    template <typename Stats, typename PathPayoff, typename Finish>
+    auto runPseudo(const PathPayoff& payoff, Executor& executor, Finish finish) const {
+        SimdLevel level = activeSimdLevel();
+        std::size_t maxBlocks = (settings_.maxPaths + blockPaths - 1) / blockPaths;
+        std::vector<Stats> roundStats(std::min(blocksPerRound, maxBlocks));
+        Stats total;
+        std::size_t block = 0;
+        decltype(finish(total, block)) result{};
+        while (block < maxBlocks) {
+            std::size_t count = std::min(blocksPerRound, maxBlocks - block);
+            executor.parallelFor(count, [&](std::size_t k) {
+                roundStats[k] = simulateBlock<Stats>(payoff, block + k, level);
+            });
+            // Merge in block order so the sums do not depend on scheduling
+            for (std::size_t k = 0; k < count; ++k) {
+                total.merge(roundStats[k]);
+            }
+            block += count;
+            
+            result = finish(total, block * blockPaths);
+            if (settings_.targetStandardError > 0.0 && priceError(result) <= settings_.targetStandardError) {
+                break;
+            }
+        }
+        recordMetric(MetricEngine::MonteCarlo, MetricCounter::Paths, block * blockPaths);
+        return result;
+    }
+    
+    // Sobol blocks for every randomization in rounds, with
+    // finish(per-randomization totals, paths) as in runPseudo()
+    template <typename Stats, typename PathPayoff, typename Finish>
+    auto runQuasi(const PathPayoff& payoff, Executor& executor, Finish finish) const {
+        SimdLevel level = activeSimdLevel();
+        const unsigned int replicates = settings_.randomizations;
+        SobolSequence sobol(std::min(settings_.timeSteps, SobolSequence::maxDimensions));
+        BrownianBridge bridge(settings_.timeSteps, timeToMaturity_);
+        
+        // One scrambling seed per (randomization, dimension)
+        Philox4x32 rng(settings_.seed);
+        std::vector<std::uint32_t> scrambles(static_cast<std::size_t>(replicates) * sobol.dimensions());
+        for (unsigned int r = 0; r < replicates; ++r) {
+            for (unsigned int d = 0; d < sobol.dimensions(); ++d) {
+                scrambles[r * sobol.dimensions() + d] = rng({d, r, 0x50B0u, 0u})[0];
+            }
+        }
+        
+        std::size_t pointsPerReplicate = (settings_.maxPaths + replicates - 1) / replicates;
+        std::size_t maxBlocks = std::min<std::size_t>((pointsPerReplicate + blockPaths - 1) / blockPaths,
+                                                      (std::size_t(1) << 32) / blockPaths);
+        std::vector<Stats> totals(replicates);
+        std::vector<Stats> roundStats;
+        std::size_t blocks = 0;
+        decltype(finish(totals, blocks)) result{};
+        while (blocks < maxBlocks) {
+            std::size_t count = std::min(std::max<std::size_t>(blocks, 1), maxBlocks - blocks);
+            roundStats.assign(replicates * count, Stats());
+            executor.parallelFor(replicates * count, [&](std::size_t k) {
+                unsigned int r = static_cast<unsigned int>(k / count);
+                roundStats[k] = simulateQuasiBlock<Stats>(payoff, sobol, bridge,
+                                                          &scrambles[r * sobol.dimensions()], r,
+                                                          blocks + k % count, level);
+            });
+            for (std::size_t k = 0; k < roundStats.size(); ++k) {
+                totals[k / count].merge(roundStats[k]);
+            }
+            blocks += count;
+            
+            result = finish(totals, blocks * blockPaths * replicates);
+            if (settings_.targetStandardError > 0.0 && priceError(result) <= settings_.targetStandardError) {
+                break;
+            }
+        }
+        recordMetric(MetricEngine::MonteCarlo, MetricCounter::Paths, blocks * blockPaths * replicates);
+        return result;
+    }
+    
+    // Mean and spread of the per-randomization estimates. The control
+    // variate coefficient is pooled over all points and shared by every
+    // randomization, so each one stays a consistent estimate.
+    MonteCarloResult estimateQuasi(const std::vector<Accumulator>& totals, double controlMean,
+                                   std::size_t paths) const {
+        Accumulator pooled;
+        for (const Accumulator& total : totals) {
+            pooled.merge(total);
+        }
+        double beta = 0.0;
+        if (settings_.controlVariate) {
+            double n = pooled.count;
+            double meanX = pooled.sumX / n;
+            double varianceX = pooled.sumXX - n * meanX * meanX;
+            if (varianceX > 0.0) {
+                beta = (pooled.sumXY - meanX * pooled.sumY) / varianceX;
+            }
+        }
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        for (const Accumulator& total : totals) {
+            double estimate = total.sumY / total.count - beta * (total.sumX / total.count - controlMean);
+            sum += estimate;
+            sumSquares += estimate * estimate;
+        }
+        double r = static_cast<double>(totals.size());
+        double price = sum / r;
+        double variance = (sumSquares - r * price * price) / (r - 1.0);
+        return {price, std::sqrt(std::max(variance, 0.0) / r), paths};
+    }
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_MONTE_CARLO_HPP
@@ -2,16 +2,194 @@
 #define OPTIONS_PRICING_OPTION_FACTORY_HPP
 
 #include "BlackScholes.hpp"
+#include "AmericanApproximation.hpp"
 #include "BinomialTree.hpp"
 #include "TrinomialTree.hpp"
+#include "FiniteDifference.hpp"
+#include "MonteCarlo.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace OptionsPricing {
 
+// Pricing methods OptionFactory can build
+enum class PricingMethod {
+    BlackScholes,
+    BaroneAdesiWhaley,
+    BjerksundStensland,
+    BinomialTree,
+    TrinomialTree,
+    FiniteDifference,
+    MonteCarlo,
+    QuasiMonteCarlo
+};
+
+inline std::string pricingMethodToString(PricingMethod method) {
+    switch (method) {
+        case PricingMethod::BlackScholes: return "BlackScholes";
+        case PricingMethod::BaroneAdesiWhaley: return "BaroneAdesiWhaley";
+        case PricingMethod::BjerksundStensland: return "BjerksundStensland";
+        case PricingMethod::BinomialTree: return "BinomialTree";
+        case PricingMethod::TrinomialTree: return "TrinomialTree";
+        case PricingMethod::FiniteDifference: return "FiniteDifference";
+        case PricingMethod::MonteCarlo: return "MonteCarlo";
+        case PricingMethod::QuasiMonteCarlo: return "QuasiMonteCarlo";
+    }
+    return "Unknown";
+}
+
+inline PricingMethod pricingMethodFromString(const std::string& name) {
+    static const PricingMethod methods[] = {
+        PricingMethod::BlackScholes, PricingMethod::BaroneAdesiWhaley, PricingMethod::BjerksundStensland,
+        PricingMethod::BinomialTree, PricingMethod::TrinomialTree, PricingMethod::FiniteDifference,
+        PricingMethod::MonteCarlo, PricingMethod::QuasiMonteCarlo};
+    for (PricingMethod method : methods) {
+        if (name == pricingMethodToString(method)) {
+            return method;
+        }
+    }
+    throw std::invalid_argument("Unknown pricing method: " + name);
+}
+
+// Deleter for options that may live in a std::pmr::memory_resource: those
+// are destroyed in place and handed back to it, the others deleted
+struct OptionDeleter {
+    std::pmr::memory_resource* resource = nullptr;  // null for new/delete
+    std::size_t size = 0;
+    std::size_t alignment = 0;
+    
+    void operator()(Option* option) const {
+        if (!resource) {
+            delete option;
+            return;
+        }
+        void* storage = dynamic_cast<void*>(option);
+        option->~Option();
+        resource->deallocate(storage, size, alignment);
+    }
+};
+
+using PooledOption = std::unique_ptr<Option, OptionDeleter>;
+
+// Bump allocator for whole books of options. Memory is taken in large
+// blocks and never handed back piecemeal; reset() makes all of it free
+// again in O(1) and keeps the blocks, so a book rebuilt every cycle reuses
+// the same warm pages instead of going back to malloc.
+class OptionArena : public std::pmr::memory_resource {
+public:
+    explicit OptionArena(std::size_t blockSize = std::size_t(1) << 20) : blockSize_(blockSize) {}
+    
+    OptionArena(const OptionArena&) = delete;
+    OptionArena& operator=(const OptionArena&) = delete;
+    
+    // Everything allocated so far becomes free; the objects must be gone
+    void reset() {
+        block_ = 0;
+        used_ = 0;
+    }
+    
+    std::size_t capacity() const {
+        std::size_t total = 0;
+        for (const Block& block : blocks_) {
+            total += block.size;
+        }
+        return total;
+    }
+    
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        std::size_t size;
+    };
+    
+    std::vector<Block> blocks_;
+    std::size_t block_ = 0;  // block being carved
+    std::size_t used_ = 0;   // bytes used in it
+    std::size_t blockSize_;
+    
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+        for (;;) {
+            if (block_ < blocks_.size()) {
+                Block& block = blocks_[block_];
+                std::uintptr_t base = reinterpret_cast<std::uintptr_t>(block.data.get());
+                std::size_t offset = static_cast<std::size_t>((base + used_ + alignment - 1) / alignment * alignment - base);
+                if (offset + bytes <= block.size) {
+                    used_ = offset + bytes;
+                    return block.data.get() + offset;
+                }
+                ++block_;
+                used_ = 0;
+                continue;
+            }
+            std::size_t size = std::max(blockSize_, bytes + alignment);
+            blocks_.push_back({std::unique_ptr<unsigned char[]>(new unsigned char[size]), size});
+        }
+    }
+    
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
 // Option Factory class to create different types of options
 class OptionFactory {
 public:
+    static std::unique_ptr<Option> createOption(
+        double spot,
+        double strike,
+        double riskFreeRate,
+        double volatility,
+        double timeToMaturity,
+        OptionType type,
+        ExerciseType exerciseType,
+        PricingMethod method,
+        unsigned int steps = 100)
+    {
+        return build(method, exerciseType, steps, [&](auto tag, auto&&... args) -> std::unique_ptr<Option> {
+            using Engine = typename decltype(tag)::type;
+            return std::make_unique<Engine>(spot, strike, riskFreeRate, volatility, timeToMaturity, type,
+                                            std::forward<decltype(args)>(args)...);
+        });
+    }
+    
+    // The same option placed in resource, e.g. a monotonic arena shared by a
+    // whole book; the resource must outlive the returned pointer
+    static PooledOption createOption(
+        std::pmr::memory_resource& resource,
+        double spot,
+        double strike,
+        double riskFreeRate,
+        double volatility,
+        double timeToMaturity,
+        OptionType type,
+        ExerciseType exerciseType,
+        PricingMethod method,
+        unsigned int steps = 100)
+    {
+        return build(method, exerciseType, steps, [&](auto tag, auto&&... args) -> PooledOption {
+            using Engine = typename decltype(tag)::type;
+            void* storage = resource.allocate(sizeof(Engine), alignof(Engine));
+            try {
+                Engine* option = new (storage) Engine(spot, strike, riskFreeRate, volatility, timeToMaturity,
+                                                      type, std::forward<decltype(args)>(args)...);
+                return PooledOption(option, OptionDeleter{&resource, sizeof(Engine), alignof(Engine)});
+            } catch (...) {
+                resource.deallocate(storage, sizeof(Engine), alignof(Engine));
+                throw;
+            }
+        });
+    }
+    
+    // By name: "BlackScholes", "BinomialTree", ... as pricingMethodToString()
     static std::unique_ptr<Option> createOption(
         double spot,
         double strike,
@@ -23,30 +201,67 @@ public:
         const std::string& pricingMethod,
         unsigned int steps = 100)
     {
-        if (pricingMethod == "BlackScholes") {
-            if (exerciseType == ExerciseType::American) {
-                throw std::invalid_argument("Black-Scholes can only price European options");
+        return createOption(spot, strike, riskFreeRate, volatility, timeToMaturity, type, exerciseType,
+                            pricingMethodFromString(pricingMethod), steps);
+    }
+    
+private:
+    template <typename Engine>
+    struct Tag {
+        using type = Engine;
+    };
+    
+    // Checks the method against the exercise style and calls
+    // make(Tag<Engine>{}, extra constructor arguments after the market and type)
+    template <typename Make>
+    static std::invoke_result_t<Make, Tag<BlackScholesOption>> build(PricingMethod method, ExerciseType exerciseType,
+                                                                     unsigned int steps, Make make) {
+        switch (method) {
+            case PricingMethod::BlackScholes:
+                if (exerciseType == ExerciseType::American) {
+                    throw std::invalid_argument("Black-Scholes can only price European options");
+                }
+                return make(Tag<BlackScholesOption>{});
+            case PricingMethod::BaroneAdesiWhaley:
+            case PricingMethod::BjerksundStensland:
+                // Closed-form American approximations; steps does not apply
+                if (exerciseType == ExerciseType::European) {
+                    throw std::invalid_argument(pricingMethodToString(method) + " only prices American options");
+                }
+                return make(Tag<AmericanApproximationOption>{},
+                            method == PricingMethod::BaroneAdesiWhaley ? AmericanApproximation::BaroneAdesiWhaley
+                                                                       : AmericanApproximation::BjerksundStensland);
+            case PricingMethod::BinomialTree:
+                return make(Tag<BinomialTreeOption>{}, exerciseType, steps);
+            case PricingMethod::TrinomialTree:
+                return make(Tag<TrinomialTreeOption>{}, exerciseType, steps);
+            case PricingMethod::FiniteDifference: {
+                // steps time steps on a grid of 8 * steps log-spot intervals
+                FiniteDifferenceSettings settings;
+                settings.timeSteps = steps;
+                settings.spaceSteps = 8 * steps;
+                return make(Tag<FiniteDifferenceOption>{}, exerciseType, settings);
+            }
+            case PricingMethod::MonteCarlo:
+                // Default MonteCarloSettings; steps does not apply
+                if (exerciseType == ExerciseType::American) {
+                    throw std::invalid_argument("Monte Carlo can only price European options");
+                }
+                return make(Tag<MonteCarloOption>{});
+            case PricingMethod::QuasiMonteCarlo: {
+                // Scrambled Sobol sampling, otherwise default settings
+                if (exerciseType == ExerciseType::American) {
+                    throw std::invalid_argument("Quasi-Monte Carlo can only price European options");
+                }
+                MonteCarloSettings settings;
+                settings.sampling = MonteCarloSampling::Sobol;
+                return make(Tag<MonteCarloOption>{}, settings);
             }
-            return std::make_unique<BlackScholesOption>(
-                spot, strike, riskFreeRate, volatility, timeToMaturity, type);
-        }
-        else if (pricingMethod == "BinomialTree") {
-            return std::make_unique<BinomialTreeOption>(
-                spot, strike, riskFreeRate, volatility, timeToMaturity, 
-                type, exerciseType, steps);
-        }
-        else if (pricingMethod == "TrinomialTree") {
-            return std::make_unique<TrinomialTreeOption>(
-                spot, strike, riskFreeRate, volatility, timeToMaturity, 
-                type, exerciseType, steps);
-        }
-        else {
-            throw std::invalid_argument("Unknown pricing method: " + pricingMethod);
         }
+        throw std::invalid_argument("Unknown pricing method: " + pricingMethodToString(method));
     }
 };
 
-
 } // namespace OptionsPricing
 
 #endif // OPTIONS_PRICING_OPTION_FACTORY_HPP
\ No newline at end of file
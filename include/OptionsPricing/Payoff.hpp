@@ -0,0 +1,96 @@
+#ifndef OPTIONS_PRICING_PAYOFF_HPP
+#define OPTIONS_PRICING_PAYOFF_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace OptionsPricing {
+
+// Payoff policies for the tree engines. Any type with
+// `double operator()(double spot) const` works; the engines take it as a
+// template parameter, so the call is inlined rather than made per node.
+// For American exercise the same function gives the early-exercise value.
+// The adjoint sweeps (sensitivities()) also need
+// `double derivative(double spot) const`, the slope in spot; digitals have
+// none, their sensitivities sit entirely on the strike. A node exactly at
+// the strike, as at the centre of an at-the-money trinomial tree, takes the
+// mean of the two one-sided slopes, the limit of a central bump.
+
+struct CallPayoff {
+    double strike;
+    double operator()(double spot) const { return std::max(0.0, spot - strike); }
+    double derivative(double spot) const { return spot > strike ? 1.0 : spot == strike ? 0.5 : 0.0; }
+};
+
+struct PutPayoff {
+    double strike;
+    double operator()(double spot) const { return std::max(0.0, strike - spot); }
+    double derivative(double spot) const { return spot < strike ? -1.0 : spot == strike ? -0.5 : 0.0; }
+};
+
+// Cash-or-nothing digitals
+struct DigitalCallPayoff {
+    double strike;
+    double cash = 1.0;
+    double operator()(double spot) const { return spot > strike ? cash : 0.0; }
+};
+
+struct DigitalPutPayoff {
+    double strike;
+    double cash = 1.0;
+    double operator()(double spot) const { return spot < strike ? cash : 0.0; }
+};
+
+// Power options on spot^exponent
+struct PowerCallPayoff {
+    double strike;
+    double exponent;
+    double operator()(double spot) const { return std::max(0.0, std::pow(spot, exponent) - strike); }
+    double derivative(double spot) const {
+        double power = std::pow(spot, exponent);
+        return power > strike ? exponent * power / spot : 0.0;
+    }
+};
+
+struct PowerPutPayoff {
+    double strike;
+    double exponent;
+    double operator()(double spot) const { return std::max(0.0, strike - std::pow(spot, exponent)); }
+    double derivative(double spot) const {
+        double power = std::pow(spot, exponent);
+        return power < strike ? -exponent * power / spot : 0.0;
+    }
+};
+
+namespace detail {
+
+// How a tree's American induction treats early exercise. Without dividends
+// the European value of a node is at least sign * (S - K e^(-r dt)), so a
+// call at r >= 0 or a put at r <= 0 is never worth exercising early and
+// takes the European loop. A put at r > 0 goes the other way: a node whose
+// children are all exercised holds K e^(-r dt) - S, below K - S, so it is
+// exercised too and the induction skips that region. Other payoffs, calls
+// at negative rates and lattices with a negative branch probability (too
+// few steps for the volatility and rate) compare every node.
+enum class TreeExercise { European, PrunedPut, EveryNode };
+
+template <typename Payoff>
+TreeExercise treeExercise(double riskFreeRate, double lowestProbability) {
+    if (!(lowestProbability >= 0.0)) {
+        return TreeExercise::EveryNode;
+    }
+    if constexpr (std::is_same_v<Payoff, CallPayoff>) {
+        return riskFreeRate >= 0.0 ? TreeExercise::European : TreeExercise::EveryNode;
+    } else if constexpr (std::is_same_v<Payoff, PutPayoff>) {
+        return riskFreeRate > 0.0 ? TreeExercise::PrunedPut : TreeExercise::European;
+    } else {
+        return TreeExercise::EveryNode;
+    }
+}
+
+} // namespace detail
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_PAYOFF_HPP
@@ -2,18 +2,101 @@
 #define OPTIONS_PRICING_PORTFOLIO_HPP
 
 #include "BlackScholes.hpp"
+#include "BatchBlackScholes.hpp"
 #include "BinomialTree.hpp"
 #include "TrinomialTree.hpp"
+#include "ThreadPool.hpp"
+#include "OptionFactory.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <memory>
+#include <memory_resource>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <vector>
 #include <utility>
 
 namespace OptionsPricing {
 
+// A market move applied to every position of an OptionPortfolio
+struct RiskScenario {
+    double spotShift = 0.0;        // relative: spot becomes spot * (1 + spotShift)
+    double volatilityShift = 0.0;  // absolute, 0.01 is one vol point
+    double timeShift = 0.0;        // years elapsed
+};
+
+// Largest moves OptionPortfolio::scenarioValue() answers from the Taylor
+// expansion; any bigger shift is repriced in full
+struct TaylorSettings {
+    double maxSpotShift = 0.05;
+    double maxVolatilityShift = 0.05;
+    double maxTimeShift = 7.0 / 365.0;
+};
+
+struct ScenarioResult {
+    double value;
+    double pnl;     // value minus the value at the Greeks snapshot
+    bool repriced;  // true if every position was repriced rather than expanded
+};
+
+// Taylor error observed each time a scenario was repriced in full, from
+// scenarioValue() falling back or from fullScenarioValue(). error is
+// Taylor value minus full value.
+struct TaylorErrorStats {
+    std::size_t taylorAnswers = 0;
+    std::size_t fullRevaluations = 0;
+    double sumAbsError = 0.0;
+    double maxAbsError = 0.0;
+    RiskScenario worstScenario;  // scenario with the largest absolute error
+    
+    double meanAbsError() const {
+        return fullRevaluations > 0 ? sumAbsError / static_cast<double>(fullRevaluations) : 0.0;
+    }
+};
+
 class OptionPortfolio{
 public:
     void addOption(std::unique_ptr<Option> option, double quantity = 1.0) {
+        addOption(PooledOption(option.release()), quantity);
+    }
+    
+    // An option from OptionFactory's memory_resource overload; the resource
+    // must outlive the portfolio or the next clear()
+    void addOption(PooledOption option, double quantity = 1.0) {
         options_.push_back(std::make_pair(std::move(option), quantity));
+        snapshotValid_ = false;
+    }
+    
+    // Build an option in the portfolio's own OptionArena: positions are
+    // packed into a few large blocks rather than one heap allocation each,
+    // and clear() frees all of them at once
+    Option& emplaceOption(double spot, double strike, double riskFreeRate, double volatility,
+                          double timeToMaturity, OptionType type, ExerciseType exerciseType,
+                          PricingMethod method, unsigned int steps = 100, double quantity = 1.0) {
+        if (!arena_) {
+            arena_ = std::make_unique<OptionArena>();
+        }
+        addOption(OptionFactory::createOption(*arena_, spot, strike, riskFreeRate, volatility, timeToMaturity,
+                                              type, exerciseType, method, steps),
+                  quantity);
+        return *options_.back().first;
+    }
+    
+    void reserve(std::size_t positions) { options_.reserve(positions); }
+    
+    // Drop every position, e.g. at the end of a revaluation cycle. The
+    // destructors still run, but the arena is freed in one step and keeps
+    // its blocks for the next book.
+    void clear() {
+        options_.clear();
+        taylor_.clear();
+        snapshotValid_ = false;
+        if (arena_) {
+            arena_->reset();
+        }
     }
     
     double totalValue() const {
@@ -28,13 +111,7 @@ public:
     double delta() const {
         double total = 0.0;
         for (const auto& [option, quantity] : options_) {
-            if (auto* bs = dynamic_cast<const BlackScholesOption*>(option.get())) {
-                total += bs->delta() * quantity;
-            } else if (auto* bt = dynamic_cast<const BinomialTreeOption*>(option.get())) {
-                total += bt->delta() * quantity;
-            } else if (auto* tt = dynamic_cast<const TrinomialTreeOption*>(option.get())) {
-                total += tt->delta() * quantity;
-            }
+            total += option->delta() * quantity;
         }
         return total;
     }
@@ -43,19 +120,712 @@ public:
     double gamma() const {
         double total = 0.0;
         for (const auto& [option, quantity] : options_) {
-            if (auto* bs = dynamic_cast<const BlackScholesOption*>(option.get())) {
-                total += bs->gamma() * quantity;
-            } else if (auto* bt = dynamic_cast<const BinomialTreeOption*>(option.get())) {
-                total += bt->gamma() * quantity;
-            } else if (auto* tt = dynamic_cast<const TrinomialTreeOption*>(option.get())) {
-                total += tt->gamma() * quantity;
+            total += option->gamma() * quantity;
+        }
+        return total;
+    }
+    
+    // Parallel versions. Positions are valued independently on the executor
+    // and summed afterwards in insertion order, so the result is bit-for-bit
+    // identical to the serial call whatever the thread count.
+    double totalValue(Executor& executor) const {
+        return parallelSum(executor, [](const Option& option) { return option.price(); });
+    }
+    
+    double delta(Executor& executor) const {
+        return parallelSum(executor, [](const Option& option) { return option.delta(); });
+    }
+    
+    double gamma(Executor& executor) const {
+        return parallelSum(executor, [](const Option& option) { return option.gamma(); });
+    }
+    
+    std::size_t size() const { return options_.size(); }
+    
+    // Scenario risk by second-order Taylor expansion. snapshotGreeks() caches
+    // every position's value, delta, gamma, vega, volga, vanna, theta and
+    // charm. Vega, volga and vanna come from central volatility bumps of
+    // +/- h, h = min(0.01, vol / 2), and theta and charm from a one-day roll,
+    // each through Option::withMarket(); delta and gamma are the engine's own
+    // from risk(). scenarioValue() then costs a few multiply-adds per
+    // position. A move beyond TaylorSettings in any direction is repriced in
+    // full instead, and the Taylor error at that scenario is recorded in
+    // taylorErrorStats(). The first scenario query after an addOption() takes
+    // a fresh snapshot.
+    void setTaylorSettings(const TaylorSettings& settings) { taylorSettings_ = settings; }
+    const TaylorSettings& taylorSettings() const { return taylorSettings_; }
+    
+    void snapshotGreeks() {
+        SerialExecutor serial;
+        snapshotGreeks(serial);
+    }
+    
+    void snapshotGreeks(Executor& executor) {
+        taylor_.resize(options_.size());
+        parallelEach(executor, [&](std::size_t i) {
+            taylor_[i] = taylorGreeks(*options_[i].first, options_[i].second);
+        });
+        snapshotValue_ = 0.0;
+        for (const TaylorGreeks& g : taylor_) {
+            snapshotValue_ += g.value;
+        }
+        snapshotValid_ = true;
+    }
+    
+    ScenarioResult scenarioValue(const RiskScenario& scenario) {
+        SerialExecutor serial;
+        return scenarioValue(scenario, serial);
+    }
+    
+    ScenarioResult scenarioValue(const RiskScenario& scenario, Executor& executor) {
+        ensureSnapshot(executor);
+        if (std::fabs(scenario.spotShift) > taylorSettings_.maxSpotShift ||
+            std::fabs(scenario.volatilityShift) > taylorSettings_.maxVolatilityShift ||
+            std::fabs(scenario.timeShift) > taylorSettings_.maxTimeShift) {
+            return fullScenarioValue(scenario, executor);
+        }
+        ++taylorStats_.taylorAnswers;
+        double value = taylorValue(scenario);
+        return {value, value - snapshotValue_, false};
+    }
+    
+    // Reprice every position at the scenario whatever its size, recording
+    // the Taylor error there; lets thresholds be tuned on sample scenarios
+    ScenarioResult fullScenarioValue(const RiskScenario& scenario) {
+        SerialExecutor serial;
+        return fullScenarioValue(scenario, serial);
+    }
+    
+    ScenarioResult fullScenarioValue(const RiskScenario& scenario, Executor& executor) {
+        ensureSnapshot(executor);
+        double value = parallelSum(executor, [&](const Option& option) { return shiftedPrice(option, scenario); });
+        double error = std::fabs(taylorValue(scenario) - value);
+        ++taylorStats_.fullRevaluations;
+        taylorStats_.sumAbsError += error;
+        if (error >= taylorStats_.maxAbsError) {
+            taylorStats_.maxAbsError = error;
+            taylorStats_.worstScenario = scenario;
+        }
+        return {value, value - snapshotValue_, true};
+    }
+    
+    const TaylorErrorStats& taylorErrorStats() const { return taylorStats_; }
+    void resetTaylorErrorStats() { taylorStats_ = TaylorErrorStats(); }
+    
+private:
+    // Quantity-weighted sensitivities of one position; vega, volga and vanna
+    // are per unit of volatility, theta and charm per year elapsed
+    struct TaylorGreeks {
+        double spot;
+        double value;
+        double delta;
+        double gamma;
+        double vega;
+        double volga;
+        double vanna;
+        double theta;
+        double charm;
+    };
+    
+    std::unique_ptr<OptionArena> arena_;  // declared first so it outlives options_
+    std::vector<std::pair<PooledOption, double>> options_;
+    std::vector<TaylorGreeks> taylor_;
+    double snapshotValue_ = 0.0;
+    bool snapshotValid_ = false;
+    TaylorSettings taylorSettings_;
+    TaylorErrorStats taylorStats_;
+    
+    static TaylorGreeks taylorGreeks(const Option& option, double quantity) {
+        double spot = option.spot();
+        double vol = option.volatility();
+        double time = option.timeToMaturity();
+        PositionRisk base = option.risk();
+        
+        double h = std::min(0.01, 0.5 * vol);
+        PositionRisk up = option.withMarket(spot, vol + h, time)->risk();
+        PositionRisk down = option.withMarket(spot, vol - h, time)->risk();
+        double dt = std::min(1.0 / 365.0, 0.5 * time);
+        PositionRisk rolled = option.withMarket(spot, vol, time - dt)->risk();
+        
+        return {spot,
+                quantity * base.value,
+                quantity * base.delta,
+                quantity * base.gamma,
+                quantity * (up.value - down.value) / (2.0 * h),
+                quantity * (up.value - 2.0 * base.value + down.value) / (h * h),
+                quantity * (up.delta - down.delta) / (2.0 * h),
+                quantity * (rolled.value - base.value) / dt,
+                quantity * (rolled.delta - base.delta) / dt};
+    }
+    
+    // Positions that expire within the scenario are worth their payoff
+    static double shiftedPrice(const Option& option, const RiskScenario& scenario) {
+        double spot = option.spot() * (1.0 + scenario.spotShift);
+        double time = option.timeToMaturity() - scenario.timeShift;
+        if (time <= 0.0) {
+            double intrinsic = option.type() == OptionType::Call ? spot - option.strike() : option.strike() - spot;
+            return std::max(intrinsic, 0.0);
+        }
+        return option.withMarket(spot, option.volatility() + scenario.volatilityShift, time)->price();
+    }
+    
+    double taylorValue(const RiskScenario& scenario) const {
+        double dv = scenario.volatilityShift;
+        double value = 0.0;
+        for (const TaylorGreeks& g : taylor_) {
+            double ds = g.spot * scenario.spotShift;
+            value += g.value + g.delta * ds + 0.5 * g.gamma * ds * ds + g.vega * dv + 0.5 * g.volga * dv * dv +
+                     g.vanna * ds * dv + (g.theta + g.charm * ds) * scenario.timeShift;
+        }
+        return value;
+    }
+    
+    void ensureSnapshot(Executor& executor) {
+        if (!snapshotValid_) {
+            snapshotGreeks(executor);
+        }
+    }
+    
+    // Chunks per thread; more gives stealing room at the cost of scheduling overhead
+    static constexpr double chunksPerThread = 8.0;
+    
+    // Group positions into tasks of roughly equal cost. Positions are taken
+    // most expensive first, so large trees each get a task of their own and
+    // start early, while cheap closed-form legs are packed together until a
+    // task is worth scheduling. Returns task boundaries into `order`.
+    std::vector<std::size_t> scheduleTasks(std::size_t threads, std::vector<std::size_t>& order) const {
+        std::vector<double> cost(options_.size());
+        double totalCost = 0.0;
+        for (std::size_t i = 0; i < options_.size(); ++i) {
+            cost[i] = options_[i].first->pricingCost();
+            totalCost += cost[i];
+        }
+        order.resize(options_.size());
+        std::iota(order.begin(), order.end(), std::size_t(0));
+        std::stable_sort(order.begin(), order.end(),
+                         [&](std::size_t a, std::size_t b) { return cost[a] > cost[b]; });
+        
+        double target = totalCost / (chunksPerThread * static_cast<double>(threads));
+        std::vector<std::size_t> bounds{0};
+        double chunkCost = 0.0;
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            chunkCost += cost[order[k]];
+            if (chunkCost >= target) {
+                bounds.push_back(k + 1);
+                chunkCost = 0.0;
+            }
+        }
+        if (bounds.back() != order.size()) {
+            bounds.push_back(order.size());
+        }
+        return bounds;
+    }
+    
+    // Run work(i) for every position, in cost-balanced tasks
+    template <typename Work>
+    void parallelEach(Executor& executor, Work work) const {
+        std::vector<std::size_t> order;
+        std::vector<std::size_t> bounds = scheduleTasks(executor.concurrency(), order);
+        executor.parallelFor(bounds.size() - 1, [&](std::size_t task) {
+            for (std::size_t k = bounds[task]; k < bounds[task + 1]; ++k) {
+                work(order[k]);
             }
+        });
+    }
+    
+    template <typename Measure>
+    double parallelSum(Executor& executor, Measure measure) const {
+        std::vector<double> contributions(options_.size());
+        parallelEach(executor, [&](std::size_t i) {
+            const auto& [option, quantity] = options_[i];
+            contributions[i] = measure(*option) * quantity;
+        });
+        
+        // Fixed-order reduction, matching the serial loops exactly
+        double total = 0.0;
+        for (double contribution : contributions) {
+            total += contribution;
         }
         return total;
     }
+};
+
+namespace detail {
+
+// One contiguous bucket of positions priced by a single model
+class PositionBucket {
+public:
+    virtual ~PositionBucket() = default;
+    virtual std::size_t size() const = 0;
+    
+    // Relative cost of position i, as Option::pricingCost()
+    virtual double cost(std::size_t i) const = 0;
+    
+    // Quantity-weighted risk of positions [begin, end), written to out[0, end - begin)
+    virtual void evaluate(std::size_t begin, std::size_t end, PositionRisk* out) const = 0;
+};
+
+// Positions of one concrete engine, stored by value. Calls are qualified
+// with the engine type, so they bind statically rather than through the vtable.
+template <typename Engine>
+class TypedPositionBucket final : public PositionBucket {
+public:
+    void add(const Engine& option, double quantity) {
+        options_.push_back(option);
+        quantities_.push_back(quantity);
+    }
+    
+    std::size_t size() const override { return options_.size(); }
+    
+    double cost(std::size_t i) const override { return options_[i].Engine::pricingCost(); }
+    
+    void evaluate(std::size_t begin, std::size_t end, PositionRisk* out) const override {
+        for (std::size_t i = begin; i < end; ++i) {
+            PositionRisk r = options_[i].Engine::risk();
+            double q = quantities_[i];
+            out[i - begin] = {r.value * q, r.delta * q, r.gamma * q};
+        }
+    }
+    
+private:
+    std::vector<Engine> options_;
+    std::vector<double> quantities_;
+};
+
+// Black-Scholes positions are kept as structure-of-arrays columns and run
+// through the batch Greeks kernel
+template <>
+class TypedPositionBucket<BlackScholesOption> final : public PositionBucket {
+public:
+    void add(const BlackScholesOption& option, double quantity) {
+        batch_.add(option.spot(), option.strike(), option.riskFreeRate(),
+                   option.volatility(), option.timeToMaturity(), option.type());
+        quantities_.push_back(quantity);
+    }
+    
+    std::size_t size() const override { return batch_.size(); }
+    
+    // SIMD lanes make a closed-form leg cheaper here than through price()
+    double cost(std::size_t) const override { return 0.25; }
+    
+    void evaluate(std::size_t begin, std::size_t end, PositionRisk* out) const override {
+        const std::size_t block = 256;
+        double price[block], delta[block], gamma[block];
+        OptionBatchView all = batch_.view();
+        for (std::size_t i = begin; i < end; i += block) {
+            std::size_t n = std::min(block, end - i);
+            OptionBatchView view = {all.spot + i, all.strike + i, all.riskFreeRate + i, all.volatility + i,
+                                    all.timeToMaturity + i, all.type + i, n};
+            GreeksBatchOutput greeks = {price, delta, gamma, nullptr, nullptr,
+                                        nullptr, nullptr, nullptr, nullptr};
+            BatchBlackScholes::greeks(view, greeks);
+            for (std::size_t j = 0; j < n; ++j) {
+                double q = quantities_[i + j];
+                out[i + j - begin] = {price[j] * q, delta[j] * q, gamma[j] * q};
+            }
+        }
+    }
     
 private:
-    std::vector<std::pair<std::unique_ptr<Option>, double>> options_;
+    OptionBatch batch_;
+    std::vector<double> quantities_;
+};
+
+} // namespace detail
+
+// Portfolio grouped by pricing model. Each engine type gets one contiguous
+// bucket holding its positions by value, so valuation needs no RTTI and no
+// per-position virtual calls; Black-Scholes legs go through the SIMD batch
+// kernel. Any Option subclass can be added without changes here, as long as
+// it implements risk() (or the delta()/gamma() it defaults to).
+//
+// Tree engines report lattice delta and gamma from risk(), which differ
+// slightly from OptionPortfolio's bump-and-reprice values.
+class GroupedPortfolio {
+public:
+    template <typename Engine>
+    void addOption(const Engine& option, double quantity = 1.0) {
+        static_assert(std::is_base_of<Option, Engine>::value, "Engine must derive from Option");
+        bucket<Engine>().add(option, quantity);
+        ++size_;
+    }
+    
+    std::size_t size() const { return size_; }
+    
+    // Value, delta and gamma of the whole book
+    PositionRisk risk() const {
+        SerialExecutor serial;
+        return risk(serial);
+    }
+    
+    // Same on an executor. Results are summed in a fixed order (buckets in
+    // the order their engine was first added, then insertion order), so they
+    // are bit-for-bit identical to risk() whatever the thread count.
+    PositionRisk risk(Executor& executor) const {
+        std::vector<Task> tasks = scheduleTasks(executor.concurrency());
+        std::vector<PositionRisk> results(size_);
+        executor.parallelFor(tasks.size(), [&](std::size_t t) {
+            const Task& task = tasks[t];
+            buckets_[task.bucket].items->evaluate(task.begin, task.end, results.data() + task.offset);
+        });
+        
+        PositionRisk total = {0.0, 0.0, 0.0};
+        for (const PositionRisk& r : results) {
+            total.value += r.value;
+            total.delta += r.delta;
+            total.gamma += r.gamma;
+        }
+        return total;
+    }
+    
+    double totalValue() const { return risk().value; }
+    double delta() const { return risk().delta; }
+    double gamma() const { return risk().gamma; }
+    
+private:
+    struct Bucket {
+        const void* key;
+        std::unique_ptr<detail::PositionBucket> items;
+    };
+    
+    struct Task {
+        std::size_t bucket;
+        std::size_t begin;
+        std::size_t end;
+        std::size_t offset;  // first slot in the results array
+        double cost;
+    };
+    
+    std::vector<Bucket> buckets_;
+    std::size_t size_ = 0;
+    
+    static constexpr double chunksPerThread = 8.0;
+    
+    // One address per engine type identifies its bucket without RTTI
+    template <typename Engine>
+    static const void* bucketKey() {
+        static const char key = 0;
+        return &key;
+    }
+    
+    template <typename Engine>
+    detail::TypedPositionBucket<Engine>& bucket() {
+        const void* key = bucketKey<Engine>();
+        for (Bucket& b : buckets_) {
+            if (b.key == key) {
+                return static_cast<detail::TypedPositionBucket<Engine>&>(*b.items);
+            }
+        }
+        buckets_.push_back({key, std::make_unique<detail::TypedPositionBucket<Engine>>()});
+        return static_cast<detail::TypedPositionBucket<Engine>&>(*buckets_.back().items);
+    }
+    
+    // Cut every bucket into contiguous ranges of roughly equal cost, then
+    // hand out the most expensive ranges first
+    std::vector<Task> scheduleTasks(std::size_t threads) const {
+        double totalCost = 0.0;
+        for (const Bucket& b : buckets_) {
+            for (std::size_t i = 0; i < b.items->size(); ++i) {
+                totalCost += b.items->cost(i);
+            }
+        }
+        double target = totalCost / (chunksPerThread * static_cast<double>(threads));
+        
+        std::vector<Task> tasks;
+        std::size_t offset = 0;
+        for (std::size_t k = 0; k < buckets_.size(); ++k) {
+            const detail::PositionBucket& items = *buckets_[k].items;
+            std::size_t begin = 0;
+            double cost = 0.0;
+            for (std::size_t i = 0; i < items.size(); ++i) {
+                cost += items.cost(i);
+                if (cost >= target || i + 1 == items.size()) {
+                    tasks.push_back({k, begin, i + 1, offset + begin, cost});
+                    begin = i + 1;
+                    cost = 0.0;
+                }
+            }
+            offset += items.size();
+        }
+        std::stable_sort(tasks.begin(), tasks.end(),
+                         [](const Task& a, const Task& b) { return a.cost > b.cost; });
+        return tasks;
+    }
+};
+
+// Book kept live against market updates. Positions are indexed by
+// underlying and, within it, by expiry slice; each slice holds its own
+// volatility, while spot and rate belong to the underlying. Every position's
+// value, delta and gamma are cached, and a market update only marks the
+// slices it touches, so risk() reprices just those positions.
+//
+// Sums are rebuilt per dirty slice and then per dirty underlying, always in
+// the same order (positions in insertion order within a slice, slices by
+// expiry, underlyings by id). The result is bit-for-bit what a full
+// revaluation of the same book and market would give, however many updates
+// led to it, and never drifts. Positions are priced through OptionFactory
+// from their terms and the current market, so any pricing method it knows
+// can be used.
+class IncrementalPortfolio {
+public:
+    // Register an underlying; the volatility seeds every expiry slice it gets
+    std::size_t addUnderlying(double spot, double riskFreeRate, double volatility) {
+        checkMarket(spot, riskFreeRate, volatility);
+        underlyings_.push_back({spot, riskFreeRate, volatility, {}, {0.0, 0.0, 0.0}, false});
+        return underlyings_.size() - 1;
+    }
+    
+    // Add a position and return its index. The terms are checked up front by
+    // building the option once, so a bad method or input throws here rather
+    // than in risk().
+    std::size_t addPosition(std::size_t underlying, double strike, double timeToMaturity, OptionType type,
+                            ExerciseType exerciseType, const std::string& pricingMethod,
+                            unsigned int steps = 100, double quantity = 1.0) {
+        return addPosition(underlying, strike, timeToMaturity, type, exerciseType,
+                           pricingMethodFromString(pricingMethod), steps, quantity);
+    }
+    
+    std::size_t addPosition(std::size_t underlying, double strike, double timeToMaturity, OptionType type,
+                            ExerciseType exerciseType, PricingMethod pricingMethod,
+                            unsigned int steps = 100, double quantity = 1.0) {
+        const Underlying& u = underlyingAt(underlying);
+        if (!std::isfinite(timeToMaturity)) {
+            throw std::invalid_argument("Time to maturity must be finite");  // NaN would break the expiry order
+        }
+        std::size_t existing = findSlice(u, timeToMaturity);
+        double volatility = existing < slices_.size() ? slices_[existing].volatility : u.volatility;
+        OptionFactory::createOption(u.spot, strike, u.riskFreeRate, volatility,
+                                    timeToMaturity, type, exerciseType, pricingMethod, steps);
+        std::size_t slice = sliceFor(underlying, timeToMaturity);
+        positions_.push_back({slice, strike, type, exerciseType, pricingMethod, steps, quantity});
+        risks_.push_back({0.0, 0.0, 0.0});
+        slices_[slice].positions.push_back(positions_.size() - 1);
+        markDirty(slice);
+        return positions_.size() - 1;
+    }
+    
+    // Market updates; each only marks the affected slices for revaluation.
+    // Bad values throw here, leaving the book as it was.
+    void updateSpot(std::size_t underlying, double spot) {
+        Underlying& u = underlyingAt(underlying);
+        checkMarket(spot, u.riskFreeRate, u.volatility);
+        u.spot = spot;
+        markUnderlyingDirty(underlying);
+    }
+    
+    void updateRiskFreeRate(std::size_t underlying, double riskFreeRate) {
+        Underlying& u = underlyingAt(underlying);
+        checkMarket(u.spot, riskFreeRate, u.volatility);
+        u.riskFreeRate = riskFreeRate;
+        markUnderlyingDirty(underlying);
+    }
+    
+    // Same volatility for every expiry of the underlying
+    void updateVolatility(std::size_t underlying, double volatility) {
+        Underlying& u = underlyingAt(underlying);
+        checkMarket(u.spot, u.riskFreeRate, volatility);
+        u.volatility = volatility;
+        for (std::size_t slice : u.slices) {
+            slices_[slice].volatility = volatility;
+        }
+        markUnderlyingDirty(underlying);
+    }
+    
+    // Volatility of one expiry slice, which must already hold positions
+    void updateVolatility(std::size_t underlying, double timeToMaturity, double volatility) {
+        const Underlying& u = underlyingAt(underlying);
+        std::size_t slice = findSlice(u, timeToMaturity);
+        if (slice == slices_.size()) {
+            throw std::invalid_argument("No positions at this expiry");
+        }
+        checkMarket(u.spot, u.riskFreeRate, volatility);
+        slices_[slice].volatility = volatility;
+        markDirty(slice);
+    }
+    
+    // Value, delta and gamma of the whole book, repricing only what the
+    // updates since the last call touched
+    PositionRisk risk() {
+        SerialExecutor serial;
+        return risk(serial);
+    }
+    
+    // Same, repricing the dirty positions on an executor
+    PositionRisk risk(Executor& executor) {
+        revalue(executor);
+        return total_;
+    }
+    
+    // Aggregate for one underlying, as of the last risk() call
+    PositionRisk underlyingRisk(std::size_t underlying) const { return underlyingAt(underlying).risk; }
+    
+    // Quantity-weighted risk of one position, as of the last risk() call
+    const PositionRisk& positionRisk(std::size_t position) const {
+        if (position >= risks_.size()) {
+            throw std::invalid_argument("Unknown position");
+        }
+        return risks_[position];
+    }
+    
+    // Positions repriced by the last risk() call
+    std::size_t lastRevalued() const { return lastRevalued_; }
+    
+    std::size_t size() const { return positions_.size(); }
+    std::size_t underlyings() const { return underlyings_.size(); }
+    
+private:
+    struct Underlying {
+        double spot;
+        double riskFreeRate;
+        double volatility;
+        std::vector<std::size_t> slices;  // sorted by expiry
+        PositionRisk risk;
+        bool dirty;
+    };
+    
+    struct Slice {
+        std::size_t underlying;
+        double timeToMaturity;
+        double volatility;
+        std::vector<std::size_t> positions;
+        PositionRisk risk;
+        bool dirty;
+    };
+    
+    struct Position {
+        std::size_t slice;
+        double strike;
+        OptionType type;
+        ExerciseType exerciseType;
+        PricingMethod pricingMethod;
+        unsigned int steps;
+        double quantity;
+    };
+    
+    std::vector<Underlying> underlyings_;
+    std::vector<Slice> slices_;
+    std::vector<Position> positions_;
+    std::vector<PositionRisk> risks_;     // per position, quantity-weighted
+    std::vector<std::size_t> dirtySlices_;
+    PositionRisk total_ = {0.0, 0.0, 0.0};
+    bool totalDirty_ = false;
+    std::size_t lastRevalued_ = 0;
+    
+    Underlying& underlyingAt(std::size_t underlying) {
+        if (underlying >= underlyings_.size()) {
+            throw std::invalid_argument("Unknown underlying");
+        }
+        return underlyings_[underlying];
+    }
+    
+    const Underlying& underlyingAt(std::size_t underlying) const {
+        if (underlying >= underlyings_.size()) {
+            throw std::invalid_argument("Unknown underlying");
+        }
+        return underlyings_[underlying];
+    }
+    
+    static void checkMarket(double spot, double riskFreeRate, double volatility) {
+        if (!(spot > 0.0) || !std::isfinite(spot)) {
+            throw std::invalid_argument("Spot price must be positive and finite");
+        }
+        if (!std::isfinite(riskFreeRate)) {
+            throw std::invalid_argument("Risk-free rate must be finite");
+        }
+        if (!(volatility > 0.0) || !std::isfinite(volatility)) {
+            throw std::invalid_argument("Volatility must be positive and finite");
+        }
+    }
+    
+    // The existing slice of this underlying at this expiry, or slices_.size()
+    std::size_t findSlice(const Underlying& u, double timeToMaturity) const {
+        auto it = std::lower_bound(u.slices.begin(), u.slices.end(), timeToMaturity,
+                                   [&](std::size_t slice, double t) { return slices_[slice].timeToMaturity < t; });
+        return it != u.slices.end() && slices_[*it].timeToMaturity == timeToMaturity ? *it : slices_.size();
+    }
+    
+    // The slice of this underlying at this expiry, created if new
+    std::size_t sliceFor(std::size_t underlying, double timeToMaturity) {
+        Underlying& u = underlyings_[underlying];
+        auto it = std::lower_bound(u.slices.begin(), u.slices.end(), timeToMaturity,
+                                   [&](std::size_t slice, double t) { return slices_[slice].timeToMaturity < t; });
+        if (it != u.slices.end() && slices_[*it].timeToMaturity == timeToMaturity) {
+            return *it;
+        }
+        slices_.push_back({underlying, timeToMaturity, u.volatility, {}, {0.0, 0.0, 0.0}, false});
+        u.slices.insert(it, slices_.size() - 1);
+        return slices_.size() - 1;
+    }
+    
+    void markDirty(std::size_t slice) {
+        if (!slices_[slice].dirty) {
+            slices_[slice].dirty = true;
+            dirtySlices_.push_back(slice);
+        }
+    }
+    
+    void markUnderlyingDirty(std::size_t underlying) {
+        for (std::size_t slice : underlyings_[underlying].slices) {
+            markDirty(slice);
+        }
+    }
+    
+    static void accumulate(PositionRisk& total, const PositionRisk& r) {
+        total.value += r.value;
+        total.delta += r.delta;
+        total.gamma += r.gamma;
+    }
+    
+    void revalue(Executor& executor) {
+        std::vector<std::size_t> work;
+        for (std::size_t slice : dirtySlices_) {
+            work.insert(work.end(), slices_[slice].positions.begin(), slices_[slice].positions.end());
+        }
+        executor.parallelFor(work.size(), [&](std::size_t k) {
+            std::size_t i = work[k];
+            const Position& p = positions_[i];
+            const Slice& slice = slices_[p.slice];
+            const Underlying& u = underlyings_[slice.underlying];
+            // The throwaway option lives on the stack unless it outgrows the buffer
+            alignas(std::max_align_t) unsigned char buffer[256];
+            std::pmr::monotonic_buffer_resource scratch(buffer, sizeof(buffer));
+            PositionRisk r = OptionFactory::createOption(scratch, u.spot, p.strike, u.riskFreeRate,
+                                                         slice.volatility, slice.timeToMaturity, p.type,
+                                                         p.exerciseType, p.pricingMethod, p.steps)->risk();
+            risks_[i] = {r.value * p.quantity, r.delta * p.quantity, r.gamma * p.quantity};
+        });
+        lastRevalued_ = work.size();
+        
+        for (std::size_t s : dirtySlices_) {
+            Slice& slice = slices_[s];
+            slice.risk = {0.0, 0.0, 0.0};
+            for (std::size_t i : slice.positions) {
+                accumulate(slice.risk, risks_[i]);
+            }
+            slice.dirty = false;
+            underlyings_[slice.underlying].dirty = true;
+            totalDirty_ = true;
+        }
+        dirtySlices_.clear();
+        
+        for (Underlying& u : underlyings_) {
+            if (!u.dirty) {
+                continue;
+            }
+            u.risk = {0.0, 0.0, 0.0};
+            for (std::size_t slice : u.slices) {
+                accumulate(u.risk, slices_[slice].risk);
+            }
+            u.dirty = false;
+        }
+        if (totalDirty_) {
+            total_ = {0.0, 0.0, 0.0};
+            for (const Underlying& u : underlyings_) {
+                accumulate(total_, u.risk);
+            }
+            totalDirty_ = false;
+        }
+    }
 };
 
 } // namespace OptionsPricing
@@ -0,0 +1,536 @@
+#ifndef OPTIONS_PRICING_POSITION_FILE_HPP
+#define OPTIONS_PRICING_POSITION_FILE_HPP
+
+#include "BatchBlackScholes.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace OptionsPricing {
+
+// Not included by options_pricing.h, since it pulls in the OS mapping
+// headers (<windows.h>, or <sys/mman.h> and friends); include it directly.
+//
+// A whole file mapped into memory, read-only or created read-write at a
+// fixed size. release() hands a range's pages back to the OS once they
+// have been used, which is what keeps streaming over a file larger than
+// memory at a bounded footprint; written pages stay in the page cache and
+// reach the file as usual. Create resizes an existing file rather than
+// truncating it, so rewriting last run's results reuses its cached pages
+// instead of waiting for them to be dropped.
+class MappedFile {
+public:
+    enum class Mode { Read, Create };
+
+    MappedFile(const std::string& path, Mode mode, std::size_t size = 0) : mode_(mode) {
+#if defined(_WIN32)
+        DWORD access = mode == Mode::Read ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE;
+        DWORD disposition = mode == Mode::Read ? OPEN_EXISTING : OPEN_ALWAYS;
+        file_ = CreateFileA(path.c_str(), access, FILE_SHARE_READ, nullptr, disposition,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            fail("Cannot open", path);
+        }
+        if (mode == Mode::Read) {
+            LARGE_INTEGER length;
+            GetFileSizeEx(file_, &length);
+            size = static_cast<std::size_t>(length.QuadPart);
+        } else {
+            LARGE_INTEGER length;
+            length.QuadPart = static_cast<LONGLONG>(size);
+            if (!SetFilePointerEx(file_, length, nullptr, FILE_BEGIN) || !SetEndOfFile(file_)) {
+                close();
+                fail("Cannot size", path);
+            }
+        }
+        size_ = size;
+        if (size_ > 0) {
+            ULARGE_INTEGER length;
+            length.QuadPart = size_;
+            mapping_ = CreateFileMappingA(file_, nullptr, mode == Mode::Read ? PAGE_READONLY : PAGE_READWRITE,
+                                          length.HighPart, length.LowPart, nullptr);
+            if (!mapping_) {
+                close();
+                fail("Cannot map", path);
+            }
+            data_ = static_cast<unsigned char*>(
+                MapViewOfFile(mapping_, mode == Mode::Read ? FILE_MAP_READ : FILE_MAP_WRITE, 0, 0, size_));
+            if (!data_) {
+                close();
+                fail("Cannot map", path);
+            }
+        }
+#else
+        fd_ = mode == Mode::Read ? ::open(path.c_str(), O_RDONLY) : ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) {
+            fail("Cannot open", path);
+        }
+        if (mode == Mode::Read) {
+            struct stat info;
+            if (::fstat(fd_, &info) != 0) {
+                close();
+                fail("Cannot stat", path);
+            }
+            size = static_cast<std::size_t>(info.st_size);
+        } else if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+            close();
+            fail("Cannot size", path);
+        }
+        size_ = size;
+        if (size_ > 0) {
+            void* data = ::mmap(nullptr, size_, mode == Mode::Read ? PROT_READ : PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd_, 0);
+            if (data == MAP_FAILED) {
+                close();
+                fail("Cannot map", path);
+            }
+            data_ = static_cast<unsigned char*>(data);
+            ::madvise(data_, size_, MADV_SEQUENTIAL);
+        }
+#endif
+    }
+
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data() const { return data_; }
+    unsigned char* data() { return mode_ == Mode::Create ? data_ : nullptr; }
+    std::size_t size() const { return size_; }
+
+    // Drop the whole pages inside [offset, offset + length) from memory,
+    // starting write-back first for a created file
+    void release(std::size_t offset, std::size_t length) {
+#if defined(_WIN32)
+        static const std::size_t page = [] {
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return static_cast<std::size_t>(info.dwPageSize);
+        }();
+#else
+        static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+        std::size_t begin = (offset + page - 1) / page * page;
+        std::size_t end = std::min(offset + length, size_) / page * page;
+        if (begin >= end) {
+            return;
+        }
+#if defined(_WIN32)
+        if (mode_ == Mode::Create) {
+            FlushViewOfFile(data_ + begin, end - begin);
+        }
+        // Unlocking pages that are not locked fails, but still takes them out
+        // of the working set, which is the documented way to trim a view
+        VirtualUnlock(data_ + begin, end - begin);
+#else
+        if (mode_ == Mode::Create) {
+            ::msync(data_ + begin, end - begin, MS_ASYNC);
+        }
+        ::madvise(data_ + begin, end - begin, MADV_DONTNEED);
+#endif
+    }
+
+private:
+    Mode mode_;
+    unsigned char* data_ = nullptr;
+    std::size_t size_ = 0;
+#if defined(_WIN32)
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+
+    void close() {
+#if defined(_WIN32)
+        if (data_) {
+            UnmapViewOfFile(data_);
+        }
+        if (mapping_) {
+            CloseHandle(mapping_);
+        }
+        if (file_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(file_);
+        }
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) {
+            ::munmap(data_, size_);
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+    }
+
+    [[noreturn]] static void fail(const char* what, const std::string& path) {
+#if defined(_WIN32)
+        throw std::runtime_error(std::string(what) + " " + path + " (error " + std::to_string(GetLastError()) + ")");
+#else
+        throw std::runtime_error(std::string(what) + " " + path + ": " + std::strerror(errno));
+#endif
+    }
+};
+
+// Columnar files: a 64-byte header, then one column per bit of the header's
+// column mask, in bit order, each starting on a 64-byte boundary. Position
+// files hold spot, strike, rate, volatility and maturity as doubles and the
+// OptionType as a 32-bit integer; result files hold the double columns named
+// in ResultColumns. Values are in native byte order.
+namespace ResultColumns {
+constexpr unsigned Price = 1u << 0;
+constexpr unsigned Delta = 1u << 1;
+constexpr unsigned Gamma = 1u << 2;
+constexpr unsigned Theta = 1u << 3;
+constexpr unsigned Vega = 1u << 4;
+constexpr unsigned Rho = 1u << 5;
+constexpr unsigned Vanna = 1u << 6;
+constexpr unsigned Volga = 1u << 7;
+constexpr unsigned Charm = 1u << 8;
+constexpr unsigned All = (1u << 9) - 1;
+} // namespace ResultColumns
+
+namespace detail {
+
+struct ColumnarHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t columnMask;
+    std::uint64_t count;
+    unsigned char reserved[40];
+};
+static_assert(sizeof(ColumnarHeader) == 64, "the columns start at byte 64");
+static_assert(sizeof(OptionType) == sizeof(std::int32_t), "position files store OptionType as int32");
+
+constexpr char positionMagic[8] = {'O', 'P', 'P', 'O', 'S', 'N', 'S', '1'};
+constexpr char resultMagic[8] = {'O', 'P', 'R', 'S', 'L', 'T', 'S', '1'};
+constexpr std::uint32_t columnarVersion = 1;
+constexpr std::size_t positionColumns = 6;
+
+inline std::size_t columnBytes(std::uint64_t count, std::size_t elementSize) {
+    return static_cast<std::size_t>((count * elementSize + 63) / 64 * 64);
+}
+
+// Byte offset of each column, the element size of column k given by size(k)
+template <typename ElementSize>
+inline std::size_t columnarLayout(std::uint64_t count, std::uint32_t mask, std::size_t* offsets,
+                                  ElementSize size) {
+    std::size_t offset = sizeof(ColumnarHeader);
+    for (std::size_t k = 0; k < 32; ++k) {
+        if (mask & (1u << k)) {
+            offsets[k] = offset;
+            offset += columnBytes(count, size(k));
+        }
+    }
+    return offset;
+}
+
+inline std::size_t positionElementSize(std::size_t column) {
+    return column == positionColumns - 1 ? sizeof(std::int32_t) : sizeof(double);
+}
+
+inline std::size_t resultElementSize(std::size_t) { return sizeof(double); }
+
+// Layout of a file being read, with the header's count checked against the
+// file size first so count * elementSize cannot wrap into a small layout
+template <typename ElementSize>
+inline std::size_t checkedLayout(const MappedFile& file, const ColumnarHeader& header, std::size_t* offsets,
+                                 ElementSize size, const std::string& path) {
+    std::uint64_t rowBytes = 0;
+    for (std::size_t k = 0; k < 32; ++k) {
+        if (header.columnMask & (1u << k)) {
+            rowBytes += size(k);
+        }
+    }
+    std::uint64_t payload = file.size() - sizeof(ColumnarHeader);
+    if (rowBytes > 0 && header.count > payload / rowBytes) {
+        throw std::runtime_error(path + " is shorter than its header says");
+    }
+    std::size_t bytes = columnarLayout(header.count, header.columnMask, offsets, size);
+    if (file.size() < bytes) {
+        throw std::runtime_error(path + " is shorter than its header says");
+    }
+    return bytes;
+}
+
+inline void writeHeader(unsigned char* data, const char (&magic)[8], std::uint32_t mask, std::uint64_t count) {
+    ColumnarHeader header = {};
+    std::memcpy(header.magic, magic, sizeof(header.magic));
+    header.version = columnarVersion;
+    header.columnMask = mask;
+    header.count = count;
+    std::memcpy(data, &header, sizeof(header));
+}
+
+inline ColumnarHeader readHeader(const MappedFile& file, const char (&magic)[8], const std::string& path) {
+    ColumnarHeader header;
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error(path + " is too short for a columnar header");
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, magic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error(path + " is not the expected kind of columnar file");
+    }
+    if (header.version != columnarVersion) {
+        throw std::runtime_error(path + " has unsupported version " + std::to_string(header.version));
+    }
+    return header;
+}
+
+} // namespace detail
+
+// Creates a position file of a fixed size straight in a mapping, so a book
+// of any size can be written one position at a time
+class PositionFileWriter {
+public:
+    PositionFileWriter(const std::string& path, std::size_t count)
+        : file_(path, MappedFile::Mode::Create, layout(count)), count_(count) {
+        detail::writeHeader(file_.data(), detail::positionMagic, (1u << detail::positionColumns) - 1, count);
+    }
+
+    void set(std::size_t i, double spot, double strike, double riskFreeRate, double volatility,
+             double timeToMaturity, OptionType type) {
+        if (i >= count_) {
+            throw std::out_of_range("Position index beyond the file's count");
+        }
+        const double values[detail::positionColumns - 1] = {spot, strike, riskFreeRate, volatility, timeToMaturity};
+        for (std::size_t k = 0; k + 1 < detail::positionColumns; ++k) {
+            std::memcpy(file_.data() + offsets_[k] + i * sizeof(double), &values[k], sizeof(double));
+        }
+        std::int32_t code = static_cast<std::int32_t>(type);
+        std::memcpy(file_.data() + offsets_[detail::positionColumns - 1] + i * sizeof(code), &code, sizeof(code));
+    }
+
+    // Let go of the pages holding positions [begin, end) once they are
+    // written, to keep the footprint bounded when writing a large book
+    void release(std::size_t begin, std::size_t end) {
+        for (std::size_t k = 0; k < detail::positionColumns; ++k) {
+            std::size_t element = detail::positionElementSize(k);
+            file_.release(offsets_[k] + begin * element, (end - begin) * element);
+        }
+    }
+
+    std::size_t size() const { return count_; }
+
+private:
+    std::size_t offsets_[32] = {};
+    MappedFile file_;
+    std::size_t count_;
+
+    std::size_t layout(std::size_t count) {
+        return detail::columnarLayout(count, (1u << detail::positionColumns) - 1, offsets_,
+                                      detail::positionElementSize);
+    }
+};
+
+// Writes a whole in-memory batch as a position file
+inline void writePositionFile(const std::string& path, const OptionBatchView& batch) {
+    constexpr std::size_t stretch = 1 << 16;
+    PositionFileWriter writer(path, batch.size);
+    for (std::size_t begin = 0; begin < batch.size; begin += stretch) {
+        std::size_t end = std::min(begin + stretch, batch.size);
+        for (std::size_t i = begin; i < end; ++i) {
+            writer.set(i, batch.spot[i], batch.strike[i], batch.riskFreeRate[i], batch.volatility[i],
+                       batch.timeToMaturity[i], batch.type[i]);
+        }
+        writer.release(begin, end);
+    }
+}
+
+// A mapped position file, read in place: view() and chunk() point into the
+// mapping and copy nothing
+class PositionFile {
+public:
+    explicit PositionFile(const std::string& path) : file_(path, MappedFile::Mode::Read) {
+        detail::ColumnarHeader header = detail::readHeader(file_, detail::positionMagic, path);
+        if (header.columnMask != (1u << detail::positionColumns) - 1) {
+            throw std::runtime_error(path + " does not hold the six position columns");
+        }
+        detail::checkedLayout(file_, header, offsets_, detail::positionElementSize, path);
+        count_ = static_cast<std::size_t>(header.count);
+    }
+
+    std::size_t size() const { return count_; }
+
+    OptionBatchView view() const { return chunk(0, count_); }
+
+    // Positions [begin, end) as a batch
+    OptionBatchView chunk(std::size_t begin, std::size_t end) const {
+        return {column<double>(0) + begin, column<double>(1) + begin, column<double>(2) + begin,
+                column<double>(3) + begin, column<double>(4) + begin, column<OptionType>(5) + begin,
+                end - begin};
+    }
+
+    // Let go of the pages holding positions [begin, end)
+    void release(std::size_t begin, std::size_t end) {
+        for (std::size_t k = 0; k < detail::positionColumns; ++k) {
+            std::size_t element = detail::positionElementSize(k);
+            file_.release(offsets_[k] + begin * element, (end - begin) * element);
+        }
+    }
+
+private:
+    MappedFile file_;
+    std::size_t offsets_[32] = {};
+    std::size_t count_ = 0;
+
+    template <typename T>
+    const T* column(std::size_t k) const {
+        return reinterpret_cast<const T*>(file_.data() + offsets_[k]);
+    }
+};
+
+// A mapped result file as written by StreamingPricer
+class ResultFile {
+public:
+    explicit ResultFile(const std::string& path) : file_(path, MappedFile::Mode::Read) {
+        detail::ColumnarHeader header = detail::readHeader(file_, detail::resultMagic, path);
+        mask_ = header.columnMask;
+        if ((mask_ & ~ResultColumns::All) != 0) {
+            throw std::runtime_error(path + " names unknown result columns");
+        }
+        detail::checkedLayout(file_, header, offsets_, detail::resultElementSize, path);
+        count_ = static_cast<std::size_t>(header.count);
+    }
+
+    std::size_t size() const { return count_; }
+    unsigned columns() const { return mask_; }
+
+    // One ResultColumns value; null if the file does not hold that column
+    const double* column(unsigned which) const {
+        for (std::size_t k = 0; k < 9; ++k) {
+            if (which == (1u << k)) {
+                return (mask_ & which) ? reinterpret_cast<const double*>(file_.data() + offsets_[k]) : nullptr;
+            }
+        }
+        throw std::invalid_argument("column() takes a single ResultColumns value");
+    }
+
+private:
+    MappedFile file_;
+    std::size_t offsets_[32] = {};
+    unsigned mask_ = 0;
+    std::size_t count_ = 0;
+};
+
+struct StreamingSettings {
+    std::size_t chunkContracts = 1 << 16;  // positions per task
+    unsigned columns = ResultColumns::Price;
+    bool validate = true;  // check every chunk as BatchBlackScholes::validateInputs() does
+};
+
+// Prices a position file into a result file with the batch Black-Scholes
+// kernels (European exercise), reading and writing both mappings in place:
+// no Option objects, no per-position allocation and no copies. Chunks are
+// priced in rounds of one per executor thread, and the pages of each round
+// are released once it is done, so resident memory stays at about
+// concurrency * chunkContracts * (48 + 8 * columns) bytes however large the
+// book. Results are identical to BatchBlackScholes on the same inputs for
+// any thread count or chunk size.
+class StreamingPricer {
+public:
+    explicit StreamingPricer(StreamingSettings settings = StreamingSettings()) : settings_(settings) {
+        if (settings_.chunkContracts == 0) {
+            throw std::invalid_argument("Streaming needs a positive chunk size");
+        }
+        if (settings_.columns == 0 || (settings_.columns & ~ResultColumns::All) != 0) {
+            throw std::invalid_argument("Streaming needs at least one known result column");
+        }
+    }
+
+    // Returns the number of positions priced
+    std::size_t run(const std::string& positionsPath, const std::string& resultsPath) const {
+        SerialExecutor serial;
+        return run(positionsPath, resultsPath, serial);
+    }
+
+    std::size_t run(const std::string& positionsPath, const std::string& resultsPath, Executor& executor) const {
+        PositionFile positions(positionsPath);
+        const std::size_t n = positions.size();
+        std::size_t offsets[32] = {};
+        std::size_t size = detail::columnarLayout(n, settings_.columns, offsets, detail::resultElementSize);
+        MappedFile results(resultsPath, MappedFile::Mode::Create, size);
+        detail::writeHeader(results.data(), detail::resultMagic, settings_.columns, n);
+
+        double* columns[9];
+        for (std::size_t k = 0; k < 9; ++k) {
+            columns[k] = (settings_.columns & (1u << k))
+                ? reinterpret_cast<double*>(results.data() + offsets[k]) : nullptr;
+        }
+        const bool priceOnly = settings_.columns == ResultColumns::Price;
+        const std::size_t chunk = settings_.chunkContracts;
+        const std::size_t chunks = (n + chunk - 1) / chunk;
+        const std::size_t perRound = std::max<std::size_t>(executor.concurrency(), 1);
+
+        for (std::size_t first = 0; first < chunks; first += perRound) {
+            std::size_t count = std::min(perRound, chunks - first);
+            executor.parallelFor(count, [&](std::size_t c) {
+                std::size_t begin = (first + c) * chunk;
+                std::size_t end = std::min(begin + chunk, n);
+                OptionBatchView batch = positions.chunk(begin, end);
+                if (settings_.validate) {
+                    validate(batch, begin);
+                }
+                if (priceOnly) {
+                    BatchBlackScholes::price(batch, columns[0] + begin);
+                    return;
+                }
+                auto at = [&](std::size_t k) { return columns[k] ? columns[k] + begin : nullptr; };
+                BatchBlackScholes::greeks(batch, {at(0), at(1), at(2), at(3), at(4), at(5), at(6), at(7), at(8)});
+            });
+
+            std::size_t begin = first * chunk;
+            std::size_t end = std::min((first + count) * chunk, n);
+            positions.release(begin, end);
+            for (std::size_t k = 0; k < 9; ++k) {
+                if (columns[k]) {
+                    results.release(offsets[k] + begin * sizeof(double), (end - begin) * sizeof(double));
+                }
+            }
+        }
+        return n;
+    }
+
+    const StreamingSettings& settings() const { return settings_; }
+
+private:
+    StreamingSettings settings_;
+
+    // validateInputs() on one chunk, reporting the index in the file
+    static void validate(const OptionBatchView& batch, std::size_t begin) {
+        try {
+            BatchBlackScholes::validateInputs(batch);
+        } catch (const std::invalid_argument& error) {
+            throw std::invalid_argument(std::string(error.what()) + " in the chunk at position " +
+                                        std::to_string(begin));
+        }
+    }
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_POSITION_FILE_HPP
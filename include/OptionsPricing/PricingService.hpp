@@ -0,0 +1,476 @@
+#ifndef OPTIONS_PRICING_PRICING_SERVICE_HPP
+#define OPTIONS_PRICING_PRICING_SERVICE_HPP
+
+#include "BatchBlackScholes.hpp"
+#include "BinomialTree.hpp"
+#include "BlackScholes.hpp"
+#include "ImpliedVolatility.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+namespace OptionsPricing {
+
+namespace detail {
+
+// Results of one PricingService queue in one window, shared with its
+// futures. Tasks fill a chunk's values, then mark it done under the mutex,
+// so one lock and notify serve a whole chunk of requests.
+template <typename T>
+struct ServiceResults {
+    explicit ServiceResults(std::size_t chunk) : chunk(chunk) {}
+
+    const std::size_t chunk;
+    std::size_t size = 0;  // requests accepted; read by the dispatcher once the window closes
+    std::vector<T> values;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::vector<unsigned char> done;          // per chunk, guarded by mutex
+    std::vector<std::exception_ptr> errors;   // per chunk, guarded by mutex
+
+    // Dispatcher, before any task runs
+    void open() {
+        values.resize(size);
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t chunks = (size + chunk - 1) / chunk;
+        done.assign(chunks, 0);
+        errors.assign(chunks, nullptr);
+    }
+
+    void finish(std::size_t chunkIndex, std::exception_ptr error) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done[chunkIndex] = 1;
+            errors[chunkIndex] = error;
+        }
+        ready.notify_all();
+    }
+
+    bool isDone(std::size_t chunkIndex) const { return chunkIndex < done.size() && done[chunkIndex]; }
+};
+
+} // namespace detail
+
+// Handle to one PricingService result, filled in when its batch has run
+template <typename T>
+class PricingFuture {
+public:
+    PricingFuture() = default;
+
+    bool valid() const { return static_cast<bool>(results_); }
+
+    // True once get() will not block
+    bool ready() const {
+        std::lock_guard<std::mutex> lock(results_->mutex);
+        return results_->isDone(index_ / results_->chunk);
+    }
+
+    void wait() const {
+        std::unique_lock<std::mutex> lock(results_->mutex);
+        std::size_t chunk = index_ / results_->chunk;
+        results_->ready.wait(lock, [&] { return results_->isDone(chunk); });
+    }
+
+    template <typename Rep, typename Period>
+    bool waitFor(const std::chrono::duration<Rep, Period>& timeout) const {
+        std::unique_lock<std::mutex> lock(results_->mutex);
+        std::size_t chunk = index_ / results_->chunk;
+        return results_->ready.wait_for(lock, timeout, [&] { return results_->isDone(chunk); });
+    }
+
+    // Waits, then returns the result or rethrows the batch's exception
+    T get() const {
+        std::unique_lock<std::mutex> lock(results_->mutex);
+        std::size_t chunk = index_ / results_->chunk;
+        results_->ready.wait(lock, [&] { return results_->isDone(chunk); });
+        if (results_->errors[chunk]) {
+            std::rethrow_exception(results_->errors[chunk]);
+        }
+        return results_->values[index_];
+    }
+
+private:
+    friend class PricingService;
+
+    PricingFuture(std::shared_ptr<detail::ServiceResults<T>> results, std::size_t index)
+        : results_(std::move(results)), index_(index) {}
+
+    std::shared_ptr<detail::ServiceResults<T>> results_;
+    std::size_t index_ = 0;
+};
+
+struct PricingServiceSettings {
+    std::chrono::microseconds window{200};  // longest a request waits for its batch to fill
+    std::size_t maxBatch = 16384;           // pending requests that close a window early
+    std::size_t chunkContracts = 1024;      // closed-form contracts per executor task
+    std::size_t chunkStrikes = 64;          // tree strikes per executor task
+    BinomialTreeSettings tree;              // every priceTree() request
+    double impliedVolTolerance = 1e-6;
+    unsigned int impliedVolMaxIterations = 100;
+};
+
+// Asynchronous front end that turns single requests into batches.
+//
+// Requests are queued and answered through PricingFuture. A dispatcher
+// thread opens a window when the first request arrives and closes it after
+// settings.window, or as soon as maxBatch requests are waiting. Then it
+// sorts the queue into batches and runs them on the executor:
+// - Black-Scholes prices and Greeks go through the SIMD batch kernels.
+// - Implied volatilities go through the batch Newton solve.
+// - Tree requests are grouped by spot, rate, volatility, expiry and
+//   exercise, and each group is priced as one strike ladder.
+// New requests fill the next window while a batch runs. A request
+// therefore waits at most one window, plus the batch in flight, plus its
+// own batch, which bounds its latency. Futures of one queue share their
+// window's results, so a request costs no allocation of its own, and a
+// finished chunk wakes its waiters with one notify.
+//
+// Inputs are validated on submission, with the engines' messages. The
+// batch implied volatility solver does not count iterations, so
+// ImpliedVolResult::iterations is 0. Destruction answers every accepted
+// request. The service may be called from any number of threads. The
+// executor must outlive it; a WorkStealingPool counts the dispatcher as
+// one of its participants.
+class PricingService {
+public:
+    explicit PricingService(Executor& executor, PricingServiceSettings settings = PricingServiceSettings())
+        : executor_(executor), settings_(settings) {
+        if (settings_.maxBatch == 0 || settings_.chunkContracts == 0 || settings_.chunkStrikes == 0) {
+            throw std::invalid_argument("PricingService batch and chunk sizes must be positive");
+        }
+        dispatcher_ = std::thread([this] { dispatchLoop(); });
+    }
+
+    ~PricingService() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        dispatcher_.join();
+    }
+
+    PricingService(const PricingService&) = delete;
+    PricingService& operator=(const PricingService&) = delete;
+
+    // European Black-Scholes price
+    PricingFuture<double> price(double spot, double strike, double riskFreeRate, double volatility,
+                                double timeToMaturity, OptionType type) {
+        validate(spot, strike, volatility, timeToMaturity);
+        return submit([&](Queues& q) {
+            q.prices.contracts.push(spot, strike, riskFreeRate, volatility, timeToMaturity, type);
+            return q.prices.accept(settings_.chunkContracts);
+        });
+    }
+
+    // European Black-Scholes price and Greeks, in FullGreeks units
+    PricingFuture<BlackScholesOption::FullGreeks> greeks(double spot, double strike, double riskFreeRate,
+                                                         double volatility, double timeToMaturity,
+                                                         OptionType type) {
+        validate(spot, strike, volatility, timeToMaturity);
+        return submit([&](Queues& q) {
+            q.greeks.contracts.push(spot, strike, riskFreeRate, volatility, timeToMaturity, type);
+            return q.greeks.accept(settings_.chunkContracts);
+        });
+    }
+
+    // Never throws for bad quotes; the status says what went wrong
+    PricingFuture<ImpliedVolResult> impliedVolatility(double price, double spot, double strike,
+                                                      double riskFreeRate, double timeToMaturity,
+                                                      OptionType type) {
+        return submit([&](Queues& q) {
+            q.impliedVols.contracts.push(spot, strike, riskFreeRate, 0.0, timeToMaturity, type);
+            q.impliedVols.prices.push_back(price);
+            return q.impliedVols.accept(settings_.chunkContracts);
+        });
+    }
+
+    // Binomial tree price with settings.tree, European or American
+    PricingFuture<double> priceTree(double spot, double strike, double riskFreeRate, double volatility,
+                                    double timeToMaturity, OptionType type, ExerciseType exerciseType) {
+        validate(spot, strike, volatility, timeToMaturity);
+        return submit([&](Queues& q) {
+            TreeGroup& group = q.trees[TreeKey{spot, riskFreeRate, volatility, timeToMaturity, exerciseType}];
+            group.strikes.push_back(strike);
+            group.types.push_back(type);
+            return group.accept(settings_.chunkStrikes);
+        });
+    }
+
+    // Close the current window now instead of waiting it out
+    void flush() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.count == 0) {
+                return;
+            }
+            flushRequested_ = true;
+        }
+        wake_.notify_one();
+    }
+
+    const PricingServiceSettings& settings() const { return settings_; }
+
+private:
+    // One queue's contracts, as the columns of an OptionBatchView
+    struct Columns {
+        std::vector<double> spot;
+        std::vector<double> strike;
+        std::vector<double> riskFreeRate;
+        std::vector<double> volatility;
+        std::vector<double> timeToMaturity;
+        std::vector<OptionType> type;
+
+        void push(double s, double k, double r, double v, double t, OptionType o) {
+            spot.push_back(s);
+            strike.push_back(k);
+            riskFreeRate.push_back(r);
+            volatility.push_back(v);
+            timeToMaturity.push_back(t);
+            type.push_back(o);
+        }
+
+        // Contracts [begin, begin + n)
+        OptionBatchView view(std::size_t begin, std::size_t n) const {
+            return {spot.data() + begin, strike.data() + begin, riskFreeRate.data() + begin,
+                    volatility.data() + begin, timeToMaturity.data() + begin, type.data() + begin, n};
+        }
+
+        void clear() {
+            spot.clear();
+            strike.clear();
+            riskFreeRate.clear();
+            volatility.clear();
+            timeToMaturity.clear();
+            type.clear();
+        }
+    };
+
+    // Results of requests in one queue, in arrival order
+    template <typename Result>
+    struct ResultSlots {
+        std::shared_ptr<detail::ServiceResults<Result>> results;
+
+        PricingFuture<Result> accept(std::size_t chunk) {
+            if (!results) {
+                results = std::make_shared<detail::ServiceResults<Result>>(chunk);
+            }
+            return PricingFuture<Result>(results, results->size++);
+        }
+    };
+
+    template <typename Result>
+    struct ContractQueue : ResultSlots<Result> {
+        Columns contracts;
+
+        void clear() {
+            contracts.clear();
+            this->results.reset();
+        }
+    };
+
+    struct ImpliedVolQueue : ContractQueue<ImpliedVolResult> {
+        std::vector<double> prices;
+
+        void clear() {
+            ContractQueue<ImpliedVolResult>::clear();
+            prices.clear();
+        }
+    };
+
+    // One tree: everything but the strike and type
+    struct TreeKey {
+        double spot;
+        double riskFreeRate;
+        double volatility;
+        double timeToMaturity;
+        ExerciseType exerciseType;
+
+        bool operator<(const TreeKey& other) const {
+            return std::tie(spot, riskFreeRate, volatility, timeToMaturity, exerciseType) <
+                   std::tie(other.spot, other.riskFreeRate, other.volatility, other.timeToMaturity,
+                            other.exerciseType);
+        }
+    };
+
+    struct TreeGroup : ResultSlots<double> {
+        std::vector<double> strikes;
+        std::vector<OptionType> types;
+    };
+
+    // Everything accepted in one window
+    struct Queues {
+        ContractQueue<double> prices;
+        ContractQueue<BlackScholesOption::FullGreeks> greeks;
+        ImpliedVolQueue impliedVols;
+        std::map<TreeKey, TreeGroup> trees;
+        std::size_t count = 0;
+
+        // Keeps the columns' capacity for the next window
+        void clear() {
+            prices.clear();
+            greeks.clear();
+            impliedVols.clear();
+            trees.clear();
+            count = 0;
+        }
+    };
+
+    Executor& executor_;
+    PricingServiceSettings settings_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    Queues pending_;  // guarded by mutex_
+    Queues running_;  // dispatcher only
+    std::chrono::steady_clock::time_point windowStart_;
+    bool flushRequested_ = false;
+    bool stopping_ = false;
+    std::thread dispatcher_;
+
+    static void validate(double spot, double strike, double volatility, double timeToMaturity) {
+        if (!(spot > 0.0)) {
+            throw std::invalid_argument("Spot price must be positive");
+        }
+        if (!(strike > 0.0)) {
+            throw std::invalid_argument("Strike price must be positive");
+        }
+        if (!(volatility > 0.0)) {
+            throw std::invalid_argument("Volatility must be positive");
+        }
+        if (!(timeToMaturity > 0.0)) {
+            throw std::invalid_argument("Time to maturity must be positive");
+        }
+    }
+
+    // Queue one request; the first of a window starts its clock and wakes
+    // the dispatcher, and so does the one that fills the batch
+    template <typename Enqueue>
+    std::invoke_result_t<Enqueue, Queues&> submit(Enqueue enqueue) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto future = enqueue(pending_);
+        std::size_t count = ++pending_.count;
+        if (count == 1) {
+            windowStart_ = std::chrono::steady_clock::now();
+        }
+        lock.unlock();
+        if (count == 1 || count == settings_.maxBatch) {
+            wake_.notify_one();
+        }
+        return future;
+    }
+
+    void dispatchLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&] { return stopping_ || pending_.count > 0; });
+            if (pending_.count == 0) {
+                return;
+            }
+            wake_.wait_until(lock, windowStart_ + settings_.window, [&] {
+                return stopping_ || flushRequested_ || pending_.count >= settings_.maxBatch;
+            });
+            flushRequested_ = false;
+            std::swap(pending_, running_);
+            lock.unlock();
+            run(running_);
+            running_.clear();
+            lock.lock();
+        }
+    }
+
+    // One task per chunk of a queue. compute(begin, n, values) fills
+    // values[begin, begin + n); the chunk's futures see the values or the
+    // exception together.
+    template <typename Result, typename Compute>
+    static void chunked(std::vector<std::function<void()>>& tasks, ResultSlots<Result>& slots, Compute compute) {
+        if (!slots.results) {
+            return;
+        }
+        detail::ServiceResults<Result>& results = *slots.results;
+        results.open();
+        for (std::size_t begin = 0, index = 0; begin < results.size; begin += results.chunk, ++index) {
+            std::size_t n = std::min(results.chunk, results.size - begin);
+            tasks.push_back([&results, begin, n, index, compute] {
+                std::exception_ptr error;
+                try {
+                    compute(begin, n, results.values.data() + begin);
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                results.finish(index, error);
+            });
+        }
+    }
+
+    static BinomialTreeOption::Workspace& treeWorkspace() {
+        thread_local BinomialTreeOption::Workspace workspace;
+        return workspace;
+    }
+
+    // One window's batches as executor tasks, trees first as the costliest
+    void run(Queues& q) {
+        std::vector<std::function<void()>> tasks;
+
+        for (auto& entry : q.trees) {
+            const TreeKey& key = entry.first;
+            TreeGroup& group = entry.second;
+            chunked(tasks, group, [this, &key, &group](std::size_t begin, std::size_t n, double* out) {
+                BinomialTreeOption tree(key.spot, group.strikes[begin], key.riskFreeRate, key.volatility,
+                                        key.timeToMaturity, group.types[begin], key.exerciseType, settings_.tree);
+                tree.priceStrikes(group.strikes.data() + begin, group.types.data() + begin, n, out, treeWorkspace());
+            });
+        }
+
+        ImpliedVolQueue& ivs = q.impliedVols;
+        chunked(tasks, ivs, [this, &ivs](std::size_t begin, std::size_t n, ImpliedVolResult* out) {
+            const Columns& c = ivs.contracts;
+            ImpliedVolBatchView view{ivs.prices.data() + begin, c.spot.data() + begin, c.strike.data() + begin,
+                                     c.riskFreeRate.data() + begin, c.timeToMaturity.data() + begin,
+                                     c.type.data() + begin, n};
+            std::vector<double> volatility(n);
+            std::vector<ImpliedVolStatus> status(n);
+            ImpliedVolatilityCalculator::calculateImpliedVolatilities(
+                view, volatility.data(), status.data(), settings_.impliedVolTolerance,
+                settings_.impliedVolMaxIterations);
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = {volatility[i], status[i], 0};
+            }
+        });
+
+        ContractQueue<BlackScholesOption::FullGreeks>& greeks = q.greeks;
+        chunked(tasks, greeks, [&greeks](std::size_t begin, std::size_t n, BlackScholesOption::FullGreeks* out) {
+            std::vector<double> columns(9 * n);
+            double* c = columns.data();
+            GreeksBatchOutput view{c,         c + n,     c + 2 * n, c + 3 * n, c + 4 * n,
+                                   c + 5 * n, c + 6 * n, c + 7 * n, c + 8 * n};
+            BatchBlackScholes::greeks(greeks.contracts.view(begin, n), view);
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = {c[i], c[n + i], c[2 * n + i], c[3 * n + i], c[4 * n + i],
+                          c[5 * n + i], c[6 * n + i], c[7 * n + i], c[8 * n + i]};
+            }
+        });
+
+        ContractQueue<double>& prices = q.prices;
+        chunked(tasks, prices, [&prices](std::size_t begin, std::size_t n, double* out) {
+            BatchBlackScholes::price(prices.contracts.view(begin, n), out);
+        });
+
+        executor_.parallelFor(tasks.size(), [&](std::size_t i) { tasks[i](); });
+    }
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_PRICING_SERVICE_HPP
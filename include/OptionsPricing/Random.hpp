@@ -0,0 +1,55 @@
+#ifndef OPTIONS_PRICING_RANDOM_HPP
+#define OPTIONS_PRICING_RANDOM_HPP
+
+#include <array>
+#include <cstdint>
+
+namespace OptionsPricing {
+
+// Philox4x32-10 counter-based generator (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3", SC11). Output is a pure function of the
+// 128-bit counter and 64-bit key, so any block of draws can be produced on
+// any thread, in any order, and always comes out the same.
+class Philox4x32 {
+public:
+    using Counter = std::array<std::uint32_t, 4>;
+
+    explicit Philox4x32(std::uint64_t seed)
+        : key0_(static_cast<std::uint32_t>(seed)), key1_(static_cast<std::uint32_t>(seed >> 32)) {}
+
+    Counter operator()(Counter counter) const {
+        std::uint32_t k0 = key0_;
+        std::uint32_t k1 = key1_;
+        for (int round = 0; round < 10; ++round) {
+            std::uint64_t product0 = static_cast<std::uint64_t>(0xD2511F53u) * counter[0];
+            std::uint64_t product1 = static_cast<std::uint64_t>(0xCD9E8D57u) * counter[2];
+            counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ k0,
+                       static_cast<std::uint32_t>(product1),
+                       static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ k1,
+                       static_cast<std::uint32_t>(product0)};
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        return counter;
+    }
+
+    // Two uniforms in the open interval (0, 1) from one counter, 53 bits each
+    void uniforms(const Counter& counter, double& first, double& second) const {
+        Counter bits = (*this)(counter);
+        first = toUniform(bits[0], bits[1]);
+        second = toUniform(bits[2], bits[3]);
+    }
+
+private:
+    std::uint32_t key0_;
+    std::uint32_t key1_;
+
+    static double toUniform(std::uint32_t high, std::uint32_t low) {
+        std::uint64_t mantissa = ((static_cast<std::uint64_t>(high) << 32) | low) >> 11;
+        return (static_cast<double>(mantissa) + 0.5) * 0x1.0p-53;
+    }
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_RANDOM_HPP
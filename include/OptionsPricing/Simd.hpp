@@ -0,0 +1,617 @@
+#ifndef OPTIONS_PRICING_SIMD_HPP
+#define OPTIONS_PRICING_SIMD_HPP
+
+#include "Common.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Hand-written vector kernels can be compiled out entirely by defining
+// OPTIONS_PRICING_NO_SIMD, leaving only the portable scalar kernels.
+#if !defined(OPTIONS_PRICING_NO_SIMD)
+#if defined(__x86_64__) || defined(_M_X64)
+#define OPTIONS_PRICING_SIMD_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define OPTIONS_PRICING_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#endif
+
+// Kernels for wider instruction sets are compiled inside target regions so
+// that the library does not need -mavx2 / -mavx512f; the right one is picked
+// at runtime.
+#if defined(__clang__)
+#define OPTIONS_PRICING_BEGIN_TARGET_AVX2 \
+    _Pragma("clang attribute push(__attribute__((target(\"avx2,fma\"))), apply_to = function)")
+#define OPTIONS_PRICING_BEGIN_TARGET_AVX512 \
+    _Pragma("clang attribute push(__attribute__((target(\"avx512f,avx512dq,avx2,fma\"))), apply_to = function)")
+#define OPTIONS_PRICING_END_TARGET _Pragma("clang attribute pop")
+#define OPTIONS_PRICING_END_TARGET_AVX512 OPTIONS_PRICING_END_TARGET
+#elif defined(__GNUC__)
+#define OPTIONS_PRICING_BEGIN_TARGET_AVX2 \
+    _Pragma("GCC push_options") _Pragma("GCC target(\"avx2,fma\")")
+// GCC's AVX-512 intrinsics trip -Wuninitialized on their own
+// _mm512_undefined_pd() placeholders once inlined, so silence it in there.
+#define OPTIONS_PRICING_BEGIN_TARGET_AVX512 \
+    _Pragma("GCC push_options") _Pragma("GCC target(\"avx512f,avx512dq,avx2,fma\")") \
+    _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wuninitialized\"") \
+    _Pragma("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+#define OPTIONS_PRICING_END_TARGET_AVX512 _Pragma("GCC diagnostic pop") _Pragma("GCC pop_options")
+#define OPTIONS_PRICING_END_TARGET _Pragma("GCC pop_options")
+#else
+#define OPTIONS_PRICING_BEGIN_TARGET_AVX2
+#define OPTIONS_PRICING_BEGIN_TARGET_AVX512
+#define OPTIONS_PRICING_END_TARGET
+#define OPTIONS_PRICING_END_TARGET_AVX512
+#endif
+
+namespace OptionsPricing {
+
+// Instruction sets the batch kernels are compiled for
+enum class SimdLevel { Scalar, NEON, AVX2, AVX512 };
+
+inline std::string simdLevelToString(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::NEON: return "NEON";
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::AVX512: return "AVX-512";
+        default: return "Scalar";
+    }
+}
+
+// Widest instruction set supported by both this build and the running CPU
+inline SimdLevel detectSimdLevel() {
+#if defined(OPTIONS_PRICING_SIMD_X86)
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return SimdLevel::AVX2;
+    }
+    return SimdLevel::Scalar;
+#else
+    // Without a portable CPUID helper, trust the flags the caller compiled with
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+    return SimdLevel::AVX512;
+#elif defined(__AVX2__)
+    return SimdLevel::AVX2;
+#else
+    return SimdLevel::Scalar;
+#endif
+#endif
+#elif defined(OPTIONS_PRICING_SIMD_NEON)
+    return SimdLevel::NEON;  // Advanced SIMD is mandatory on AArch64
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+// Detected once per process
+inline SimdLevel activeSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+// Clamp a requested level to what this machine can actually execute
+inline SimdLevel resolveSimdLevel(SimdLevel requested) {
+    SimdLevel available = activeSimdLevel();
+    if (requested == SimdLevel::NEON) {
+        return available == SimdLevel::NEON ? requested : SimdLevel::Scalar;
+    }
+    if (available == SimdLevel::NEON) {
+        return SimdLevel::Scalar;
+    }
+    return std::min(requested, available);
+}
+
+namespace simd {
+
+// Each namespace below exposes the same small vector vocabulary (Real, Vec,
+// Mask, lanes, load/store, arithmetic, select, bit tricks). Kernels are
+// written once in a detail/*.inl file and included into every namespace.
+// The f32 namespaces further down repeat the vocabulary over float lanes.
+
+namespace scalar {
+
+using Real = double;
+constexpr std::size_t lanes = 1;
+
+struct Vec { double v; };
+struct Mask { bool m; };
+
+inline Vec set1(double x) { return {x}; }
+inline Vec load(const double* p) { return {*p}; }
+inline void store(double* p, Vec a) { *p = a.v; }
+inline Vec loadSign(const OptionType* t) { return {*t == OptionType::Call ? 1.0 : -1.0}; }
+
+inline Vec operator+(Vec a, Vec b) { return {a.v + b.v}; }
+inline Vec operator-(Vec a, Vec b) { return {a.v - b.v}; }
+inline Vec operator*(Vec a, Vec b) { return {a.v * b.v}; }
+inline Vec operator/(Vec a, Vec b) { return {a.v / b.v}; }
+inline Vec operator-(Vec a) { return {-a.v}; }
+inline Mask operator<(Vec a, Vec b) { return {a.v < b.v}; }
+inline Mask operator>(Vec a, Vec b) { return {a.v > b.v}; }
+
+inline Vec mulAdd(Vec a, Vec b, Vec c) { return {a.v * b.v + c.v}; }
+inline Vec vsqrt(Vec a) { return {std::sqrt(a.v)}; }
+inline Vec vabs(Vec a) { return {std::fabs(a.v)}; }
+inline Vec vmin(Vec a, Vec b) { return {a.v < b.v ? a.v : b.v}; }
+inline Vec vmax(Vec a, Vec b) { return {a.v > b.v ? a.v : b.v}; }
+inline Vec vround(Vec a) { return {std::nearbyint(a.v)}; }
+inline Vec select(Mask m, Vec a, Vec b) { return m.m ? a : b; }
+inline bool any(Mask m) { return m.m; }
+inline Mask operator&(Mask a, Mask b) { return {a.m && b.m}; }
+inline Mask operator|(Mask a, Mask b) { return {a.m || b.m}; }
+inline Mask operator!(Mask a) { return {!a.m}; }
+
+// 2^n for integer-valued n in [-1022, 1023]
+inline Vec pow2i(Vec n) {
+    std::uint64_t bits = static_cast<std::uint64_t>(static_cast<std::int64_t>(n.v) + 1023) << 52;
+    double r;
+    std::memcpy(&r, &bits, sizeof r);
+    return {r};
+}
+
+// Split a positive normal x into x = m * 2^e with m in [1, 2)
+inline Vec exponentOf(Vec x) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &x.v, sizeof bits);
+    return {static_cast<double>(static_cast<std::int64_t>(bits >> 52) - 1023)};
+}
+
+inline Vec mantissaOf(Vec x) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &x.v, sizeof bits);
+    bits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+    double r;
+    std::memcpy(&r, &bits, sizeof r);
+    return {r};
+}
+
+#include "detail/SimdMath.inl"
+
+} // namespace scalar
+
+#if defined(OPTIONS_PRICING_SIMD_X86)
+
+OPTIONS_PRICING_BEGIN_TARGET_AVX2
+namespace avx2 {
+
+using Real = double;
+constexpr std::size_t lanes = 4;
+
+struct Vec { __m256d v; };
+struct Mask { __m256d m; };
+
+inline Vec set1(double x) { return {_mm256_set1_pd(x)}; }
+inline Vec load(const double* p) { return {_mm256_loadu_pd(p)}; }
+inline void store(double* p, Vec a) { _mm256_storeu_pd(p, a.v); }
+inline Vec loadSign(const OptionType* t) {
+    return {_mm256_set_pd(t[3] == OptionType::Call ? 1.0 : -1.0, t[2] == OptionType::Call ? 1.0 : -1.0,
+                          t[1] == OptionType::Call ? 1.0 : -1.0, t[0] == OptionType::Call ? 1.0 : -1.0)};
+}
+
+inline Vec operator+(Vec a, Vec b) { return {_mm256_add_pd(a.v, b.v)}; }
+inline Vec operator-(Vec a, Vec b) { return {_mm256_sub_pd(a.v, b.v)}; }
+inline Vec operator*(Vec a, Vec b) { return {_mm256_mul_pd(a.v, b.v)}; }
+inline Vec operator/(Vec a, Vec b) { return {_mm256_div_pd(a.v, b.v)}; }
+inline Vec operator-(Vec a) { return {_mm256_xor_pd(a.v, _mm256_set1_pd(-0.0))}; }
+inline Mask operator<(Vec a, Vec b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ)}; }
+inline Mask operator>(Vec a, Vec b) { return {_mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ)}; }
+
+inline Vec mulAdd(Vec a, Vec b, Vec c) { return {_mm256_fmadd_pd(a.v, b.v, c.v)}; }
+inline Vec vsqrt(Vec a) { return {_mm256_sqrt_pd(a.v)}; }
+inline Vec vabs(Vec a) { return {_mm256_andnot_pd(_mm256_set1_pd(-0.0), a.v)}; }
+inline Vec vmin(Vec a, Vec b) { return {_mm256_min_pd(a.v, b.v)}; }
+inline Vec vmax(Vec a, Vec b) { return {_mm256_max_pd(a.v, b.v)}; }
+inline Vec vround(Vec a) { return {_mm256_round_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline Vec select(Mask m, Vec a, Vec b) { return {_mm256_blendv_pd(b.v, a.v, m.m)}; }
+inline bool any(Mask m) { return _mm256_movemask_pd(m.m) != 0; }
+inline Mask operator&(Mask a, Mask b) { return {_mm256_and_pd(a.m, b.m)}; }
+inline Mask operator|(Mask a, Mask b) { return {_mm256_or_pd(a.m, b.m)}; }
+inline Mask operator!(Mask a) { return {_mm256_xor_pd(a.m, _mm256_castsi256_pd(_mm256_set1_epi64x(-1)))}; }
+
+inline Vec pow2i(Vec n) {
+    // Adding 2^52 leaves the biased exponent in the low mantissa bits
+    __m256d biased = _mm256_add_pd(n.v, _mm256_set1_pd(4503599627370496.0 + 1023.0));
+    return {_mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(biased), 52))};
+}
+
+inline Vec exponentOf(Vec x) {
+    __m256i e = _mm256_srli_epi64(_mm256_castpd_si256(x.v), 52);
+    __m256d asDouble = _mm256_castsi256_pd(_mm256_or_si256(e, _mm256_set1_epi64x(0x4330000000000000LL)));
+    return {_mm256_sub_pd(asDouble, _mm256_set1_pd(4503599627370496.0 + 1023.0))};
+}
+
+inline Vec mantissaOf(Vec x) {
+    __m256i bits = _mm256_and_si256(_mm256_castpd_si256(x.v), _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL));
+    return {_mm256_castsi256_pd(_mm256_or_si256(bits, _mm256_set1_epi64x(0x3FF0000000000000LL)))};
+}
+
+#include "detail/SimdMath.inl"
+
+} // namespace avx2
+OPTIONS_PRICING_END_TARGET
+
+OPTIONS_PRICING_BEGIN_TARGET_AVX512
+namespace avx512 {
+
+using Real = double;
+constexpr std::size_t lanes = 8;
+
+struct Vec { __m512d v; };
+struct Mask { __mmask8 m; };
+
+inline Vec set1(double x) { return {_mm512_set1_pd(x)}; }
+inline Vec load(const double* p) { return {_mm512_loadu_pd(p)}; }
+inline void store(double* p, Vec a) { _mm512_storeu_pd(p, a.v); }
+inline Vec loadSign(const OptionType* t) {
+    __mmask8 calls = 0;
+    for (int i = 0; i < 8; ++i) {
+        calls = static_cast<__mmask8>(calls | ((t[i] == OptionType::Call ? 1u : 0u) << i));
+    }
+    return {_mm512_mask_blend_pd(calls, _mm512_set1_pd(-1.0), _mm512_set1_pd(1.0))};
+}
+
+inline Vec operator+(Vec a, Vec b) { return {_mm512_add_pd(a.v, b.v)}; }
+inline Vec operator-(Vec a, Vec b) { return {_mm512_sub_pd(a.v, b.v)}; }
+inline Vec operator*(Vec a, Vec b) { return {_mm512_mul_pd(a.v, b.v)}; }
+inline Vec operator/(Vec a, Vec b) { return {_mm512_div_pd(a.v, b.v)}; }
+inline Vec operator-(Vec a) { return {_mm512_xor_pd(a.v, _mm512_set1_pd(-0.0))}; }
+inline Mask operator<(Vec a, Vec b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_LT_OQ)}; }
+inline Mask operator>(Vec a, Vec b) { return {_mm512_cmp_pd_mask(a.v, b.v, _CMP_GT_OQ)}; }
+
+inline Vec mulAdd(Vec a, Vec b, Vec c) { return {_mm512_fmadd_pd(a.v, b.v, c.v)}; }
+inline Vec vsqrt(Vec a) { return {_mm512_sqrt_pd(a.v)}; }
+inline Vec vabs(Vec a) { return {_mm512_abs_pd(a.v)}; }
+inline Vec vmin(Vec a, Vec b) { return {_mm512_min_pd(a.v, b.v)}; }
+inline Vec vmax(Vec a, Vec b) { return {_mm512_max_pd(a.v, b.v)}; }
+inline Vec vround(Vec a) { return {_mm512_roundscale_pd(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline Vec select(Mask m, Vec a, Vec b) { return {_mm512_mask_blend_pd(m.m, b.v, a.v)}; }
+inline bool any(Mask m) { return m.m != 0; }
+inline Mask operator&(Mask a, Mask b) { return {static_cast<__mmask8>(a.m & b.m)}; }
+inline Mask operator|(Mask a, Mask b) { return {static_cast<__mmask8>(a.m | b.m)}; }
+inline Mask operator!(Mask a) { return {static_cast<__mmask8>(~a.m)}; }
+
+inline Vec pow2i(Vec n) {
+    __m512i e = _mm512_add_epi64(_mm512_cvtpd_epi64(n.v), _mm512_set1_epi64(1023));
+    return {_mm512_castsi512_pd(_mm512_slli_epi64(e, 52))};
+}
+
+inline Vec exponentOf(Vec x) {
+    __m512i e = _mm512_srli_epi64(_mm512_castpd_si512(x.v), 52);
+    return {_mm512_cvtepi64_pd(_mm512_sub_epi64(e, _mm512_set1_epi64(1023)))};
+}
+
+inline Vec mantissaOf(Vec x) {
+    __m512i bits = _mm512_and_si512(_mm512_castpd_si512(x.v), _mm512_set1_epi64(0x000FFFFFFFFFFFFFLL));
+    return {_mm512_castsi512_pd(_mm512_or_si512(bits, _mm512_set1_epi64(0x3FF0000000000000LL)))};
+}
+
+#include "detail/SimdMath.inl"
+
+} // namespace avx512
+OPTIONS_PRICING_END_TARGET_AVX512
+
+#endif // OPTIONS_PRICING_SIMD_X86
+
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+
+namespace neon {
+
+using Real = double;
+constexpr std::size_t lanes = 2;
+
+struct Vec { float64x2_t v; };
+struct Mask { uint64x2_t m; };
+
+inline Vec set1(double x) { return {vdupq_n_f64(x)}; }
+inline Vec load(const double* p) { return {vld1q_f64(p)}; }
+inline void store(double* p, Vec a) { vst1q_f64(p, a.v); }
+inline Vec loadSign(const OptionType* t) {
+    double s[2] = {t[0] == OptionType::Call ? 1.0 : -1.0, t[1] == OptionType::Call ? 1.0 : -1.0};
+    return {vld1q_f64(s)};
+}
+
+inline Vec operator+(Vec a, Vec b) { return {vaddq_f64(a.v, b.v)}; }
+inline Vec operator-(Vec a, Vec b) { return {vsubq_f64(a.v, b.v)}; }
+inline Vec operator*(Vec a, Vec b) { return {vmulq_f64(a.v, b.v)}; }
+inline Vec operator/(Vec a, Vec b) { return {vdivq_f64(a.v, b.v)}; }
+inline Vec operator-(Vec a) { return {vnegq_f64(a.v)}; }
+inline Mask operator<(Vec a, Vec b) { return {vcltq_f64(a.v, b.v)}; }
+inline Mask operator>(Vec a, Vec b) { return {vcgtq_f64(a.v, b.v)}; }
+
+inline Vec mulAdd(Vec a, Vec b, Vec c) { return {vfmaq_f64(c.v, a.v, b.v)}; }
+inline Vec vsqrt(Vec a) { return {vsqrtq_f64(a.v)}; }
+inline Vec vabs(Vec a) { return {vabsq_f64(a.v)}; }
+inline Vec vmin(Vec a, Vec b) { return {vminq_f64(a.v, b.v)}; }
+inline Vec vmax(Vec a, Vec b) { return {vmaxq_f64(a.v, b.v)}; }
+inline Vec vround(Vec a) { return {vrndnq_f64(a.v)}; }
+inline Vec select(Mask m, Vec a, Vec b) { return {vbslq_f64(m.m, a.v, b.v)}; }
+inline bool any(Mask m) { return vmaxvq_u32(vreinterpretq_u32_u64(m.m)) != 0; }
+inline Mask operator&(Mask a, Mask b) { return {vandq_u64(a.m, b.m)}; }
+inline Mask operator|(Mask a, Mask b) { return {vorrq_u64(a.m, b.m)}; }
+inline Mask operator!(Mask a) { return {veorq_u64(a.m, vdupq_n_u64(~0ULL))}; }
+
+inline Vec pow2i(Vec n) {
+    int64x2_t e = vaddq_s64(vcvtnq_s64_f64(n.v), vdupq_n_s64(1023));
+    return {vreinterpretq_f64_s64(vshlq_n_s64(e, 52))};
+}
+
+inline Vec exponentOf(Vec x) {
+    int64x2_t e = vreinterpretq_s64_u64(vshrq_n_u64(vreinterpretq_u64_f64(x.v), 52));
+    return {vcvtq_f64_s64(vsubq_s64(e, vdupq_n_s64(1023)))};
+}
+
+inline Vec mantissaOf(Vec x) {
+    uint64x2_t bits = vandq_u64(vreinterpretq_u64_f64(x.v), vdupq_n_u64(0x000FFFFFFFFFFFFFULL));
+    return {vreinterpretq_f64_u64(vorrq_u64(bits, vdupq_n_u64(0x3FF0000000000000ULL)))};
+}
+
+#include "detail/SimdMath.inl"
+
+} // namespace neon
+
+#endif // OPTIONS_PRICING_SIMD_NEON
+
+// Single-precision vocabulary: twice the lanes per register and half the
+// bytes per contract, for kernels that can live with float accuracy
+namespace f32 {
+
+namespace scalar {
+
+using Real = float;
+constexpr std::size_t lanes = 1;
+
+struct Vec { float v; };
+struct Mask { bool m; };
+
+inline Vec set1(float x) { return {x}; }
+inline Vec load(const float* p) { return {*p}; }
+inline void store(float* p, Vec a) { *p = a.v; }
+inline Vec loadSign(const OptionType* t) { return {*t == OptionType::Call ? 1.0f : -1.0f}; }
+
+inline Vec operator+(Vec a, Vec b) { return {a.v + b.v}; }
+inline Vec operator-(Vec a, Vec b) { return {a.v - b.v}; }
+inline Vec operator*(Vec a, Vec b) { return {a.v * b.v}; }
+inline Vec operator/(Vec a, Vec b) { return {a.v / b.v}; }
+inline Vec operator-(Vec a) { return {-a.v}; }
+inline Mask operator<(Vec a, Vec b) { return {a.v < b.v}; }
+inline Mask operator>(Vec a, Vec b) { return {a.v > b.v}; }
+
+inline Vec mulAdd(Vec a, Vec b, Vec c) { return {a.v * b.v + c.v}; }
+inline Vec vsqrt(Vec a) { return {std::sqrt(a.v)}; }
+inline Vec vabs(Vec a) { return {std::fabs(a.v)}; }
+inline Vec vmin(Vec a, Vec b) { return {a.v < b.v ? a.v : b.v}; }
+inline Vec vmax(Vec a, Vec b) { return {a.v > b.v ? a.v : b.v}; }
+inline Vec vround(Vec a) { return {std::nearbyint(a.v)}; }
+inline Vec select(Mask m, Vec a, Vec b) { return m.m ? a : b; }
+inline bool any(Mask m) { return m.m; }
+inline Mask operator&(Mask a, Mask b) { return {a.m && b.m}; }
+inline Mask operator|(Mask a, Mask b) { return {a.m || b.m}; }
+inline Mask operator!(Mask a) { return {!a.m}; }
+
+// 2^n for integer-valued n in [-126, 127]
+inline Vec pow2i(Vec n) {
+    std::uint32_t bits = static_cast<std::uint32_t>(static_cast<std::int32_t>(n.v) + 127) << 23;
+    float r;
+    std::memcpy(&r, &bits, sizeof r);
+    return {r};
+}
+
+inline Vec exponentOf(Vec x) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &x.v, sizeof bits);
+    return {static_cast<float>(static_cast<std::int32_t>(bits >> 23) - 127)};
+}
+
+inline Vec mantissaOf(Vec x) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &x.v, sizeof bits);
+    bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+    float r;
+    std::memcpy(&r, &bits, sizeof r);
+    return {r};
+}
+
+#include "detail/SimdMathFloat.inl"
+
+} // namespace scalar
+
+#if defined(OPTIONS_PRICING_SIMD_X86)
+
+OPTIONS_PRICING_BEGIN_TARGET_AVX2
+namespace avx2 {
+
+using Real = float;
+constexpr std::size_t lanes = 8;
+
+struct Vec { __m256 v; };
+struct Mask { __m256 m; };
+
+inline Vec set1(float x) { return {_mm256_set1_ps(x)}; }
+inline Vec load(const float* p) { return {_mm256_loadu_ps(p)}; }
+inline void store(float* p, Vec a) { _mm256_storeu_ps(p, a.v); }
+inline Vec loadSign(const OptionType* t) {
+    float s[8];
+    for (int i = 0; i < 8; ++i) {
+        s[i] = t[i] == OptionType::Call ? 1.0f : -1.0f;
+    }
+    return {_mm256_loadu_ps(s)};
+}
+
+inline Vec operator+(Vec a, Vec b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline Vec operator-(Vec a, Vec b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline Vec operator*(Vec a, Vec b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline Vec operator/(Vec a, Vec b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline Vec operator-(Vec a) { return {_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f))}; }
+inline Mask operator<(Vec a, Vec b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)}; }
+inline Mask operator>(Vec a, Vec b) { return {_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ)}; }
+
+inline Vec mulAdd(Vec a, Vec b, Vec c) { return {_mm256_fmadd_ps(a.v, b.v, c.v)}; }
+inline Vec vsqrt(Vec a) { return {_mm256_sqrt_ps(a.v)}; }
+inline Vec vabs(Vec a) { return {_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v)}; }
+inline Vec vmin(Vec a, Vec b) { return {_mm256_min_ps(a.v, b.v)}; }
+inline Vec vmax(Vec a, Vec b) { return {_mm256_max_ps(a.v, b.v)}; }
+inline Vec vround(Vec a) { return {_mm256_round_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline Vec select(Mask m, Vec a, Vec b) { return {_mm256_blendv_ps(b.v, a.v, m.m)}; }
+inline bool any(Mask m) { return _mm256_movemask_ps(m.m) != 0; }
+inline Mask operator&(Mask a, Mask b) { return {_mm256_and_ps(a.m, b.m)}; }
+inline Mask operator|(Mask a, Mask b) { return {_mm256_or_ps(a.m, b.m)}; }
+inline Mask operator!(Mask a) { return {_mm256_xor_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(-1)))}; }
+
+inline Vec pow2i(Vec n) {
+    __m256i e = _mm256_add_epi32(_mm256_cvtps_epi32(n.v), _mm256_set1_epi32(127));
+    return {_mm256_castsi256_ps(_mm256_slli_epi32(e, 23))};
+}
+
+inline Vec exponentOf(Vec x) {
+    __m256i e = _mm256_srli_epi32(_mm256_castps_si256(x.v), 23);
+    return {_mm256_cvtepi32_ps(_mm256_sub_epi32(e, _mm256_set1_epi32(127)))};
+}
+
+inline Vec mantissaOf(Vec x) {
+    __m256i bits = _mm256_and_si256(_mm256_castps_si256(x.v), _mm256_set1_epi32(0x007FFFFF));
+    return {_mm256_castsi256_ps(_mm256_or_si256(bits, _mm256_set1_epi32(0x3F800000)))};
+}
+
+#include "detail/SimdMathFloat.inl"
+
+} // namespace avx2
+OPTIONS_PRICING_END_TARGET
+
+OPTIONS_PRICING_BEGIN_TARGET_AVX512
+namespace avx512 {
+
+using Real = float;
+constexpr std::size_t lanes = 16;
+
+struct Vec { __m512 v; };
+struct Mask { __mmask16 m; };
+
+inline Vec set1(float x) { return {_mm512_set1_ps(x)}; }
+inline Vec load(const float* p) { return {_mm512_loadu_ps(p)}; }
+inline void store(float* p, Vec a) { _mm512_storeu_ps(p, a.v); }
+inline Vec loadSign(const OptionType* t) {
+    __mmask16 calls = 0;
+    for (int i = 0; i < 16; ++i) {
+        calls = static_cast<__mmask16>(calls | ((t[i] == OptionType::Call ? 1u : 0u) << i));
+    }
+    return {_mm512_mask_blend_ps(calls, _mm512_set1_ps(-1.0f), _mm512_set1_ps(1.0f))};
+}
+
+inline Vec operator+(Vec a, Vec b) { return {_mm512_add_ps(a.v, b.v)}; }
+inline Vec operator-(Vec a, Vec b) { return {_mm512_sub_ps(a.v, b.v)}; }
+inline Vec operator*(Vec a, Vec b) { return {_mm512_mul_ps(a.v, b.v)}; }
+inline Vec operator/(Vec a, Vec b) { return {_mm512_div_ps(a.v, b.v)}; }
+inline Vec operator-(Vec a) { return {_mm512_xor_ps(a.v, _mm512_set1_ps(-0.0f))}; }
+inline Mask operator<(Vec a, Vec b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ)}; }
+inline Mask operator>(Vec a, Vec b) { return {_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ)}; }
+
+inline Vec mulAdd(Vec a, Vec b, Vec c) { return {_mm512_fmadd_ps(a.v, b.v, c.v)}; }
+inline Vec vsqrt(Vec a) { return {_mm512_sqrt_ps(a.v)}; }
+inline Vec vabs(Vec a) { return {_mm512_abs_ps(a.v)}; }
+inline Vec vmin(Vec a, Vec b) { return {_mm512_min_ps(a.v, b.v)}; }
+inline Vec vmax(Vec a, Vec b) { return {_mm512_max_ps(a.v, b.v)}; }
+inline Vec vround(Vec a) { return {_mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC)}; }
+inline Vec select(Mask m, Vec a, Vec b) { return {_mm512_mask_blend_ps(m.m, b.v, a.v)}; }
+inline bool any(Mask m) { return m.m != 0; }
+inline Mask operator&(Mask a, Mask b) { return {static_cast<__mmask16>(a.m & b.m)}; }
+inline Mask operator|(Mask a, Mask b) { return {static_cast<__mmask16>(a.m | b.m)}; }
+inline Mask operator!(Mask a) { return {static_cast<__mmask16>(~a.m)}; }
+
+inline Vec pow2i(Vec n) {
+    __m512i e = _mm512_add_epi32(_mm512_cvtps_epi32(n.v), _mm512_set1_epi32(127));
+    return {_mm512_castsi512_ps(_mm512_slli_epi32(e, 23))};
+}
+
+inline Vec exponentOf(Vec x) {
+    __m512i e = _mm512_srli_epi32(_mm512_castps_si512(x.v), 23);
+    return {_mm512_cvtepi32_ps(_mm512_sub_epi32(e, _mm512_set1_epi32(127)))};
+}
+
+inline Vec mantissaOf(Vec x) {
+    __m512i bits = _mm512_and_si512(_mm512_castps_si512(x.v), _mm512_set1_epi32(0x007FFFFF));
+    return {_mm512_castsi512_ps(_mm512_or_si512(bits, _mm512_set1_epi32(0x3F800000)))};
+}
+
+#include "detail/SimdMathFloat.inl"
+
+} // namespace avx512
+OPTIONS_PRICING_END_TARGET_AVX512
+
+#endif // OPTIONS_PRICING_SIMD_X86
+
+#if defined(OPTIONS_PRICING_SIMD_NEON)
+
+namespace neon {
+
+using Real = float;
+constexpr std::size_t lanes = 4;
+
+struct Vec { float32x4_t v; };
+struct Mask { uint32x4_t m; };
+
+inline Vec set1(float x) { return {vdupq_n_f32(x)}; }
+inline Vec load(const float* p) { return {vld1q_f32(p)}; }
+inline void store(float* p, Vec a) { vst1q_f32(p, a.v); }
+inline Vec loadSign(const OptionType* t) {
+    float s[4];
+    for (int i = 0; i < 4; ++i) {
+        s[i] = t[i] == OptionType::Call ? 1.0f : -1.0f;
+    }
+    return {vld1q_f32(s)};
+}
+
+inline Vec operator+(Vec a, Vec b) { return {vaddq_f32(a.v, b.v)}; }
+inline Vec operator-(Vec a, Vec b) { return {vsubq_f32(a.v, b.v)}; }
+inline Vec operator*(Vec a, Vec b) { return {vmulq_f32(a.v, b.v)}; }
+inline Vec operator/(Vec a, Vec b) { return {vdivq_f32(a.v, b.v)}; }
+inline Vec operator-(Vec a) { return {vnegq_f32(a.v)}; }
+inline Mask operator<(Vec a, Vec b) { return {vcltq_f32(a.v, b.v)}; }
+inline Mask operator>(Vec a, Vec b) { return {vcgtq_f32(a.v, b.v)}; }
+
+inline Vec mulAdd(Vec a, Vec b, Vec c) { return {vfmaq_f32(c.v, a.v, b.v)}; }
+inline Vec vsqrt(Vec a) { return {vsqrtq_f32(a.v)}; }
+inline Vec vabs(Vec a) { return {vabsq_f32(a.v)}; }
+inline Vec vmin(Vec a, Vec b) { return {vminq_f32(a.v, b.v)}; }
+inline Vec vmax(Vec a, Vec b) { return {vmaxq_f32(a.v, b.v)}; }
+inline Vec vround(Vec a) { return {vrndnq_f32(a.v)}; }
+inline Vec select(Mask m, Vec a, Vec b) { return {vbslq_f32(m.m, a.v, b.v)}; }
+inline bool any(Mask m) { return vmaxvq_u32(m.m) != 0; }
+inline Mask operator&(Mask a, Mask b) { return {vandq_u32(a.m, b.m)}; }
+inline Mask operator|(Mask a, Mask b) { return {vorrq_u32(a.m, b.m)}; }
+inline Mask operator!(Mask a) { return {vmvnq_u32(a.m)}; }
+
+inline Vec pow2i(Vec n) {
+    int32x4_t e = vaddq_s32(vcvtnq_s32_f32(n.v), vdupq_n_s32(127));
+    return {vreinterpretq_f32_s32(vshlq_n_s32(e, 23))};
+}
+
+inline Vec exponentOf(Vec x) {
+    int32x4_t e = vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_f32(x.v), 23));
+    return {vcvtq_f32_s32(vsubq_s32(e, vdupq_n_s32(127)))};
+}
+
+inline Vec mantissaOf(Vec x) {
+    uint32x4_t bits = vandq_u32(vreinterpretq_u32_f32(x.v), vdupq_n_u32(0x007FFFFFu));
+    return {vreinterpretq_f32_u32(vorrq_u32(bits, vdupq_n_u32(0x3F800000u)))};
+}
+
+#include "detail/SimdMathFloat.inl"
+
+} // namespace neon
+
+#endif // OPTIONS_PRICING_SIMD_NEON
+
+} // namespace f32
+
+} // namespace simd
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_SIMD_HPP
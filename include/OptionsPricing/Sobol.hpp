@@ -0,0 +1,247 @@
+#ifndef OPTIONS_PRICING_SOBOL_HPP
+#define OPTIONS_PRICING_SOBOL_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace OptionsPricing {
+
+// Sobol low-discrepancy sequence with Joe and Kuo's direction numbers
+// (new-joe-kuo-6.21201), 32 bits per coordinate. Points are produced in
+// Gray-code order: point n is the XOR of the direction numbers selected by
+// the bits of n ^ (n >> 1), so consecutive points differ by one XOR.
+class SobolSequence {
+public:
+    static constexpr unsigned int maxDimensions = 37;
+    static constexpr unsigned int bits = 32;
+
+    explicit SobolSequence(unsigned int dimensions) : dimensions_(dimensions), directions_(dimensions * bits) {
+        if (dimensions == 0 || dimensions > maxDimensions) {
+            throw std::invalid_argument("Sobol sequence supports 1 to " + std::to_string(maxDimensions) +
+                                        " dimensions");
+        }
+        // First dimension: van der Corput in base 2
+        for (unsigned int k = 0; k < bits; ++k) {
+            directions_[k] = 1u << (bits - 1 - k);
+        }
+        for (unsigned int d = 1; d < dimensions; ++d) {
+            const Primitive& poly = primitives()[d - 1];
+            std::uint32_t* v = &directions_[d * bits];
+            unsigned int s = poly.degree;
+            for (unsigned int k = 0; k < s; ++k) {
+                v[k] = poly.m[k] << (bits - 1 - k);
+            }
+            for (unsigned int k = s; k < bits; ++k) {
+                v[k] = v[k - s] ^ (v[k - s] >> s);
+                for (unsigned int j = 1; j < s; ++j) {
+                    if ((poly.a >> (s - 1 - j)) & 1u) {
+                        v[k] ^= v[k - j];
+                    }
+                }
+            }
+        }
+    }
+
+    unsigned int dimensions() const { return dimensions_; }
+
+    // Direction number for bit k of dimension d
+    std::uint32_t direction(unsigned int d, unsigned int k) const { return directions_[d * bits + k]; }
+
+    // Coordinate d of point n, computed directly
+    std::uint32_t point(std::uint32_t n, unsigned int d) const {
+        std::uint32_t gray = n ^ (n >> 1);
+        std::uint32_t x = 0;
+        for (unsigned int k = 0; gray != 0; ++k, gray >>= 1) {
+            if (gray & 1u) {
+                x ^= direction(d, k);
+            }
+        }
+        return x;
+    }
+
+    // Coordinate d of point n + 1 given that of point n
+    std::uint32_t next(std::uint32_t x, std::uint32_t n, unsigned int d) const {
+        return x ^ direction(d, trailingZeros(n + 1));
+    }
+
+private:
+    // Index of the lowest set bit of a non-zero n
+    static unsigned int trailingZeros(std::uint32_t n) {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, n);
+        return static_cast<unsigned int>(index);
+#elif defined(__GNUC__)
+        return static_cast<unsigned int>(__builtin_ctz(n));
+#else
+        unsigned int k = 0;
+        for (; (n & 1u) == 0; n >>= 1) {
+            ++k;
+        }
+        return k;
+#endif
+    }
+
+    // Degree s, coefficient bits a and initial direction integers m_1..m_s
+    struct Primitive {
+        unsigned int degree;
+        unsigned int a;
+        std::uint32_t m[7];
+    };
+
+    static const Primitive* primitives() {
+        static const Primitive table[maxDimensions - 1] = {
+            {1, 0, {1}},
+            {2, 1, {1, 3}},
+            {3, 1, {1, 3, 1}},
+            {3, 2, {1, 1, 1}},
+            {4, 1, {1, 1, 3, 3}},
+            {4, 4, {1, 3, 5, 13}},
+            {5, 2, {1, 1, 5, 5, 17}},
+            {5, 4, {1, 1, 5, 5, 5}},
+            {5, 7, {1, 1, 7, 11, 19}},
+            {5, 11, {1, 1, 5, 1, 1}},
+            {5, 13, {1, 1, 1, 3, 11}},
+            {5, 14, {1, 3, 5, 5, 31}},
+            {6, 1, {1, 3, 3, 9, 7, 49}},
+            {6, 13, {1, 1, 1, 15, 21, 21}},
+            {6, 16, {1, 3, 1, 13, 27, 49}},
+            {6, 19, {1, 1, 1, 15, 7, 5}},
+            {6, 22, {1, 3, 1, 15, 13, 25}},
+            {6, 25, {1, 1, 5, 5, 19, 61}},
+            {7, 1, {1, 3, 7, 11, 23, 15, 103}},
+            {7, 4, {1, 3, 7, 13, 13, 15, 69}},
+            {7, 7, {1, 1, 3, 13, 7, 35, 63}},
+            {7, 8, {1, 3, 5, 9, 1, 25, 53}},
+            {7, 14, {1, 3, 1, 13, 9, 35, 107}},
+            {7, 19, {1, 3, 1, 5, 27, 61, 31}},
+            {7, 21, {1, 1, 5, 11, 19, 41, 61}},
+            {7, 28, {1, 3, 5, 3, 3, 13, 69}},
+            {7, 31, {1, 1, 7, 13, 1, 19, 1}},
+            {7, 32, {1, 3, 7, 5, 13, 19, 59}},
+            {7, 37, {1, 1, 3, 9, 25, 29, 41}},
+            {7, 41, {1, 3, 5, 13, 23, 1, 55}},
+            {7, 42, {1, 3, 7, 3, 13, 59, 17}},
+            {7, 50, {1, 3, 1, 3, 5, 53, 69}},
+            {7, 55, {1, 1, 5, 5, 23, 33, 13}},
+            {7, 56, {1, 1, 7, 7, 1, 61, 123}},
+            {7, 59, {1, 1, 7, 9, 13, 61, 49}},
+            {7, 62, {1, 3, 3, 5, 3, 55, 33}},
+        };
+        return table;
+    }
+
+    unsigned int dimensions_;
+    std::vector<std::uint32_t> directions_;
+};
+
+// Nested uniform (Owen) scrambling of a 32-bit coordinate, using Burley's
+// hash-based permutation ("Practical Hash-based Owen Scrambling", JCGT 2020).
+// Each output bit is flipped by a hash of the seed and the bits above it,
+// which keeps the net properties of the sequence while randomizing it.
+inline std::uint32_t reverseBits(std::uint32_t x) {
+    x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+    x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+    x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+    x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+    return (x >> 16) | (x << 16);
+}
+
+inline std::uint32_t owenScramble(std::uint32_t x, std::uint32_t seed) {
+    x = reverseBits(x);
+    x ^= x * 0x3d20adeau;
+    x += seed;
+    x *= (seed >> 16) | 1u;
+    x ^= x * 0x05526c56u;
+    x ^= x * 0x53a22864u;
+    return reverseBits(x);
+}
+
+// Brownian bridge construction over n evenly spaced dates (Jaeckel, "Monte
+// Carlo Methods in Finance", ch. 10). The first normal sets the terminal
+// value, the next the midpoint, and so on by bisection, so the leading
+// dimensions of a low-discrepancy sequence carry most of the path variance.
+class BrownianBridge {
+public:
+    static constexpr unsigned int none = ~0u;
+
+    // W(bridge) = leftWeight * W(left) + rightWeight * W(right) + stdDev * z,
+    // where a neighbour of none means W(0) = 0 on the left or no right point
+    struct Step {
+        unsigned int bridge;
+        unsigned int left;
+        unsigned int right;
+        double leftWeight;
+        double rightWeight;
+        double stdDev;
+    };
+
+    BrownianBridge(unsigned int steps, double timeToMaturity) {
+        if (steps == 0) {
+            throw std::invalid_argument("Brownian bridge needs at least one step");
+        }
+        std::vector<double> t(steps);
+        for (unsigned int k = 0; k < steps; ++k) {
+            t[k] = timeToMaturity * (k + 1) / steps;
+        }
+
+        std::vector<bool> built(steps, false);
+        built[steps - 1] = true;
+        steps_.push_back({steps - 1, none, none, 0.0, 0.0, std::sqrt(t[steps - 1])});
+        unsigned int j = 0;
+        for (unsigned int i = 1; i < steps; ++i) {
+            // Next gap [j, k) of unbuilt dates, bridged at its midpoint l
+            while (built[j]) {
+                ++j;
+            }
+            unsigned int k = j;
+            while (!built[k]) {
+                ++k;
+            }
+            unsigned int l = j + ((k - 1 - j) >> 1);
+            built[l] = true;
+
+            double tLeft = j > 0 ? t[j - 1] : 0.0;
+            double span = t[k] - tLeft;
+            steps_.push_back({l, j > 0 ? j - 1 : none, k, (t[k] - t[l]) / span, (t[l] - tLeft) / span,
+                              std::sqrt((t[l] - tLeft) * (t[k] - t[l]) / span)});
+            j = k + 1;
+            if (j >= steps) {
+                j = 0;
+            }
+        }
+    }
+
+    unsigned int size() const { return static_cast<unsigned int>(steps_.size()); }
+
+    // Steps in construction order; step i consumes normal i
+    const std::vector<Step>& steps() const { return steps_; }
+
+    // Brownian path from normals, both of length size()
+    void transform(const double* z, double* w) const {
+        for (unsigned int i = 0; i < steps_.size(); ++i) {
+            const Step& s = steps_[i];
+            double x = s.stdDev * z[i];
+            if (s.right != none) {
+                x += s.rightWeight * w[s.right];
+            }
+            if (s.left != none) {
+                x += s.leftWeight * w[s.left];
+            }
+            w[s.bridge] = x;
+        }
+    }
+
+private:
+    std::vector<Step> steps_;
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_SOBOL_HPP
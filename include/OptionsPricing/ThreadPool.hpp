@@ -0,0 +1,208 @@
+#ifndef OPTIONS_PRICING_THREAD_POOL_HPP
+#define OPTIONS_PRICING_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OptionsPricing {
+
+// Minimal executor interface so callers can plug in their own scheduler
+class Executor {
+public:
+    virtual ~Executor() = default;
+
+    // Run task(i) for every i in [0, count) and return once all have finished.
+    // Tasks are handed out roughly in index order, so put expensive ones first.
+    virtual void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task) = 0;
+
+    // Number of threads that may run tasks at once
+    virtual std::size_t concurrency() const = 0;
+};
+
+// Runs everything on the calling thread
+class SerialExecutor : public Executor {
+public:
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task) override {
+        for (std::size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+    }
+
+    std::size_t concurrency() const override { return 1; }
+};
+
+// Fixed-size pool with one task deque per thread. Each thread pops from the
+// front of its own deque and steals from the back of the others when it runs
+// dry, so a few long tree valuations do not leave the other threads idle.
+// The calling thread takes part in the work while it waits. A task that
+// calls parallelFor on the same pool runs its inner loop inline.
+class WorkStealingPool : public Executor {
+public:
+    explicit WorkStealingPool(std::size_t threads = std::thread::hardware_concurrency()) {
+        std::size_t participants = threads > 0 ? threads : 1;
+        for (std::size_t i = 0; i < participants; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        // The caller is the last participant; the others are background workers
+        for (std::size_t i = 0; i + 1 < participants; ++i) {
+            workers_.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    ~WorkStealingPool() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    std::size_t concurrency() const override { return queues_.size(); }
+
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task) override {
+        if (count == 0) {
+            return;
+        }
+        if (workers_.empty() || currentPool() == this) {
+            SerialExecutor().parallelFor(count, task);
+            return;
+        }
+
+        std::lock_guard<std::mutex> submitLock(submit_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            error_ = nullptr;
+            pending_.store(count);
+            ++generation_;
+        }
+
+        // Deal indices round-robin; queue locks publish task_ to thieves
+        std::size_t participants = queues_.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            Queue& queue = *queues_[i % participants];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.items.push_back(i);
+        }
+        wake_.notify_all();
+
+        while (runOne(participants - 1)) {
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_.load() == 0; });
+        task_ = nullptr;
+        if (error_) {
+            std::exception_ptr error = error_;
+            error_ = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::size_t> items;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex submit_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(std::size_t)>* task_ = nullptr;
+    std::exception_ptr error_;
+    std::atomic<std::size_t> pending_{0};
+    std::size_t generation_ = 0;
+    bool stop_ = false;
+
+    // Pool whose task this thread is running, if any
+    static const WorkStealingPool*& currentPool() {
+        thread_local const WorkStealingPool* pool = nullptr;
+        return pool;
+    }
+    
+    bool popOwn(std::size_t self, std::size_t& item) {
+        Queue& queue = *queues_[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.items.empty()) {
+            return false;
+        }
+        item = queue.items.front();
+        queue.items.pop_front();
+        return true;
+    }
+
+    bool steal(std::size_t self, std::size_t& item) {
+        std::size_t participants = queues_.size();
+        for (std::size_t k = 1; k < participants; ++k) {
+            Queue& queue = *queues_[(self + k) % participants];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.items.empty()) {
+                item = queue.items.back();
+                queue.items.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Run one task from our own deque or a victim's; false when all are empty
+    bool runOne(std::size_t self) {
+        std::size_t item;
+        if (!popOwn(self, item) && !steal(self, item)) {
+            return false;
+        }
+        const WorkStealingPool* outer = currentPool();
+        currentPool() = this;
+        try {
+            (*task_)(item);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        currentPool() = outer;
+        if (pending_.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_.notify_all();
+        }
+        return true;
+    }
+
+    void workerLoop(std::size_t self) {
+        std::size_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+            }
+            while (runOne(self)) {
+            }
+        }
+    }
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_THREAD_POOL_HPP
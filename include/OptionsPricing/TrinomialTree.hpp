@@ -2,6 +2,16 @@
 #define OPTIONS_PRICING_TRINOMIAL_TREE_HPP
 
 #include "Common.hpp"
+#include "Adjoint.hpp"
+#include "LatticeCache.hpp"
+#include "Metrics.hpp"
+#include "Payoff.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
 #include <vector>
 
 namespace OptionsPricing {
@@ -15,74 +25,101 @@ public:
         : Option(spot, strike, riskFreeRate, volatility, timeToMaturity, 
                  type, exerciseType), steps_(steps) {}
     
+    // Scratch buffers for price(): two rolling value buffers and the payoff
+    // at every node spot, 3 * (2 * steps + 1) doubles in total. The power
+    // table is shared through LatticeParameterCache. No lattice of stock prices
+    // is kept, so memory grows as O(steps) rather than O(steps^2); only
+    // sensitivities() keeps checkpointed steps, about 4 * steps^1.5 doubles.
+    struct Workspace {
+        std::vector<double> optionValues;
+        std::vector<double> nextValues;
+        std::vector<double> exerciseValues;  // payoff at spot * u^j
+        std::vector<double> nodeValues;      // sensitivities(): checkpointed steps and the stretch replayed
+        std::vector<unsigned char> exercised;  // sensitivities(): early-exercise flags of that stretch
+    };
+    
+    // Bytes of scratch memory a price() call with this many steps needs,
+    // besides one cached power table of 2 * steps + 1 doubles per thread
+    static std::size_t workspaceBytes(unsigned int steps) {
+        return 3 * (2 * static_cast<std::size_t>(steps) + 1) * sizeof(double);
+    }
+    
     // Price the option using trinomial tree method
     double price() const override {
-        double dt = timeToMaturity_ / steps_;
-        double dx = volatility_ * sqrt(3.0 * dt);
-        double u = exp(dx);
-        double d = exp(-dx);
-        double m = 1.0; // Middle factor
-        
-        // Risk-neutral probabilities
-        double discountFactor = exp(-riskFreeRate_ * dt);
-        double pu = (exp(riskFreeRate_ * dt/2) - exp(-dx/2)) / (exp(dx/2) - exp(-dx/2)) * 
-                    (exp(dx/2) - 1) / (exp(dx/2) - exp(-dx/2));
-        double pd = (exp(dx/2) - exp(riskFreeRate_ * dt/2)) / (exp(dx/2) - exp(-dx/2)) * 
-                    (1 - exp(-dx/2)) / (exp(dx/2) - exp(-dx/2));
-        double pm = 1.0 - pu - pd;
-        
-        // Initialize the price lattice
-        std::vector<std::vector<double>> stockPrices(steps_ + 1);
-        for (unsigned int i = 0; i <= steps_; ++i) {
-            stockPrices[i].resize(2 * i + 1);
-            for (int j = -static_cast<int>(i); j <= static_cast<int>(i); ++j) {
-                stockPrices[i][j + i] = spot_ * pow(u, j);
-            }
-        }
-        
-        // Initialize option values at maturity
-        std::vector<double> optionValues(2 * steps_ + 1);
-        for (int j = -static_cast<int>(steps_); j <= static_cast<int>(steps_); ++j) {
-            double stockPrice = spot_ * pow(u, j);
-            if (type_ == OptionType::Call) {
-                optionValues[j + steps_] = std::max(0.0, stockPrice - strike_);
-            } else {  // Put
-                optionValues[j + steps_] = std::max(0.0, strike_ - stockPrice);
-            }
-        }
-        
-        // Work backwards through the tree
-        for (int i = steps_ - 1; i >= 0; --i) {
-            std::vector<double> newOptionValues(2 * i + 1);
-            for (int j = -i; j <= i; ++j) {
-                double stockPrice = spot_ * pow(u, j);
-                
-                // Calculate option value as discounted expected value
-                double optionValue = discountFactor * (
-                    pu * optionValues[j + 1 + steps_] +
-                    pm * optionValues[j + steps_] +
-                    pd * optionValues[j - 1 + steps_]
-                );
-                
-                // For American options, check if early exercise is optimal
-                if (exerciseType_ == ExerciseType::American) {
-                    if (type_ == OptionType::Call) {
-                        optionValue = std::max(optionValue, stockPrice - strike_);
-                    } else {  // Put
-                        optionValue = std::max(optionValue, strike_ - stockPrice);
-                    }
-                }
-                
-                newOptionValues[j + i] = optionValue;
-            }
-            optionValues = newOptionValues;
-        }
-        
-        return optionValues[0];
+        return price(threadWorkspace());
+    }
+    
+    // Price using caller-supplied scratch buffers
+    double price(Workspace& workspace) const {
+        PricingProbe probe(MetricEngine::TrinomialTree);
+        return backwardInduction(workspace, nullptr);
+    }
+    
+    // Price as above and record the early-exercise boundary. An American put
+    // at a positive rate is priced with the exercised region pruned either
+    // way (see detail::TreeExercise), so the boundary costs one spot per step.
+    double price(Workspace& workspace, ExerciseBoundary& boundary) const {
+        PricingProbe probe(MetricEngine::TrinomialTree);
+        boundary.dt = timeToMaturity_ / steps_;
+        boundary.spots.assign(steps_, std::numeric_limits<double>::quiet_NaN());
+        return backwardInduction(workspace, nullptr, &boundary);
+    }
+    
+    ExerciseBoundary exerciseBoundary() const {
+        ExerciseBoundary boundary;
+        price(threadWorkspace(), boundary);
+        return boundary;
+    }
+    
+    // Price a custom payoff (digital, power, ...) on this option's tree and
+    // exercise style; the option's own strike and type are not used
+    template <typename Payoff>
+    double pricePayoff(const Payoff& payoff) const {
+        return pricePayoff(payoff, threadWorkspace());
+    }
+    
+    template <typename Payoff>
+    double pricePayoff(const Payoff& payoff, Workspace& workspace) const {
+        PricingProbe probe(MetricEngine::TrinomialTree);
+        return dispatchExercise(workspace, nullptr, payoff);
+    }
+    
+    // Price with delta, vega, rho and theta from one adjoint sweep: a forward
+    // induction, then a reverse pass carrying the derivative of the price in
+    // each node value back to the three branch probabilities, the move and
+    // the spot, as in BinomialTreeOption. About four prices, against eight
+    // repricings for bumped Greeks.
+    Sensitivities sensitivities() const {
+        return sensitivities(threadWorkspace());
+    }
+    
+    Sensitivities sensitivities(Workspace& workspace) const {
+        PricingProbe probe(MetricEngine::TrinomialTree);
+        double derivatives[detail::adjointInputs];
+        double value = type_ == OptionType::Call
+            ? adjointExercise(workspace, CallPayoff{strike_}, derivatives)
+            : adjointExercise(workspace, PutPayoff{strike_}, derivatives);
+        return detail::sensitivitiesFrom(value, derivatives);
+    }
+    
+    // Per 1% change in the rate, from the adjoint sweep
+    double rho() const { return sensitivities().rho; }
+    
+    unsigned int steps() const { return steps_; }
+    
+    // About steps^2 nodes of three multiply-adds each
+    double pricingCost() const override {
+        double n = static_cast<double>(steps_);
+        return 1.0 + n * n / 20.0;
+    }
+    
+    std::unique_ptr<Option> withMarket(double spot, double volatility, double timeToMaturity) const override {
+        return std::make_unique<TrinomialTreeOption>(spot, strike_, riskFreeRate_, volatility, timeToMaturity,
+                                                     type_, exerciseType_, steps_);
     }
     
     // Calculate delta using finite difference method
-    double delta() const {
+    double delta() const override {
         double h = spot_ * 0.01;  // Small price change
         
         TrinomialTreeOption optionUp(spot_ + h, strike_, riskFreeRate_, 
@@ -97,7 +134,7 @@ public:
     }
     
     // Calculate gamma using finite difference method
-    double gamma() const {
+    double gamma() const override {
         double h = spot_ * 0.01;  // Small price change
         
         TrinomialTreeOption optionUp(spot_ + h, strike_, riskFreeRate_, 
@@ -153,9 +190,428 @@ public:
         return {delta(), gamma(), theta(), vega()};
     }
     
+    // Greeks with a choice of method. The lattice methods read delta, gamma
+    // and theta off the three nodes at step 1 of a single backward induction
+    // instead of repricing eight times.
+    Greeks calculateGreeks(TreeGreeksMethod method) const {
+        if (method == TreeGreeksMethod::FiniteDifference) {
+            return calculateGreeks();
+        }
+        if (method == TreeGreeksMethod::Adjoint) {
+            Sensitivities s = sensitivities();
+            return {s.delta, latticeGreeks().gamma, s.theta, s.vega};
+        }
+        
+        LatticeGreeks lattice = latticeGreeks();
+        Greeks greeks;
+        greeks.delta = lattice.delta;
+        greeks.gamma = lattice.gamma;
+        greeks.theta = lattice.theta;
+        if (method == TreeGreeksMethod::LatticeAnalyticVega) {
+            greeks.vega = greeks.gamma * volatility_ * spot_ * spot_ * timeToMaturity_ / 100.0;
+        } else {
+            greeks.vega = vega();
+        }
+        return greeks;
+    }
+    
+    // Price, delta and gamma from one backward induction (lattice Greeks)
+    PositionRisk risk() const override {
+        LatticeGreeks lattice = latticeGreeks();
+        return {lattice.value, lattice.delta, lattice.gamma};
+    }
+    
 private:
     unsigned int steps_;
-
+    
+    // Option values at the first time step, for lattice Greeks
+    struct EarlyNodes {
+        double step1[3];  // down, middle, up
+        double dt;
+        double u;
+    };
+    
+    struct LatticeGreeks {
+        double value;
+        double delta;
+        double gamma;
+        double theta;
+    };
+    
+    LatticeGreeks latticeGreeks() const {
+        PricingProbe probe(MetricEngine::TrinomialTree);
+        EarlyNodes nodes;
+        LatticeGreeks greeks;
+        greeks.value = backwardInduction(threadWorkspace(), &nodes);
+        
+        double spotUp = spot_ * nodes.u;
+        double spotDown = spot_ / nodes.u;
+        
+        greeks.delta = (nodes.step1[2] - nodes.step1[0]) / (spotUp - spotDown);
+        double deltaUp = (nodes.step1[2] - nodes.step1[1]) / (spotUp - spot_);
+        double deltaDown = (nodes.step1[1] - nodes.step1[0]) / (spot_ - spotDown);
+        greeks.gamma = (deltaUp - deltaDown) / (0.5 * (spotUp - spotDown));
+        // The middle node one step on has the same spot, dt later
+        greeks.theta = (nodes.step1[1] - greeks.value) / nodes.dt;
+        return greeks;
+    }
+    
+    static Workspace& threadWorkspace() {
+        thread_local Workspace workspace;
+        return workspace;
+    }
+    
+    std::uint64_t treeNodes() const {
+        return (static_cast<std::uint64_t>(steps_) + 1) * (steps_ + 1);
+    }
+    
+    // Pick the payoff and exercise policies once per price, not per node
+    double backwardInduction(Workspace& workspace, EarlyNodes* nodes, ExerciseBoundary* boundary = nullptr) const {
+        if (type_ == OptionType::Call) {
+            return dispatchExercise(workspace, nodes, CallPayoff{strike_}, boundary);
+        }
+        return dispatchExercise(workspace, nodes, PutPayoff{strike_}, boundary);
+    }
+    
+    template <typename Payoff>
+    double dispatchExercise(Workspace& workspace, EarlyNodes* nodes, const Payoff& payoff,
+                            ExerciseBoundary* boundary = nullptr) const {
+        if (exerciseType_ == ExerciseType::American) {
+            return inductionKernel<true>(workspace, nodes, payoff, boundary);
+        }
+        return inductionKernel<false>(workspace, nodes, payoff);
+    }
+    
+    // Boyle's move and discounted probabilities, over double for pricing or
+    // over detail::AdjointDual for sensitivities(). Node j sits at spot * exp(j * dx).
+    template <typename Real>
+    struct BoyleMoves {
+        Real dt;
+        Real dx;
+        Real up;
+        Real middle;
+        Real down;
+    };
+    
+    template <typename Real>
+    static BoyleMoves<Real> boyleMoves(const Real& volatility, const Real& riskFreeRate,
+                                       const Real& timeToMaturity, unsigned int steps) {
+        using std::exp;
+        using std::sqrt;
+        BoyleMoves<Real> moves;
+        moves.dt = timeToMaturity / steps;
+        moves.dx = volatility * sqrt(2.0 * moves.dt);
+        
+        // Risk-neutral probabilities (Boyle): two half-steps of a binomial
+        // tree with move exp(dx/2), which matches the drift exactly
+        Real discountFactor = exp(-riskFreeRate * moves.dt);
+        Real halfUp = exp(moves.dx / 2);
+        Real halfDown = exp(-moves.dx / 2);
+        Real growth = exp(riskFreeRate * moves.dt / 2);
+        Real pu = (growth - halfDown) / (halfUp - halfDown);
+        Real pd = (halfUp - growth) / (halfUp - halfDown);
+        pu = pu * pu;
+        pd = pd * pd;
+        Real pm = 1.0 - pu - pd;
+        
+        // Discounted probabilities, hoisted out of the node loop
+        moves.up = discountFactor * pu;
+        moves.middle = discountFactor * pm;
+        moves.down = discountFactor * pd;
+        return moves;
+    }
+    
+    // Boyle's moves, probabilities and power table, shared through the cache
+    const LatticeParameters& boyle() const {
+        LatticeKey key{LatticeFamily::Trinomial, volatility_, riskFreeRate_, timeToMaturity_, steps_};
+        return LatticeParameterCache::lookup(key, [&](LatticeParameters& lattice) {
+            BoyleMoves<double> moves = boyleMoves(volatility_, riskFreeRate_, timeToMaturity_, steps_);
+            lattice.dt = moves.dt;
+            lattice.up = moves.up;
+            lattice.middle = moves.middle;
+            lattice.down = moves.down;
+            
+            const int n = static_cast<int>(steps_);
+            std::vector<double>& powers = lattice.powers;
+            powers.resize(2 * steps_ + 1);
+            powers[n] = 1.0;
+            for (int k = 1; k <= n; ++k) {
+                powers[n + k] = exp(k * moves.dx);
+                powers[n - k] = 1.0 / powers[n + k];
+            }
+            lattice.u = powers[n + 1];
+        });
+    }
+    
+    // One step of the pruned American put induction over nodes [-i, i],
+    // given that the nodes of step i + 1 below `live` are exercised. A node
+    // whose three children are all exercised is exercised too and skipped;
+    // from `money` on exercise pays nothing and the continuation value is
+    // taken unchecked. Returns this step's `live`. Skipped nodes are left
+    // unwritten; the caller fills the two its next step reads.
+    static int prunedPutStep(const double* values, double* next, const double* exercise,
+                             double qu, double qm, double qd, int i, int live, int money) {
+        int start = std::max(-i, live - 1);
+        int checked = std::min(std::max(money, start), i + 1);
+        for (int j = start; j < checked; ++j) {
+            next[j] = std::max(qu * values[j + 1] + qm * values[j] + qd * values[j - 1], exercise[j]);
+        }
+        for (int j = checked; j <= i; ++j) {
+            next[j] = qu * values[j + 1] + qm * values[j] + qd * values[j - 1];
+        }
+        int first = start;
+        while (first < checked && next[first] == exercise[first]) {
+            ++first;
+        }
+        return first;
+    }
+    
+    // Lowest exercised node spot of step i for the node-by-node American
+    // induction, which only exposes a boundary for calls at negative rates
+    static double lowestExercised(const double* next, const double* exercise, int i, double spot,
+                                  const double* powers) {
+        for (int j = -i; j <= i; ++j) {
+            if (exercise[j] > 0.0 && next[j] == exercise[j]) {
+                return spot * powers[j];
+            }
+        }
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    
+    template <bool American, typename Payoff>
+    double inductionKernel(Workspace& workspace, EarlyNodes* nodes, const Payoff& payoff,
+                           ExerciseBoundary* boundary = nullptr) const {
+        recordMetric(MetricEngine::TrinomialTree, MetricCounter::Nodes, treeNodes());
+        const LatticeParameters& lattice = boyle();
+        double qu = lattice.up;
+        double qm = lattice.middle;
+        double qd = lattice.down;
+        
+        // Node j of every step sits at spot * u^j; buffers are indexed j + steps
+        const int n = static_cast<int>(steps_);
+        const std::vector<double>& powers = lattice.powers;
+        
+        // Node payoffs do not depend on the time step, so one table serves
+        // both the maturity values and every early-exercise check
+        std::vector<double>& exerciseValues = workspace.exerciseValues;
+        exerciseValues.resize(2 * steps_ + 1);
+        for (int k = 0; k <= 2 * n; ++k) {
+            exerciseValues[k] = payoff(spot_ * powers[k]);
+        }
+        
+        // Initialize option values at maturity
+        std::vector<double>& optionValues = workspace.optionValues;
+        std::vector<double>& nextValues = workspace.nextValues;
+        optionValues.assign(exerciseValues.begin(), exerciseValues.end());
+        nextValues.resize(2 * steps_ + 1);
+        
+        if (nodes) {
+            nodes->dt = lattice.dt;
+            nodes->u = lattice.u;
+            if (n == 1) {
+                std::copy(optionValues.begin(), optionValues.begin() + 3, nodes->step1);
+            }
+        }
+        
+        // Work backwards through the tree, swapping the two buffers each step.
+        // With the policies fixed at compile time the inner loop has no
+        // branches; the European one vectorizes.
+        const double* exercise = exerciseValues.data() + n;
+        detail::TreeExercise policy = American
+            ? detail::treeExercise<Payoff>(riskFreeRate_, std::min({qu, qm, qd}))
+            : detail::TreeExercise::European;
+        // Put nodes below `live` are exercised, at maturity every one in the
+        // money; put payoffs fall with j, so nodes from `money` on are out of it
+        int money = -n;
+        if (policy == detail::TreeExercise::PrunedPut) {
+            money = static_cast<int>(std::lower_bound(exerciseValues.begin(), exerciseValues.end(), 0.0,
+                                                      std::greater<double>()) - exerciseValues.begin()) - n;
+        }
+        int live = money;
+        for (int i = n - 1; i >= 0; --i) {
+            const double* values = optionValues.data() + n;
+            double* next = nextValues.data() + n;
+            if (policy == detail::TreeExercise::European) {
+                for (int j = -i; j <= i; ++j) {
+                    // Calculate option value as discounted expected value
+                    next[j] = qu * values[j + 1] + qm * values[j] + qd * values[j - 1];
+                }
+            } else if (policy == detail::TreeExercise::PrunedPut) {
+                live = prunedPutStep(values, next, exercise, qu, qm, qd, i, live, money);
+                int filled = nodes && i <= 1 ? -i : std::max(-i, live - 2);
+                for (int j = filled; j < live; ++j) {
+                    next[j] = exercise[j];
+                }
+                if (boundary) {
+                    boundary->spots[i] = live > -i ? spot_ * powers[n + live - 1]
+                                                   : std::numeric_limits<double>::quiet_NaN();
+                }
+            } else {
+                for (int j = -i; j <= i; ++j) {
+                    next[j] = std::max(qu * values[j + 1] + qm * values[j] + qd * values[j - 1], exercise[j]);
+                }
+                if (boundary) {
+                    boundary->spots[i] = lowestExercised(next, exercise, i, spot_, powers.data() + n);
+                }
+            }
+            optionValues.swap(nextValues);
+            
+            if (nodes && i == 1) {
+                std::copy(optionValues.begin() + n - 1, optionValues.begin() + n + 2, nodes->step1);
+            }
+        }
+        
+        return optionValues[n];
+    }
+    
+    template <typename Payoff>
+    double adjointExercise(Workspace& workspace, const Payoff& payoff, double* derivatives) const {
+        if (exerciseType_ == ExerciseType::American) {
+            return adjointKernel<true>(workspace, payoff, derivatives);
+        }
+        return adjointKernel<false>(workspace, payoff, derivatives);
+    }
+    
+    // Price of the tree, writing its derivatives in spot, volatility, rate
+    // and maturity. Node values are computed exactly as in inductionKernel(),
+    // so the price matches price().
+    template <bool American, typename Payoff>
+    double adjointKernel(Workspace& workspace, const Payoff& payoff, double* derivatives) const {
+        recordMetric(MetricEngine::TrinomialTree, MetricCounter::Nodes, treeNodes());
+        using detail::AdjointDual;
+        BoyleMoves<AdjointDual> moves =
+            boyleMoves(AdjointDual::variable(volatility_, detail::AdjointVolatility),
+                       AdjointDual::variable(riskFreeRate_, detail::AdjointRate),
+                       AdjointDual::variable(timeToMaturity_, detail::AdjointMaturity), steps_);
+        double qu = moves.up.v;
+        double qm = moves.middle.v;
+        double qd = moves.down.v;
+        
+        const int n = static_cast<int>(steps_);
+        const double* powers = boyle().powers.data();
+        std::vector<double>& exerciseValues = workspace.exerciseValues;
+        exerciseValues.resize(2 * steps_ + 1);
+        for (int k = 0; k <= 2 * n; ++k) {
+            exerciseValues[k] = payoff(spot_ * powers[k]);
+        }
+        const double* exercise = exerciseValues.data() + n;
+        
+        // As in BinomialTreeOption, the forward pass keeps every stride-th step
+        // and the reverse pass replays one stride at a time from its
+        // checkpoint, rather than keep a lattice that falls out of cache.
+        // Rows are indexed j + steps.
+        constexpr double negligibleAdjoint = 1e-280;
+        const int stride = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(n))));
+        const std::size_t width = 2 * std::size_t(n) + 1;
+        const int checkpointCount = n / stride;
+        std::vector<double>& rows = workspace.nodeValues;
+        rows.resize((checkpointCount + stride + 2) * width);
+        double* checkpoints = rows.data() + n;
+        double* stretch = checkpoints + (checkpointCount + 1) * width;
+        std::vector<unsigned char>& exercised = workspace.exercised;
+        if constexpr (American) {
+            exercised.resize(stride * width);
+        }
+        unsigned char* flagRows = exercised.data() + n;
+        
+        auto induct = [&](int i, const double* values, double* next, unsigned char* flags) {
+            for (int j = -i; j <= i; ++j) {
+                double optionValue = qu * values[j + 1] + qm * values[j] + qd * values[j - 1];
+                if constexpr (American) {
+                    flags[j] = optionValue < exercise[j];
+                    optionValue = std::max(optionValue, exercise[j]);
+                }
+                next[j] = optionValue;
+            }
+        };
+        auto keep = [&](int i, const double* level, double* row) {
+            std::copy(level - i, level + i + 1, row - i);
+        };
+        
+        double* next = stretch;
+        double* level = stretch + width;
+        keep(n, exercise, next);
+        if (n % stride == 0) {
+            keep(n, next, checkpoints + checkpointCount * width);
+        }
+        for (int i = n - 1; i >= 0; --i) {
+            induct(i, next, level, flagRows);
+            std::swap(next, level);
+            if (i % stride == 0) {
+                keep(i, next, checkpoints + (i / stride) * width);
+            }
+        }
+        double value = next[0];
+        
+        // Reverse pass from the root, the adjoints of two steps indexed j + steps
+        std::vector<double>& adjoints = workspace.optionValues;
+        std::vector<double>& nextAdjoints = workspace.nextValues;
+        adjoints.assign(2 * steps_ + 1, 0.0);
+        nextAdjoints.resize(2 * steps_ + 1);
+        double spotAdjoint = 0.0, moveAdjoint = 0.0, upAdjoint = 0.0, middleAdjoint = 0.0, downAdjoint = 0.0;
+        auto payoffNode = [&](int j, double a) {
+            double s = spot_ * powers[n + j];
+            double slope = a * payoff.derivative(s) * s;
+            spotAdjoint += slope;
+            moveAdjoint += j * slope;
+        };
+        adjoints[n] = 1.0;
+        for (int base = 0; base < n; base += stride) {
+            int top = std::min(base + stride, n);
+            double* topRow = stretch + (top - base) * width;
+            if (top % stride == 0) {
+                keep(top, checkpoints + (top / stride) * width, topRow);
+            } else {
+                keep(n, exercise, topRow);
+            }
+            for (int i = top - 1; i > base; --i) {
+                induct(i, stretch + (i + 1 - base) * width, stretch + (i - base) * width,
+                       flagRows + (i - base) * width);
+            }
+            if constexpr (American) {
+                // The stretch's first step only for its exercise flags
+                induct(base, stretch + width, stretch, flagRows);
+            }
+            
+            for (int i = base; i < top; ++i) {
+                const double* values = stretch + (i + 1 - base) * width;
+                const unsigned char* flags = flagRows + (i - base) * width;
+                const double* adjoint = adjoints.data() + n;
+                double* nextAdjoint = nextAdjoints.data() + n;
+                std::fill(nextAdjoint - i - 1, nextAdjoint + i + 2, 0.0);
+                for (int j = -i; j <= i; ++j) {
+                    // Tail adjoints would otherwise go subnormal
+                    double a = adjoint[j];
+                    if (std::fabs(a) < negligibleAdjoint) {
+                        continue;
+                    }
+                    if constexpr (American) {
+                        if (flags[j]) {
+                            payoffNode(j, a);
+                            continue;
+                        }
+                    }
+                    upAdjoint += a * values[j + 1];
+                    middleAdjoint += a * values[j];
+                    downAdjoint += a * values[j - 1];
+                    nextAdjoint[j + 1] += qu * a;
+                    nextAdjoint[j] += qm * a;
+                    nextAdjoint[j - 1] += qd * a;
+                }
+                adjoints.swap(nextAdjoints);
+            }
+        }
+        for (int j = -n; j <= n; ++j) {
+            payoffNode(j, adjoints[n + j]);
+        }
+        
+        for (std::size_t k = 0; k < detail::adjointInputs; ++k) {
+            derivatives[k] = upAdjoint * moves.up.d[k] + middleAdjoint * moves.middle.d[k] +
+                             downAdjoint * moves.down.d[k] + moveAdjoint * moves.dx.d[k];
+        }
+        derivatives[detail::AdjointSpot] += spotAdjoint / spot_;
+        return value;
+    }
 };
 
 } // namespace OptionsPricing
@@ -0,0 +1,234 @@
+#ifndef OPTIONS_PRICING_VOLATILITY_SURFACE_HPP
+#define OPTIONS_PRICING_VOLATILITY_SURFACE_HPP
+
+#include "Common.hpp"
+#include "BatchBlackScholes.hpp"
+#include "ImpliedVolatility.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace OptionsPricing {
+
+// Implied volatility surface on a strike/expiry grid.
+//
+// Each expiry's smile is a natural cubic spline in strike. Between expiries
+// the surface is linear in total variance sigma^2 * T, which keeps
+// calendar spreads free of arbitrage whenever the grid is. Outside the grid
+// the volatility is held flat in both strike and expiry.
+//
+// The spline coefficients are precomputed, four per strike interval and
+// contiguous, so a lookup is two binary searches and two cubic evaluations
+// touching one 32-byte block per expiry. Lookups never allocate and may run
+// concurrently; refitting with setVolatilities() or fitImpliedVolatilities()
+// must not overlap them.
+class VolatilitySurface {
+public:
+    // volatilities is row-major, one row of strikes.size() values per expiry.
+    // Expiries and strikes must be strictly increasing.
+    VolatilitySurface(std::vector<double> expiries, std::vector<double> strikes,
+                      std::vector<double> volatilities)
+        : expiries_(std::move(expiries)), strikes_(std::move(strikes)),
+          volatilities_(std::move(volatilities)) {
+        if (expiries_.empty()) {
+            throw std::invalid_argument("Volatility surface needs at least one expiry");
+        }
+        if (strikes_.size() < 2) {
+            throw std::invalid_argument("Volatility surface needs at least two strikes");
+        }
+        if (volatilities_.size() != expiries_.size() * strikes_.size()) {
+            throw std::invalid_argument("Need one volatility per expiry and strike");
+        }
+        for (std::size_t j = 0; j < expiries_.size(); ++j) {
+            if (!(expiries_[j] > 0.0) || (j > 0 && !(expiries_[j] > expiries_[j - 1]))) {
+                throw std::invalid_argument("Expiries must be positive and strictly increasing");
+            }
+        }
+        for (std::size_t i = 0; i < strikes_.size(); ++i) {
+            if (!(strikes_[i] > 0.0) || (i > 0 && !(strikes_[i] > strikes_[i - 1]))) {
+                throw std::invalid_argument("Strikes must be positive and strictly increasing");
+            }
+        }
+        coefficients_.resize(expiries_.size() * intervals() * 4);
+        curvature_.resize(strikes_.size());
+        pivot_.resize(strikes_.size());
+        fit();
+    }
+
+    // Volatility for a contract; O(log strikes + log expiries), no allocation
+    double volatility(double strike, double timeToMaturity) const {
+        std::size_t n = expiries_.size();
+        std::size_t i = interval(strike);
+        double dx = std::min(std::max(strike, strikes_.front()), strikes_.back()) - strikes_[i];
+
+        std::size_t above = static_cast<std::size_t>(
+            std::upper_bound(expiries_.begin(), expiries_.end(), timeToMaturity) - expiries_.begin());
+        if (above == 0) {
+            return smile(0, i, dx);
+        }
+        if (above == n) {
+            return smile(n - 1, i, dx);
+        }
+        double t0 = expiries_[above - 1];
+        double t1 = expiries_[above];
+        double s0 = smile(above - 1, i, dx);
+        double s1 = smile(above, i, dx);
+        double w0 = s0 * s0 * t0;
+        double w1 = s1 * s1 * t1;
+        double w = w0 + (w1 - w0) * (timeToMaturity - t0) / (t1 - t0);
+        return std::sqrt(std::max(w, 0.0) / timeToMaturity);
+    }
+
+    // Volatility for each of count contracts
+    void volatilities(const double* strike, const double* timeToMaturity, std::size_t count, double* out) const {
+        for (std::size_t k = 0; k < count; ++k) {
+            out[k] = volatility(strike[k], timeToMaturity[k]);
+        }
+    }
+
+    // Surface volatility for every contract in a batch, ignoring
+    // batch.volatility; point a copy of the view at out to price off the surface
+    void volatilities(const OptionBatchView& batch, double* out) const {
+        volatilities(batch.strike, batch.timeToMaturity, batch.size, out);
+    }
+
+    // Replace the whole grid (row-major, same shape) and refit; no allocation
+    void setVolatilities(const double* volatilities) {
+        std::copy(volatilities, volatilities + volatilities_.size(), volatilities_.begin());
+        fit();
+    }
+
+    // Fit the grid to option prices quoted at its nodes, row-major like the
+    // grid, all on one spot and rate. Each node's volatility comes straight
+    // from the batch implied volatility solver. A node whose solve fails
+    // takes the value interpolated linearly in strike between the nearest
+    // converged nodes of its expiry, or the nearest one at either end.
+    // Returns the number of nodes that converged; throws if an expiry has
+    // none, leaving the previous fit in place.
+    std::size_t fitImpliedVolatilities(const double* prices, const OptionType* types, double spot,
+                                       double riskFreeRate, double tolerance = 1e-6,
+                                       unsigned int maxIterations = 100) {
+        std::size_t m = strikes_.size();
+        std::size_t count = volatilities_.size();
+        std::vector<double> spots(count, spot);
+        std::vector<double> rates(count, riskFreeRate);
+        std::vector<double> strikes(count);
+        std::vector<double> times(count);
+        for (std::size_t j = 0; j < expiries_.size(); ++j) {
+            std::copy(strikes_.begin(), strikes_.end(), strikes.begin() + j * m);
+            std::fill(times.begin() + j * m, times.begin() + (j + 1) * m, expiries_[j]);
+        }
+        ImpliedVolBatchView batch{prices, spots.data(), strikes.data(), rates.data(), times.data(), types, count};
+        std::vector<double> solved(count);
+        std::vector<ImpliedVolStatus> status(count);
+        ImpliedVolatilityCalculator::calculateImpliedVolatilities(batch, solved.data(), status.data(),
+                                                                  tolerance, maxIterations);
+
+        std::size_t converged = 0;
+        for (std::size_t j = 0; j < expiries_.size(); ++j) {
+            const ImpliedVolStatus* rowStatus = status.data() + j * m;
+            double* row = solved.data() + j * m;
+            std::size_t rowConverged = 0;
+            for (std::size_t i = 0; i < m; ++i) {
+                rowConverged += rowStatus[i] == ImpliedVolStatus::Converged;
+            }
+            if (rowConverged == 0) {
+                throw std::runtime_error("No implied volatility converged for an expiry");
+            }
+            converged += rowConverged;
+            fillFailedNodes(row, rowStatus);
+        }
+        std::copy(solved.begin(), solved.end(), volatilities_.begin());
+        fit();
+        return converged;
+    }
+
+    const std::vector<double>& expiries() const { return expiries_; }
+    const std::vector<double>& strikes() const { return strikes_; }
+
+    // Node volatilities, row-major by expiry
+    const std::vector<double>& gridVolatilities() const { return volatilities_; }
+
+private:
+    std::vector<double> expiries_;
+    std::vector<double> strikes_;
+    std::vector<double> volatilities_;
+    std::vector<double> coefficients_;  // per expiry, per strike interval: a, b, c, d
+    std::vector<double> curvature_;     // fit() scratch: spline second derivatives
+    std::vector<double> pivot_;         // fit() scratch: tridiagonal elimination
+
+    std::size_t intervals() const { return strikes_.size() - 1; }
+
+    // Strike interval holding strike, clamped to the grid
+    std::size_t interval(double strike) const {
+        std::size_t above = static_cast<std::size_t>(
+            std::upper_bound(strikes_.begin(), strikes_.end(), strike) - strikes_.begin());
+        return std::min(std::max(above, std::size_t(1)), intervals()) - 1;
+    }
+
+    double smile(std::size_t expiry, std::size_t i, double dx) const {
+        const double* c = coefficients_.data() + (expiry * intervals() + i) * 4;
+        return c[0] + dx * (c[1] + dx * (c[2] + dx * c[3]));
+    }
+
+    // Natural cubic spline through every expiry's row of the grid
+    void fit() {
+        std::size_t m = strikes_.size();
+        for (std::size_t j = 0; j < expiries_.size(); ++j) {
+            const double* y = volatilities_.data() + j * m;
+
+            // Thomas algorithm for the second derivatives, zero at both ends
+            curvature_[0] = 0.0;
+            pivot_[0] = 0.0;
+            for (std::size_t i = 1; i + 1 < m; ++i) {
+                double h0 = strikes_[i] - strikes_[i - 1];
+                double h1 = strikes_[i + 1] - strikes_[i];
+                double rhs = 6.0 * ((y[i + 1] - y[i]) / h1 - (y[i] - y[i - 1]) / h0);
+                double diagonal = 2.0 * (h0 + h1) - h0 * pivot_[i - 1];
+                pivot_[i] = h1 / diagonal;
+                curvature_[i] = (rhs - h0 * curvature_[i - 1]) / diagonal;
+            }
+            curvature_[m - 1] = 0.0;
+            for (std::size_t i = m - 1; i-- > 1;) {
+                curvature_[i] -= pivot_[i] * curvature_[i + 1];
+            }
+
+            double* c = coefficients_.data() + j * intervals() * 4;
+            for (std::size_t i = 0; i + 1 < m; ++i, c += 4) {
+                double h = strikes_[i + 1] - strikes_[i];
+                c[0] = y[i];
+                c[1] = (y[i + 1] - y[i]) / h - h * (2.0 * curvature_[i] + curvature_[i + 1]) / 6.0;
+                c[2] = 0.5 * curvature_[i];
+                c[3] = (curvature_[i + 1] - curvature_[i]) / (6.0 * h);
+            }
+        }
+    }
+
+    // Replace failed solves in one expiry's row from its converged neighbours
+    void fillFailedNodes(double* row, const ImpliedVolStatus* status) const {
+        std::size_t m = strikes_.size();
+        std::size_t previous = m;  // last converged node, m while there is none
+        for (std::size_t i = 0; i < m; ++i) {
+            if (status[i] != ImpliedVolStatus::Converged) {
+                continue;
+            }
+            if (previous == m) {
+                std::fill(row, row + i, row[i]);
+            } else {
+                for (std::size_t k = previous + 1; k < i; ++k) {
+                    double weight = (strikes_[k] - strikes_[previous]) / (strikes_[i] - strikes_[previous]);
+                    row[k] = row[previous] + weight * (row[i] - row[previous]);
+                }
+            }
+            previous = i;
+        }
+        std::fill(row + previous + 1, row + m, row[previous]);
+    }
+};
+
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_VOLATILITY_SURFACE_HPP
@@ -0,0 +1,216 @@
+// Analytic American approximation kernels, included once per instruction-set
+// namespace from AmericanApproximation.hpp after the Black-Scholes kernels.
+//
+// Without dividends the cost of carry b equals r, so an American call is
+// never exercised early and is priced as European. Puts are the only case
+// that needs an approximation, and so are the lanes with r > 0; the rest
+// fall back to blackScholesPriceLanes().
+
+// Black-Scholes call with cost of carry b
+inline Vec carryCallLanes(Vec spot, Vec strike, Vec time, Vec rate, Vec carry, Vec vol) {
+    Vec volSqrtT = vol * vsqrt(time);
+    Vec d1 = (vlog(spot / strike) + (carry + vol * vol * set1(0.5)) * time) / volSqrtT;
+    Vec d2 = d1 - volSqrtT;
+    return spot * vexp((carry - rate) * time) * vnormalCDF(d1) - strike * vexp(-rate * time) * vnormalCDF(d2);
+}
+
+// P(X > h, Y > k) for standard normals with correlation +rho (sign = 1) or
+// -rho (sign = -1), Genz's Gauss-Legendre rule with precomputed nodes
+inline Vec bivariateUpperLanes(Vec h, Vec k, double sign, const detail::BivariateQuadrature& q) {
+    Vec hk = h * k;
+    Vec hs = (h * h + k * k) * set1(0.5);
+    Vec sum = set1(0.0);
+    for (std::size_t j = 0; j < detail::BivariateQuadrature::points; ++j) {
+        Vec exponent = (set1(sign * q.sine[j]) * hk - hs) * set1(q.inverseCosine2[j]);
+        sum = mulAdd(set1(q.weight[j]), vexp(exponent), sum);
+    }
+    return sum * set1(sign * q.scale) + vnormalCDF(-h) * vnormalCDF(-k);
+}
+
+// Bjerksund-Stensland (2002) phi(S, t, gamma, H, I); logs are passed in so
+// they are taken once per contract
+inline Vec stenslandPhiLanes(Vec logSpot, Vec time, Vec gamma, Vec logH, Vec logI,
+                             Vec rate, Vec carry, Vec vol) {
+    Vec variance = vol * vol;
+    Vec volSqrtT = vol * vsqrt(time);
+    Vec lambda = (-rate + gamma * carry + set1(0.5) * gamma * (gamma - set1(1.0)) * variance) * time;
+    Vec d = -(logSpot - logH + (carry + (gamma - set1(0.5)) * variance) * time) / volSqrtT;
+    Vec kappa = set1(2.0) * carry / variance + (set1(2.0) * gamma - set1(1.0));
+    Vec logIS = logI - logSpot;
+    return vexp(lambda + gamma * logSpot) *
+           (vnormalCDF(d) - vexp(kappa * logIS) * vnormalCDF(d - set1(2.0) * logIS / volSqrtT));
+}
+
+// Bjerksund-Stensland (2002) psi(S, T, gamma, H, I2, I1, t1)
+inline Vec stenslandPsiLanes(Vec logSpot, Vec time, Vec gamma, Vec logH, Vec logI2, Vec logI1, Vec t1,
+                             Vec rate, Vec carry, Vec vol, const detail::BivariateQuadrature& q) {
+    Vec variance = vol * vol;
+    Vec drift = carry + (gamma - set1(0.5)) * variance;
+    Vec volSqrtT1 = vol * vsqrt(t1);
+    Vec volSqrtT = vol * vsqrt(time);
+
+    Vec e12 = logSpot - logI1;
+    Vec e34 = set1(2.0) * logI2 - logSpot - logI1;
+    Vec e1 = (e12 + drift * t1) / volSqrtT1;
+    Vec e2 = (e34 + drift * t1) / volSqrtT1;
+    Vec e3 = (e12 - drift * t1) / volSqrtT1;
+    Vec e4 = (e34 - drift * t1) / volSqrtT1;
+    Vec f1 = (logSpot - logH + drift * time) / volSqrtT;
+    Vec f2 = (set1(2.0) * logI2 - logSpot - logH + drift * time) / volSqrtT;
+    Vec f3 = (set1(2.0) * logI1 - logSpot - logH + drift * time) / volSqrtT;
+    Vec f4 = (logSpot + set1(2.0) * (logI1 - logI2) - logH + drift * time) / volSqrtT;
+
+    Vec lambda = -rate + gamma * carry + set1(0.5) * gamma * (gamma - set1(1.0)) * variance;
+    Vec kappa = set1(2.0) * carry / variance + (set1(2.0) * gamma - set1(1.0));
+    // M(-e, -f, rho) = P(X > e, Y > f)
+    Vec sum = bivariateUpperLanes(e1, f1, 1.0, q) -
+              vexp(kappa * (logI2 - logSpot)) * bivariateUpperLanes(e2, f2, 1.0, q) -
+              vexp(kappa * (logI1 - logSpot)) * bivariateUpperLanes(e3, f3, -1.0, q) +
+              vexp(kappa * (logI1 - logI2)) * bivariateUpperLanes(e4, f4, -1.0, q);
+    return vexp(lambda * time + gamma * logSpot) * sum;
+}
+
+// Bjerksund-Stensland (2002) American call with carry b < r. The exercise
+// boundary is flat at I2 until t1 = (sqrt(5) - 1) / 2 * T and at the lower
+// I1 from there to expiry; any fixed boundary gives a lower bound on the
+// true value.
+inline Vec stenslandCallLanes(Vec spot, Vec strike, Vec time, Vec rate, Vec carry, Vec vol,
+                              const detail::BivariateQuadrature& q) {
+    Vec one = set1(1.0);
+    Vec zero = set1(0.0);
+    Vec variance = vol * vol;
+    Vec t1 = set1(0.5 * (2.23606797749978969641 - 1.0)) * time;
+    Vec carryRatio = carry / variance - set1(0.5);
+    Vec beta = -carryRatio + vsqrt(carryRatio * carryRatio + set1(2.0) * rate / variance);
+    Vec upperBound = beta / (beta - one) * strike;
+    Vec lowerBound = vmax(strike, rate / (rate - carry) * strike);
+    Vec scale = strike * strike / ((upperBound - lowerBound) * lowerBound);
+    Vec h1 = -(carry * t1 + set1(2.0) * vol * vsqrt(t1)) * scale;
+    Vec h2 = -(carry * time + set1(2.0) * vol * vsqrt(time)) * scale;
+    Vec i1 = lowerBound + (upperBound - lowerBound) * (one - vexp(h1));
+    Vec i2 = lowerBound + (upperBound - lowerBound) * (one - vexp(h2));
+
+    Vec logSpot = vlog(spot);
+    Vec logStrike = vlog(strike);
+    Vec logI1 = vlog(i1);
+    Vec logI2 = vlog(i2);
+    Vec alpha1 = (i1 - strike) * vexp(-beta * logI1);
+    Vec alpha2 = (i2 - strike) * vexp(-beta * logI2);
+
+    Vec value = alpha2 * vexp(beta * logSpot)
+              - alpha2 * stenslandPhiLanes(logSpot, t1, beta, logI2, logI2, rate, carry, vol)
+              + stenslandPhiLanes(logSpot, t1, one, logI2, logI2, rate, carry, vol)
+              - stenslandPhiLanes(logSpot, t1, one, logI1, logI2, rate, carry, vol)
+              - strike * stenslandPhiLanes(logSpot, t1, zero, logI2, logI2, rate, carry, vol)
+              + strike * stenslandPhiLanes(logSpot, t1, zero, logI1, logI2, rate, carry, vol)
+              + alpha1 * stenslandPhiLanes(logSpot, t1, beta, logI1, logI2, rate, carry, vol)
+              - alpha1 * stenslandPsiLanes(logSpot, time, beta, logI1, logI2, logI1, t1, rate, carry, vol, q)
+              + stenslandPsiLanes(logSpot, time, one, logI1, logI2, logI1, t1, rate, carry, vol, q)
+              - stenslandPsiLanes(logSpot, time, one, logStrike, logI2, logI1, t1, rate, carry, vol, q)
+              - strike * stenslandPsiLanes(logSpot, time, zero, logI1, logI2, logI1, t1, rate, carry, vol, q)
+              + strike * stenslandPsiLanes(logSpot, time, zero, logStrike, logI2, logI1, t1, rate, carry, vol, q);
+    return select(spot < i2, value, spot - strike);
+}
+
+// American price under Bjerksund-Stensland. Puts go through the put-call
+// transformation P(S, K, T, r, b) = C(K, S, T, r - b, -b), here with b = r.
+inline Vec bjerksundStenslandLanes(Vec spot, Vec strike, Vec rate, Vec vol, Vec time, Vec sign,
+                                   const detail::BivariateQuadrature& q) {
+    Vec european = blackScholesPriceLanes(spot, strike, rate, vol, time, sign);
+    Mask early = (sign < set1(0.0)) & (rate > set1(0.0));
+    if (!any(early)) {
+        return european;
+    }
+    // Lanes that keep the European price still run through with a safe rate
+    Vec safeRate = select(early, rate, set1(0.05));
+    Vec american = stenslandCallLanes(strike, spot, time, set1(0.0), -safeRate, vol, q);
+    return select(early, american, european);
+}
+
+// American put under Barone-Adesi-Whaley: European value plus an early
+// exercise premium A * (S / S*)^q, with the critical price S* found by Newton
+// on the smooth-pasting condition. Converged lanes are masked out.
+inline Vec baroneAdesiWhaleyLanes(Vec spot, Vec strike, Vec rate, Vec vol, Vec time, Vec sign,
+                                  double tolerance, unsigned int maxIterations) {
+    Vec european = blackScholesPriceLanes(spot, strike, rate, vol, time, sign);
+    Mask early = (sign < set1(0.0)) & (rate > set1(0.0));
+    if (!any(early)) {
+        return european;
+    }
+
+    Vec one = set1(1.0);
+    Vec r = select(early, rate, set1(0.05));
+    Vec variance = vol * vol;
+    Vec volSqrtT = vol * vsqrt(time);
+    Vec discount = vexp(-r * time);
+    Vec n = set1(2.0) * r / variance;
+    Vec q1 = set1(0.5) * (-(n - one) - vsqrt((n - one) * (n - one) + set1(4.0) * n / (one - discount)));
+
+    // Seed from the perpetual boundary K / (1 - 1 / q), as in Barone-Adesi and Whaley
+    Vec qInfinity = set1(0.5) * (-(n - one) - vsqrt((n - one) * (n - one) + set1(4.0) * n));
+    Vec perpetual = strike / (one - one / qInfinity);
+    Vec critical = perpetual + (strike - perpetual) *
+                   vexp((r * time - set1(2.0) * volSqrtT) * strike / (strike - perpetual));
+
+    Vec tol = set1(tolerance) * strike;
+    Vec drift = (r + variance * set1(0.5)) * time;
+    Mask active = early;
+    Vec d1, cdf;
+    for (unsigned int i = 0; i <= maxIterations; ++i) {
+        d1 = (vlog(critical / strike) + drift) / volSqrtT;
+        cdf = vnormalCDF(-d1);
+        Vec put = strike * discount * vnormalCDF(volSqrtT - d1) - critical * cdf;
+        Vec rhs = put - (one - cdf) * critical / q1;
+        Vec lhs = strike - critical;
+        active = active & !(vabs(lhs - rhs) < tol);
+        if (i == maxIterations || !any(active)) {
+            break;
+        }
+        Vec slope = -cdf * (one - one / q1) - (one + vnormalPDF(d1) / volSqrtT) / q1;
+        Vec next = (strike - rhs + slope * critical) / (one + slope);
+        critical = select(active, next, critical);
+    }
+
+    Vec premium = -(critical / q1) * (one - cdf) * vexp(q1 * vlog(spot / critical));
+    Vec american = select(spot > critical, european + premium, strike - spot);
+    return select(early, american, european);
+}
+
+inline Vec americanApproximationLanes(AmericanApproximation method, Vec spot, Vec strike, Vec rate, Vec vol,
+                                      Vec time, Vec sign, const detail::BivariateQuadrature& q) {
+    return method == AmericanApproximation::BaroneAdesiWhaley
+        ? baroneAdesiWhaleyLanes(spot, strike, rate, vol, time, sign, 1e-12, 50)
+        : bjerksundStenslandLanes(spot, strike, rate, vol, time, sign, q);
+}
+
+inline void americanApproximationBatch(const OptionBatchView& batch, double* out, AmericanApproximation method,
+                                       std::size_t begin, std::size_t end) {
+    const detail::BivariateQuadrature& q = detail::stenslandQuadrature();
+    std::size_t i = begin;
+    for (; i + lanes <= end; i += lanes) {
+        store(out + i, americanApproximationLanes(method, load(batch.spot + i), load(batch.strike + i),
+                                                  load(batch.riskFreeRate + i), load(batch.volatility + i),
+                                                  load(batch.timeToMaturity + i), loadSign(batch.type + i), q));
+    }
+    if (i == end) {
+        return;
+    }
+
+    // Pad the ragged tail with a harmless contract so it runs through the same kernel
+    double spot[lanes], strike[lanes], rate[lanes], vol[lanes], time[lanes], result[lanes];
+    OptionType type[lanes];
+    for (std::size_t j = 0; j < lanes; ++j) {
+        bool live = i + j < end;
+        spot[j] = live ? batch.spot[i + j] : 1.0;
+        strike[j] = live ? batch.strike[i + j] : 1.0;
+        rate[j] = live ? batch.riskFreeRate[i + j] : 0.0;
+        vol[j] = live ? batch.volatility[i + j] : 1.0;
+        time[j] = live ? batch.timeToMaturity[i + j] : 1.0;
+        type[j] = live ? batch.type[i + j] : OptionType::Call;
+    }
+    store(result, americanApproximationLanes(method, load(spot), load(strike), load(rate), load(vol), load(time),
+                                             loadSign(type), q));
+    for (std::size_t j = 0; i + j < end; ++j) {
+        out[i + j] = result[j];
+    }
+}
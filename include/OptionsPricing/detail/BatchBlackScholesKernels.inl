@@ -0,0 +1,134 @@
+// Black-Scholes batch kernels, included once per instruction-set namespace
+// from BatchBlackScholes.hpp, in double and in float; the includer supplies
+// BatchView and GreeksOutput for its Real. Every lane follows the same
+// formula as BlackScholesOption::price(), with the call/put choice folded
+// into a sign:
+//   price = s * (S * N(s * d1) - K * exp(-rT) * N(s * d2)),  s = +1 call, -1 put
+
+inline Vec blackScholesPriceLanes(Vec spot, Vec strike, Vec rate, Vec vol, Vec time, Vec sign) {
+    Vec volSqrtT = vol * vsqrt(time);
+    Vec d1 = (vlog(spot / strike) + (rate + vol * vol * set1(0.5)) * time) / volSqrtT;
+    Vec d2 = d1 - volSqrtT;
+    Vec discountedStrike = strike * vexp(-rate * time);
+    return sign * (spot * vnormalCDF(sign * d1) - discountedStrike * vnormalCDF(sign * d2));
+}
+
+inline void priceBatch(const BatchView& batch, Real* out, std::size_t begin, std::size_t end) {
+    std::size_t i = begin;
+    for (; i + lanes <= end; i += lanes) {
+        store(out + i, blackScholesPriceLanes(load(batch.spot + i), load(batch.strike + i),
+                                              load(batch.riskFreeRate + i), load(batch.volatility + i),
+                                              load(batch.timeToMaturity + i), loadSign(batch.type + i)));
+    }
+    if (i == end) {
+        return;
+    }
+
+    // Pad the ragged tail with a harmless contract so it runs through the same kernel
+    Real spot[lanes], strike[lanes], rate[lanes], vol[lanes], time[lanes], result[lanes];
+    OptionType type[lanes];
+    for (std::size_t j = 0; j < lanes; ++j) {
+        bool live = i + j < end;
+        spot[j] = live ? batch.spot[i + j] : 1.0;
+        strike[j] = live ? batch.strike[i + j] : 1.0;
+        rate[j] = live ? batch.riskFreeRate[i + j] : 0.0;
+        vol[j] = live ? batch.volatility[i + j] : 1.0;
+        time[j] = live ? batch.timeToMaturity[i + j] : 1.0;
+        type[j] = live ? batch.type[i + j] : OptionType::Call;
+    }
+    store(result, blackScholesPriceLanes(load(spot), load(strike), load(rate), load(vol), load(time),
+                                         loadSign(type)));
+    for (std::size_t j = 0; i + j < end; ++j) {
+        out[i + j] = result[j];
+    }
+}
+
+// Price and Greeks for one vector of contracts, mirroring
+// BlackScholesOption::calculateAllGreeks() lane by lane
+struct GreeksLanes {
+    Vec price;
+    Vec delta;
+    Vec gamma;
+    Vec theta;
+    Vec vega;
+    Vec rho;
+    Vec vanna;
+    Vec volga;
+    Vec charm;
+};
+
+inline GreeksLanes blackScholesGreeksLanes(Vec spot, Vec strike, Vec rate, Vec vol, Vec time, Vec sign) {
+    Vec sqrtT = vsqrt(time);
+    Vec volSqrtT = vol * sqrtT;
+    Vec d1 = (vlog(spot / strike) + (rate + vol * vol * set1(0.5)) * time) / volSqrtT;
+    Vec d2 = d1 - volSqrtT;
+    Vec discountedStrike = strike * vexp(-rate * time);
+    Vec cdfD1 = vnormalCDF(sign * d1);
+    Vec cdfD2 = vnormalCDF(sign * d2);
+    Vec pdfD1 = vnormalPDF(d1);
+    Vec spotPdfSqrtT = spot * sqrtT * pdfD1;
+
+    GreeksLanes g;
+    g.price = sign * (spot * cdfD1 - discountedStrike * cdfD2);
+    g.delta = sign * cdfD1;
+    g.gamma = pdfD1 / (spot * volSqrtT);
+    g.theta = -(spot * pdfD1 * vol) / (set1(2.0) * sqrtT) - sign * rate * discountedStrike * cdfD2;
+    g.vega = spotPdfSqrtT * set1(0.01);
+    g.rho = sign * time * discountedStrike * cdfD2 * set1(0.01);
+    g.vanna = -pdfD1 * d2 / vol * set1(0.01);
+    g.volga = spotPdfSqrtT * d1 * d2 / vol * set1(0.0001);
+    g.charm = -pdfD1 * (set1(2.0) * rate * time - d2 * volSqrtT) / (set1(2.0) * time * volSqrtT);
+    return g;
+}
+
+inline void storeGreeks(const GreeksOutput& out, std::size_t i, const GreeksLanes& g) {
+    if (out.price) store(out.price + i, g.price);
+    if (out.delta) store(out.delta + i, g.delta);
+    if (out.gamma) store(out.gamma + i, g.gamma);
+    if (out.theta) store(out.theta + i, g.theta);
+    if (out.vega) store(out.vega + i, g.vega);
+    if (out.rho) store(out.rho + i, g.rho);
+    if (out.vanna) store(out.vanna + i, g.vanna);
+    if (out.volga) store(out.volga + i, g.volga);
+    if (out.charm) store(out.charm + i, g.charm);
+}
+
+inline void greeksBatch(const BatchView& batch, const GreeksOutput& out,
+                        std::size_t begin, std::size_t end) {
+    std::size_t i = begin;
+    for (; i + lanes <= end; i += lanes) {
+        storeGreeks(out, i, blackScholesGreeksLanes(load(batch.spot + i), load(batch.strike + i),
+                                                    load(batch.riskFreeRate + i), load(batch.volatility + i),
+                                                    load(batch.timeToMaturity + i), loadSign(batch.type + i)));
+    }
+    if (i == end) {
+        return;
+    }
+
+    Real spot[lanes], strike[lanes], rate[lanes], vol[lanes], time[lanes];
+    OptionType type[lanes];
+    for (std::size_t j = 0; j < lanes; ++j) {
+        bool live = i + j < end;
+        spot[j] = live ? batch.spot[i + j] : 1.0;
+        strike[j] = live ? batch.strike[i + j] : 1.0;
+        rate[j] = live ? batch.riskFreeRate[i + j] : 0.0;
+        vol[j] = live ? batch.volatility[i + j] : 1.0;
+        time[j] = live ? batch.timeToMaturity[i + j] : 1.0;
+        type[j] = live ? batch.type[i + j] : OptionType::Call;
+    }
+    GreeksLanes g = blackScholesGreeksLanes(load(spot), load(strike), load(rate), load(vol), load(time),
+                                            loadSign(type));
+
+    // Spill to a local block, then copy only the live lanes
+    Real block[9][lanes];
+    GreeksOutput local = {block[0], block[1], block[2], block[3], block[4],
+                          block[5], block[6], block[7], block[8]};
+    storeGreeks(local, 0, g);
+    Real* targets[9] = {out.price, out.delta, out.gamma, out.theta, out.vega,
+                        out.rho, out.vanna, out.volga, out.charm};
+    for (int k = 0; k < 9; ++k) {
+        for (std::size_t j = 0; targets[k] && i + j < end; ++j) {
+            targets[k][i + j] = block[k][j];
+        }
+    }
+}
@@ -0,0 +1,49 @@
+// Strike-ladder kernel for the Cox-Ross-Rubinstein tree, included once per
+// instruction-set namespace from BinomialTree.hpp.
+//
+// Values are interleaved by strike: node i of the current step holds
+// detail::binomialLadderWidth doubles, one per strike, so every node update
+// is a few full vectors and the spot at the node is a broadcast. The node
+// spots come split by parity as in BinomialTreeOption, so each step reads a
+// contiguous run.
+
+template <bool American>
+inline void binomialLadder(const double* nodeSpots, const double* sign, const double* signedStrike,
+                           double pUp, double pDown, int n, double* values) {
+    constexpr std::size_t width = detail::binomialLadderWidth;
+    constexpr std::size_t vectors = width / lanes;
+    Vec up = set1(pUp);
+    Vec down = set1(pDown);
+    Vec zero = set1(0.0);
+    Vec signs[vectors];
+    Vec strikes[vectors];
+    for (std::size_t k = 0; k < vectors; ++k) {
+        signs[k] = load(sign + k * lanes);
+        strikes[k] = load(signedStrike + k * lanes);
+    }
+
+    // Payoffs at maturity, from the even-parity run of node spots
+    for (int i = 0; i <= n; ++i) {
+        Vec spot = set1(nodeSpots[i]);
+        for (std::size_t k = 0; k < vectors; ++k) {
+            store(values + i * width + k * lanes, vmax(signs[k] * spot - strikes[k], zero));
+        }
+    }
+
+    for (int j = n - 1; j >= 0; --j) {
+        int parity = (n - j) & 1;
+        const double* spots = nodeSpots + (parity ? n + 1 : 0) + (n - j - parity) / 2;
+        for (int i = 0; i <= j; ++i) {
+            double* v = values + i * width;
+            for (std::size_t k = 0; k < vectors; ++k) {
+                Vec next = mulAdd(up, load(v + k * lanes), down * load(v + width + k * lanes));
+                if constexpr (American) {
+                    // Continuation values are never negative, so comparing with
+                    // sign * (S - K) is the same as with the payoff
+                    next = vmax(next, signs[k] * set1(spots[i]) - strikes[k]);
+                }
+                store(v + k * lanes, next);
+            }
+        }
+    }
+}
@@ -0,0 +1,107 @@
+// Implied volatility kernels, included once per instruction-set namespace
+// from ImpliedVolatility.hpp.
+//
+// Safeguarded Newton: every lane keeps a bracket [low, high] on volatility
+// and takes the Newton step with analytic vega when it stays inside the
+// bracket, bisecting otherwise. The Manaster-Koehler starting point sits at
+// the inflection of price in volatility, from where Newton converges
+// monotonically in the common case. Lanes that have finished are masked
+// out while the rest keep iterating.
+
+struct ImpliedVolLanes {
+    Vec volatility;
+    Vec status;      // ImpliedVolStatus as a double
+    Vec iterations;
+};
+
+inline ImpliedVolLanes impliedVolLanes(Vec target, Vec spot, Vec strike, Vec rate, Vec time, Vec sign,
+                                       double tolerance, unsigned int maxIterations) {
+    Vec zero = set1(0.0);
+    Vec one = set1(1.0);
+    Vec discountedStrike = strike * vexp(-rate * time);
+    Vec sqrtT = vsqrt(time);
+    Vec logMoneyness = vlog(spot / strike);
+
+    // No-arbitrage bounds: intrinsic value below, spot (calls) or K * exp(-rT) (puts) above
+    Vec lower = vmax(sign * (spot - discountedStrike), zero);
+    Vec upper = select(sign > zero, spot, discountedStrike);
+    Mask valid = (spot > zero) & (strike > zero) & (time > zero) & (vabs(target) < set1(1e300));
+    Mask invalid = !valid;
+    Mask below = valid & !(target > lower);
+    Mask above = valid & (target > lower) & !(target < upper);
+
+    ImpliedVolLanes result;
+    result.status = set1(static_cast<double>(ImpliedVolStatus::NotConverged));
+    result.status = select(invalid, set1(static_cast<double>(ImpliedVolStatus::InvalidInput)), result.status);
+    result.status = select(below, set1(static_cast<double>(ImpliedVolStatus::BelowIntrinsic)), result.status);
+    result.status = select(above, set1(static_cast<double>(ImpliedVolStatus::AboveMaximum)), result.status);
+    result.iterations = zero;
+    Mask active = !(invalid | below | above);
+
+    Vec vol = vsqrt(set1(2.0) * vabs(logMoneyness + rate * time) / time);
+    vol = vmin(vmax(vol, set1(0.05)), set1(5.0));
+    Vec low = zero;
+    Vec high = set1(100.0);
+    Vec tol = set1(tolerance);
+
+    for (unsigned int i = 0; i < maxIterations && any(active); ++i) {
+        Vec volSqrtT = vol * sqrtT;
+        Vec d1 = (logMoneyness + (rate + vol * vol * set1(0.5)) * time) / volSqrtT;
+        Vec d2 = d1 - volSqrtT;
+        Vec price = sign * (spot * vnormalCDF(sign * d1) - discountedStrike * vnormalCDF(sign * d2));
+        Vec vega = spot * sqrtT * vnormalPDF(d1);
+        Vec diff = price - target;
+        result.iterations = result.iterations + select(active, one, zero);
+
+        // Done when the price matches, or the bracket cannot shrink any further
+        Mask done = active & ((vabs(diff) < tol) | !(high - low > high * set1(4e-16)));
+        result.status = select(done, set1(static_cast<double>(ImpliedVolStatus::Converged)), result.status);
+        active = active & !done;
+
+        low = select(diff < zero, vol, low);
+        high = select(diff > zero, vol, high);
+        Vec newton = vol - diff / vega;
+        Vec next = select((newton > low) & (newton < high), newton, set1(0.5) * (low + high));
+        vol = select(active, next, vol);
+    }
+
+    // Lanes still active hit the iteration limit; their iterate is not an answer
+    result.volatility = select(invalid | below | above | active, zero, vol);
+    return result;
+}
+
+inline void impliedVolBatch(const ImpliedVolBatchView& batch, double* volatility, ImpliedVolStatus* status,
+                            double tolerance, unsigned int maxIterations, std::size_t begin, std::size_t end) {
+    double volBlock[lanes], statusBlock[lanes];
+    for (std::size_t i = begin; i < end; i += lanes) {
+        ImpliedVolLanes r;
+        if (i + lanes <= end) {
+            r = impliedVolLanes(load(batch.price + i), load(batch.spot + i), load(batch.strike + i),
+                                load(batch.riskFreeRate + i), load(batch.timeToMaturity + i),
+                                loadSign(batch.type + i), tolerance, maxIterations);
+        } else {
+            // Pad the ragged tail with a solvable at-the-money contract
+            double price[lanes], spot[lanes], strike[lanes], rate[lanes], time[lanes];
+            OptionType type[lanes];
+            for (std::size_t j = 0; j < lanes; ++j) {
+                bool live = i + j < end;
+                price[j] = live ? batch.price[i + j] : 0.1;
+                spot[j] = live ? batch.spot[i + j] : 1.0;
+                strike[j] = live ? batch.strike[i + j] : 1.0;
+                rate[j] = live ? batch.riskFreeRate[i + j] : 0.0;
+                time[j] = live ? batch.timeToMaturity[i + j] : 1.0;
+                type[j] = live ? batch.type[i + j] : OptionType::Call;
+            }
+            r = impliedVolLanes(load(price), load(spot), load(strike), load(rate), load(time),
+                                loadSign(type), tolerance, maxIterations);
+        }
+        store(volBlock, r.volatility);
+        store(statusBlock, r.status);
+        for (std::size_t j = 0; j < lanes && i + j < end; ++j) {
+            volatility[i + j] = volBlock[j];
+            if (status) {
+                status[i + j] = static_cast<ImpliedVolStatus>(static_cast<int>(statusBlock[j]));
+            }
+        }
+    }
+}
@@ -0,0 +1,55 @@
+// Monte Carlo path kernels, included once per instruction-set namespace from
+// MonteCarlo.hpp. Block lengths are whole multiples of the widest vector, so
+// there is no ragged tail to handle.
+
+// Uniforms in (0, 1) to standard normals, in place
+inline void normalsFromUniforms(double* x, std::size_t n) {
+    for (std::size_t i = 0; i < n; i += lanes) {
+        store(x + i, vinverseNormalCDF(load(x + i)));
+    }
+}
+
+// One exact geometric Brownian motion step for a block of paths:
+// logReturn += drift + diffusion * z, spot = spot0 * exp(logReturn)
+inline void gbmStep(double* logReturn, double* spot, const double* z, double spot0,
+                    double drift, double diffusion, std::size_t n) {
+    Vec s0 = set1(spot0);
+    Vec mu = set1(drift);
+    Vec sigma = set1(diffusion);
+    for (std::size_t i = 0; i < n; i += lanes) {
+        Vec x = mulAdd(sigma, load(z + i), load(logReturn + i) + mu);
+        store(logReturn + i, x);
+        store(spot + i, s0 * vexp(x));
+    }
+}
+
+// One Brownian bridge fill for a block of paths:
+// out = leftWeight * left + rightWeight * right + stdDev * z, where a null
+// neighbour contributes nothing (W(0) = 0 on the left, none yet on the right)
+inline void bridgeStep(double* out, const double* left, const double* right, const double* z,
+                       double leftWeight, double rightWeight, double stdDev, std::size_t n) {
+    Vec wl = set1(leftWeight);
+    Vec wr = set1(rightWeight);
+    Vec sd = set1(stdDev);
+    for (std::size_t i = 0; i < n; i += lanes) {
+        Vec x = sd * load(z + i);
+        if (right) {
+            x = mulAdd(wr, load(right + i), x);
+        }
+        if (left) {
+            x = mulAdd(wl, load(left + i), x);
+        }
+        store(out + i, x);
+    }
+}
+
+// Spot from the Brownian motion at one date: spot = spot0 * exp(drift + sigma * w)
+inline void gbmFromBrownian(double* spot, const double* w, double spot0, double drift, double sigma,
+                            std::size_t n) {
+    Vec s0 = set1(spot0);
+    Vec mu = set1(drift);
+    Vec vol = set1(sigma);
+    for (std::size_t i = 0; i < n; i += lanes) {
+        store(spot + i, s0 * vexp(mulAdd(vol, load(w + i), mu)));
+    }
+}
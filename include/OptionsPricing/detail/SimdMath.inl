@@ -0,0 +1,155 @@
+// Vectorized elementary functions shared by every batch kernel.
+//
+// This file is included once per instruction-set namespace in Simd.hpp and
+// relies on the Vec/Mask vocabulary defined there. It deliberately has no
+// include guard and no includes of its own.
+
+// exp(x) after fdlibm's e_exp.c (< 1 ulp), inputs clamped to [-708, 709]
+inline Vec vexp(Vec x) {
+    x = vmin(vmax(x, set1(-708.0)), set1(709.0));
+    Vec k = vround(x * set1(1.44269504088896338700e+00));
+    Vec hi = x - k * set1(6.93147180369123816490e-01);
+    Vec lo = k * set1(1.90821492927058770002e-10);
+    Vec r = hi - lo;
+    Vec t = r * r;
+    Vec c = mulAdd(t, set1(4.13813679705723846039e-08), set1(-1.65339022054652515390e-06));
+    c = mulAdd(t, c, set1(6.61375632143793436117e-05));
+    c = mulAdd(t, c, set1(-2.77777777770155933842e-03));
+    c = mulAdd(t, c, set1(1.66666666666666019037e-01));
+    c = r - t * c;
+    Vec y = set1(1.0) - ((lo - (r * c) / (set1(2.0) - c)) - hi);
+    return y * pow2i(k);
+}
+
+// log(x) after fdlibm's e_log.c (< 1 ulp) for positive normal x
+inline Vec vlog(Vec x) {
+    Vec e = exponentOf(x);
+    Vec m = mantissaOf(x);
+    Mask high = m > set1(1.41421356237309504880);
+    m = select(high, m * set1(0.5), m);
+    e = select(high, e + set1(1.0), e);
+
+    Vec f = m - set1(1.0);
+    Vec s = f / (set1(2.0) + f);
+    Vec z = s * s;
+    Vec w = z * z;
+    Vec t1 = w * mulAdd(w, mulAdd(w, set1(1.531383769920937332e-01), set1(2.222219843214978396e-01)),
+                        set1(3.999999999940941908e-01));
+    Vec t2 = z * mulAdd(w, mulAdd(w, mulAdd(w, set1(1.479819860511658591e-01), set1(1.818357216161805012e-01)),
+                                  set1(2.857142874366239149e-01)),
+                        set1(6.666666666666735130e-01));
+    Vec R = t1 + t2;
+    Vec hfsq = set1(0.5) * f * f;
+    return e * set1(6.93147180369123816490e-01) -
+           ((hfsq - (s * (hfsq + R) + e * set1(1.90821492927058770002e-10))) - f);
+}
+
+// Standard normal density
+inline Vec vnormalPDF(Vec x) {
+    return set1(0.39894228040143267794) * vexp(set1(-0.5) * x * x);
+}
+
+// Standard normal CDF, Hart (1968) as given by West (2005): a rational
+// approximation inside |x| < 7.07 and a continued fraction beyond it.
+// Computes the lower tail directly, so it stays accurate where
+// 0.5 * (1 + erf(x / sqrt(2))) cancels.
+inline Vec vnormalCDF(Vec x) {
+    Vec ax = vabs(x);
+    Vec ex = vexp(set1(-0.5) * ax * ax);
+
+    Vec num = mulAdd(ax, set1(3.52624965998911e-02), set1(0.700383064443688));
+    num = mulAdd(num, ax, set1(6.37396220353165));
+    num = mulAdd(num, ax, set1(33.912866078383));
+    num = mulAdd(num, ax, set1(112.079291497871));
+    num = mulAdd(num, ax, set1(221.213596169931));
+    num = mulAdd(num, ax, set1(220.206867912376));
+    Vec den = mulAdd(ax, set1(8.83883476483184e-02), set1(1.75566716318264));
+    den = mulAdd(den, ax, set1(16.064177579207));
+    den = mulAdd(den, ax, set1(86.7807322029461));
+    den = mulAdd(den, ax, set1(296.564248779674));
+    den = mulAdd(den, ax, set1(637.333633378831));
+    den = mulAdd(den, ax, set1(793.826512519948));
+    den = mulAdd(den, ax, set1(440.413735824752));
+    Vec tail = ex * num / den;
+
+    // The continued fraction is only paid for when some lane is that far out
+    Mask farOut = ax > set1(7.07106781186547);
+    if (any(farOut)) {
+        Vec cf = ax + set1(4.0) / (ax + set1(0.65));
+        cf = ax + set1(3.0) / cf;
+        cf = ax + set1(2.0) / cf;
+        cf = ax + set1(1.0) / cf;
+        tail = select(farOut, ex / (cf * set1(2.50662827463100050242)), tail);
+        tail = select(ax > set1(37.0), set1(0.0), tail);
+    }
+    return select(x > set1(0.0), set1(1.0) - tail, tail);
+}
+
+// Inverse standard normal CDF for p in (0, 1), Wichura's AS241 (PPND16),
+// relative accuracy about 1e-16. A rational function in p - 0.5 near the
+// centre and in sqrt(-log(min(p, 1 - p))) in the tails; the tail branches
+// are only evaluated when some lane needs them.
+inline Vec vinverseNormalCDF(Vec p) {
+    Vec q = p - set1(0.5);
+    Vec r = set1(0.180625) - q * q;
+    Vec num = mulAdd(r, set1(2.5090809287301226727e+3), set1(3.3430575583588128105e+4));
+    num = mulAdd(num, r, set1(6.7265770927008700853e+4));
+    num = mulAdd(num, r, set1(4.5921953931549871457e+4));
+    num = mulAdd(num, r, set1(1.3731693765509461125e+4));
+    num = mulAdd(num, r, set1(1.9715909503065514427e+3));
+    num = mulAdd(num, r, set1(1.3314166789178437745e+2));
+    num = mulAdd(num, r, set1(3.3871328727963666080e+0));
+    Vec den = mulAdd(r, set1(5.2264952788528545610e+3), set1(2.8729085735721942674e+4));
+    den = mulAdd(den, r, set1(3.9307895800092710610e+4));
+    den = mulAdd(den, r, set1(2.1213794301586595867e+4));
+    den = mulAdd(den, r, set1(5.3941960214247511077e+3));
+    den = mulAdd(den, r, set1(6.8718700749205790830e+2));
+    den = mulAdd(den, r, set1(4.2313330701600911252e+1));
+    den = mulAdd(den, r, set1(1.0));
+    Vec x = q * num / den;
+
+    Mask tail = vabs(q) > set1(0.425);
+    if (any(tail)) {
+        Vec s = vsqrt(-vlog(vmin(p, set1(1.0) - p)));
+
+        Vec t = s - set1(1.6);
+        Vec numNear = mulAdd(t, set1(7.74545014278341407640e-4), set1(2.27238449892691845833e-2));
+        numNear = mulAdd(numNear, t, set1(2.41780725177450611770e-1));
+        numNear = mulAdd(numNear, t, set1(1.27045825245236838258e+0));
+        numNear = mulAdd(numNear, t, set1(3.64784832476320460504e+0));
+        numNear = mulAdd(numNear, t, set1(5.76949722146069140550e+0));
+        numNear = mulAdd(numNear, t, set1(4.63033784615654529590e+0));
+        numNear = mulAdd(numNear, t, set1(1.42343711074968357734e+0));
+        Vec denNear = mulAdd(t, set1(1.05075007164441684324e-9), set1(5.47593808499534494600e-4));
+        denNear = mulAdd(denNear, t, set1(1.51986665636164571966e-2));
+        denNear = mulAdd(denNear, t, set1(1.48103976427480074590e-1));
+        denNear = mulAdd(denNear, t, set1(6.89767334985100004550e-1));
+        denNear = mulAdd(denNear, t, set1(1.67638483018380384940e+0));
+        denNear = mulAdd(denNear, t, set1(2.05319162663775882187e+0));
+        denNear = mulAdd(denNear, t, set1(1.0));
+        Vec y = numNear / denNear;
+
+        Mask farTail = s > set1(5.0);
+        if (any(farTail & tail)) {
+            Vec w = s - set1(5.0);
+            Vec numFar = mulAdd(w, set1(2.01033439929228813265e-7), set1(2.71155556874348757815e-5));
+            numFar = mulAdd(numFar, w, set1(1.24266094738807843860e-3));
+            numFar = mulAdd(numFar, w, set1(2.65321895265761230930e-2));
+            numFar = mulAdd(numFar, w, set1(2.96560571828504891230e-1));
+            numFar = mulAdd(numFar, w, set1(1.78482653991729133580e+0));
+            numFar = mulAdd(numFar, w, set1(5.46378491116411436990e+0));
+            numFar = mulAdd(numFar, w, set1(6.65790464350110377720e+0));
+            Vec denFar = mulAdd(w, set1(2.04426310338993978564e-15), set1(1.42151175831644588870e-7));
+            denFar = mulAdd(denFar, w, set1(1.84631831751005468180e-5));
+            denFar = mulAdd(denFar, w, set1(7.86869131145613259100e-4));
+            denFar = mulAdd(denFar, w, set1(1.48753612908506148525e-2));
+            denFar = mulAdd(denFar, w, set1(1.36929880922735805310e-1));
+            denFar = mulAdd(denFar, w, set1(5.99832206555887937690e-1));
+            denFar = mulAdd(denFar, w, set1(1.0));
+            y = select(farTail, numFar / denFar, y);
+        }
+        y = select(q < set1(0.0), -y, y);
+        x = select(tail, y, x);
+    }
+    return x;
+}
@@ -0,0 +1,82 @@
+// Single-precision counterparts of SimdMath.inl, included once per f32
+// namespace in Simd.hpp. The exp and log polynomials are Cephes' expf and
+// logf, about half the degree of the double ones and within a couple of
+// float ulp. Like SimdMath.inl, no include guard and no includes.
+
+// exp(x), inputs clamped to [-87, 88] so 2^k stays a normal float
+inline Vec vexp(Vec x) {
+    x = vmin(vmax(x, set1(-87.0f)), set1(88.0f));
+    Vec k = vround(x * set1(1.44269504088896341f));
+    Vec r = x - k * set1(0.693359375f);
+    r = r - k * set1(-2.12194440e-4f);
+    Vec p = mulAdd(r, set1(1.9875691500e-4f), set1(1.3981999507e-3f));
+    p = mulAdd(p, r, set1(8.3334519073e-3f));
+    p = mulAdd(p, r, set1(4.1665795894e-2f));
+    p = mulAdd(p, r, set1(1.6666665459e-1f));
+    p = mulAdd(p, r, set1(5.0000001201e-1f));
+    Vec y = mulAdd(p, r * r, r + set1(1.0f));
+    return y * pow2i(k);
+}
+
+// log(x) for positive normal x
+inline Vec vlog(Vec x) {
+    Vec e = exponentOf(x);
+    Vec m = mantissaOf(x);
+    Mask high = m > set1(1.41421356237309504880f);
+    m = select(high, m * set1(0.5f), m);
+    e = select(high, e + set1(1.0f), e);
+
+    Vec f = m - set1(1.0f);
+    Vec z = f * f;
+    Vec p = mulAdd(f, set1(7.0376836292e-2f), set1(-1.1514610310e-1f));
+    p = mulAdd(p, f, set1(1.1676998740e-1f));
+    p = mulAdd(p, f, set1(-1.2420140846e-1f));
+    p = mulAdd(p, f, set1(1.4249322787e-1f));
+    p = mulAdd(p, f, set1(-1.6668057665e-1f));
+    p = mulAdd(p, f, set1(2.0000714765e-1f));
+    p = mulAdd(p, f, set1(-2.4999993993e-1f));
+    p = mulAdd(p, f, set1(3.3333331174e-1f));
+    Vec y = p * f * z;
+    y = mulAdd(e, set1(-2.12194440e-4f), y);
+    y = mulAdd(z, set1(-0.5f), y);
+    return mulAdd(e, set1(0.693359375f), f + y);
+}
+
+// Standard normal density
+inline Vec vnormalPDF(Vec x) {
+    return set1(0.39894228040143267794f) * vexp(set1(-0.5f) * x * x);
+}
+
+// Standard normal CDF, the same Hart rational and continued fraction as the
+// double kernel. The lower tail is flushed to zero past |x| = 13, where it
+// drops below the smallest normal float.
+inline Vec vnormalCDF(Vec x) {
+    Vec ax = vabs(x);
+    Vec ex = vexp(set1(-0.5f) * ax * ax);
+
+    Vec num = mulAdd(ax, set1(3.52624965998911e-02f), set1(0.700383064443688f));
+    num = mulAdd(num, ax, set1(6.37396220353165f));
+    num = mulAdd(num, ax, set1(33.912866078383f));
+    num = mulAdd(num, ax, set1(112.079291497871f));
+    num = mulAdd(num, ax, set1(221.213596169931f));
+    num = mulAdd(num, ax, set1(220.206867912376f));
+    Vec den = mulAdd(ax, set1(8.83883476483184e-02f), set1(1.75566716318264f));
+    den = mulAdd(den, ax, set1(16.064177579207f));
+    den = mulAdd(den, ax, set1(86.7807322029461f));
+    den = mulAdd(den, ax, set1(296.564248779674f));
+    den = mulAdd(den, ax, set1(637.333633378831f));
+    den = mulAdd(den, ax, set1(793.826512519948f));
+    den = mulAdd(den, ax, set1(440.413735824752f));
+    Vec tail = ex * num / den;
+
+    Mask farOut = ax > set1(7.07106781186547f);
+    if (any(farOut)) {
+        Vec cf = ax + set1(4.0f) / (ax + set1(0.65f));
+        cf = ax + set1(3.0f) / cf;
+        cf = ax + set1(2.0f) / cf;
+        cf = ax + set1(1.0f) / cf;
+        tail = select(farOut, ex / (cf * set1(2.50662827463100050242f)), tail);
+        tail = select(ax > set1(13.0f), set1(0.0f), tail);
+    }
+    return select(x > set1(0.0f), set1(1.0f) - tail, tail);
+}
@@ -10,11 +10,28 @@
 
 // Include all component headers
 #include "OptionsPricing/Common.hpp"
+#include "OptionsPricing/Payoff.hpp"
+#include "OptionsPricing/Adjoint.hpp"
+#include "OptionsPricing/Random.hpp"
+#include "OptionsPricing/Sobol.hpp"
+#include "OptionsPricing/ThreadPool.hpp"
+#include "OptionsPricing/Metrics.hpp"
+#include "OptionsPricing/LatticeCache.hpp"
 #include "OptionsPricing/BlackScholes.hpp"
+#include "OptionsPricing/BatchBlackScholes.hpp"
+#include "OptionsPricing/AmericanApproximation.hpp"
 #include "OptionsPricing/BinomialTree.hpp"
 #include "OptionsPricing/TrinomialTree.hpp"
+#include "OptionsPricing/FiniteDifference.hpp"
+#include "OptionsPricing/MonteCarlo.hpp"
 #include "OptionsPricing/ImpliedVolatility.hpp"
+#include "OptionsPricing/VolatilitySurface.hpp"
 #include "OptionsPricing/OptionFactory.hpp"
 #include "OptionsPricing/Portfolio.hpp"
+#include "OptionsPricing/PricingService.hpp"
+
+// Opt-in, as they bring in OS headers or a compiled backend:
+//   OptionsPricing/PositionFile.hpp  memory-mapped position and result files
+//   OptionsPricing/Gpu.hpp           CUDA backend (options_pricing_cuda)
 
 #endif // OPTIONS_PRICING_H
\ No newline at end of file
@@ -0,0 +1,215 @@
+// Device kernels for GpuPricer. The Black-Scholes ones follow
+// detail/BatchBlackScholesKernels.inl and the Monte Carlo one
+// MonteCarloOption::simulateBlock() and accumulatePrice(), formula for
+// formula, so the GPU and CPU engines can be checked against each other.
+
+#include "GpuKernels.hpp"
+
+#include <algorithm>
+
+namespace OptionsPricing {
+namespace gpu {
+
+namespace {
+
+constexpr int threadsPerBlock = 256;
+constexpr unsigned int maxGridBlocks = 4096;  // grid-stride loops cover the rest
+
+unsigned int gridFor(std::size_t n) {
+    return static_cast<unsigned int>(std::min<std::size_t>((n + threadsPerBlock - 1) / threadsPerBlock,
+                                                           maxGridBlocks));
+}
+
+__device__ double normalPDF(double x) {
+    return 0.39894228040143267794 * exp(-0.5 * x * x);
+}
+
+__global__ void priceKernel(DeviceContracts c, double* out) {
+    std::size_t stride = static_cast<std::size_t>(gridDim.x) * blockDim.x;
+    for (std::size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < c.size; i += stride) {
+        double spot = c.spot[i], strike = c.strike[i], rate = c.riskFreeRate[i];
+        double vol = c.volatility[i], time = c.timeToMaturity[i];
+        double sign = c.type[i] == 0 ? 1.0 : -1.0;
+        double volSqrtT = vol * sqrt(time);
+        double d1 = (log(spot / strike) + (rate + vol * vol * 0.5) * time) / volSqrtT;
+        double d2 = d1 - volSqrtT;
+        double discountedStrike = strike * exp(-rate * time);
+        out[i] = sign * (spot * normcdf(sign * d1) - discountedStrike * normcdf(sign * d2));
+    }
+}
+
+struct Slots {
+    int column[greekCount];
+};
+
+__global__ void greeksKernel(DeviceContracts c, Slots slots, double* out) {
+    std::size_t stride = static_cast<std::size_t>(gridDim.x) * blockDim.x;
+    for (std::size_t i = blockIdx.x * blockDim.x + threadIdx.x; i < c.size; i += stride) {
+        double spot = c.spot[i], strike = c.strike[i], rate = c.riskFreeRate[i];
+        double vol = c.volatility[i], time = c.timeToMaturity[i];
+        double sign = c.type[i] == 0 ? 1.0 : -1.0;
+        double sqrtT = sqrt(time);
+        double volSqrtT = vol * sqrtT;
+        double d1 = (log(spot / strike) + (rate + vol * vol * 0.5) * time) / volSqrtT;
+        double d2 = d1 - volSqrtT;
+        double discountedStrike = strike * exp(-rate * time);
+        double cdfD1 = normcdf(sign * d1);
+        double cdfD2 = normcdf(sign * d2);
+        double pdfD1 = normalPDF(d1);
+        double spotPdfSqrtT = spot * sqrtT * pdfD1;
+
+        double g[greekCount];
+        g[0] = sign * (spot * cdfD1 - discountedStrike * cdfD2);
+        g[1] = sign * cdfD1;
+        g[2] = pdfD1 / (spot * volSqrtT);
+        g[3] = -(spot * pdfD1 * vol) / (2.0 * sqrtT) - sign * rate * discountedStrike * cdfD2;
+        g[4] = spotPdfSqrtT * 0.01;
+        g[5] = sign * time * discountedStrike * cdfD2 * 0.01;
+        g[6] = -pdfD1 * d2 / vol * 0.01;
+        g[7] = spotPdfSqrtT * d1 * d2 / vol * 0.0001;
+        g[8] = -pdfD1 * (2.0 * rate * time - d2 * volSqrtT) / (2.0 * time * volSqrtT);
+#pragma unroll
+        for (int k = 0; k < greekCount; ++k) {
+            if (slots.column[k] >= 0) {
+                out[static_cast<std::size_t>(slots.column[k]) * c.size + i] = g[k];
+            }
+        }
+    }
+}
+
+// Philox4x32-10, as Philox4x32::operator() in Random.hpp
+__device__ uint4 philox(uint4 counter, unsigned int k0, unsigned int k1) {
+#pragma unroll
+    for (int round = 0; round < 10; ++round) {
+        unsigned int high0 = __umulhi(0xD2511F53u, counter.x);
+        unsigned int low0 = 0xD2511F53u * counter.x;
+        unsigned int high1 = __umulhi(0xCD9E8D57u, counter.z);
+        unsigned int low1 = 0xCD9E8D57u * counter.z;
+        counter = make_uint4(high1 ^ counter.y ^ k0, low1, high0 ^ counter.w ^ k1, low0);
+        k0 += 0x9E3779B9u;
+        k1 += 0xBB67AE85u;
+    }
+    return counter;
+}
+
+// 53-bit uniform in (0, 1), as Philox4x32::toUniform()
+__device__ double toUniform(unsigned int high, unsigned int low) {
+    unsigned long long mantissa = ((static_cast<unsigned long long>(high) << 32) | low) >> 11;
+    return (static_cast<double>(mantissa) + 0.5) * 1.1102230246251565404e-16;
+}
+
+// Running log-return and payoff state of one path
+struct Path {
+    double logReturn = 0.0;
+    double spot = 0.0;
+    double sum = 0.0;
+
+    __device__ void step(const PathSpec& spec, double z) {
+        logReturn = fma(spec.diffusion, z, logReturn + spec.drift);
+        spot = spec.spot * exp(logReturn);
+        sum += spot;
+    }
+
+    // Discounted payoff y and control x
+    __device__ void finish(const PathSpec& spec, double& y, double& x) const {
+        double underlying = spec.asian ? sum / spec.steps : spot;
+        y = spec.discount * fmax(0.0, spec.sign * (underlying - spec.strike));
+        x = spec.discount * fmax(0.0, spec.sign * (spot - spec.strike));
+    }
+};
+
+// One thread block per 256-path block. Thread t owns counter t and so the
+// paths 2t and 2t + 1, plus their mirrors 2t + drawn and 2t + 1 + drawn
+// under antithetic sampling, where each pair is one sample.
+__global__ void monteCarloKernel(PathSpec spec, unsigned long long firstBlock, double* sums) {
+    extern __shared__ double shared[];  // [sum][thread]
+    const unsigned int t = threadIdx.x;
+    const unsigned long long block = firstBlock + blockIdx.x;
+    const unsigned int k0 = static_cast<unsigned int>(spec.seed);
+    const unsigned int k1 = static_cast<unsigned int>(spec.seed >> 32);
+    const uint4 base = make_uint4(t, 0u, static_cast<unsigned int>(block), static_cast<unsigned int>(block >> 32));
+
+    Path paths[2], mirrors[2];
+    for (unsigned int s = 0; s < spec.steps; ++s) {
+        uint4 counter = base;
+        counter.y = s;
+        uint4 bits = philox(counter, k0, k1);
+        double z[2] = {normcdfinv(toUniform(bits.x, bits.y)), normcdfinv(toUniform(bits.z, bits.w))};
+        for (int j = 0; j < 2; ++j) {
+            paths[j].step(spec, z[j]);
+            if (spec.antithetic) {
+                mirrors[j].step(spec, -z[j]);
+            }
+        }
+    }
+
+    double local[sumCount] = {};
+    for (int j = 0; j < 2; ++j) {
+        double y, x;
+        paths[j].finish(spec, y, x);
+        if (spec.antithetic) {
+            double yMirror, xMirror;
+            mirrors[j].finish(spec, yMirror, xMirror);
+            y = 0.5 * (y + yMirror);
+            x = 0.5 * (x + xMirror);
+        }
+        local[0] += 1.0;
+        local[1] += y;
+        local[2] += x;
+        local[3] += y * y;
+        local[4] += x * x;
+        local[5] += x * y;
+    }
+
+    // Fixed tree reduction, so the block's sums are the same on every run
+    const unsigned int threads = blockDim.x;
+    for (int k = 0; k < sumCount; ++k) {
+        shared[k * threads + t] = local[k];
+    }
+    __syncthreads();
+    for (unsigned int half = threads / 2; half > 0; half /= 2) {
+        if (t < half) {
+            for (int k = 0; k < sumCount; ++k) {
+                shared[k * threads + t] += shared[k * threads + t + half];
+            }
+        }
+        __syncthreads();
+    }
+    if (t < sumCount) {
+        sums[static_cast<std::size_t>(blockIdx.x) * sumCount + t] = shared[t * threads];
+    }
+}
+
+} // namespace
+
+void launchPrice(const DeviceContracts& contracts, double* out, cudaStream_t stream) {
+    if (contracts.size == 0) {
+        return;
+    }
+    priceKernel<<<gridFor(contracts.size), threadsPerBlock, 0, stream>>>(contracts, out);
+}
+
+void launchGreeks(const DeviceContracts& contracts, const int (&slots)[greekCount], double* out,
+                  cudaStream_t stream) {
+    if (contracts.size == 0) {
+        return;
+    }
+    Slots columns;
+    std::copy(slots, slots + greekCount, columns.column);
+    greeksKernel<<<gridFor(contracts.size), threadsPerBlock, 0, stream>>>(contracts, columns, out);
+}
+
+void launchMonteCarlo(const PathSpec& spec, std::uint64_t firstBlock, std::size_t blocks, double* sums,
+                      cudaStream_t stream) {
+    if (blocks == 0) {
+        return;
+    }
+    // Two paths (four with mirrors) per thread: 128 threads, or 64 when antithetic
+    unsigned int threads = (spec.antithetic ? blockPaths / 2 : blockPaths) / 2;
+    std::size_t sharedBytes = sizeof(double) * sumCount * threads;
+    monteCarloKernel<<<static_cast<unsigned int>(blocks), threads, sharedBytes, stream>>>(
+        spec, static_cast<unsigned long long>(firstBlock), sums);
+}
+
+} // namespace gpu
+} // namespace OptionsPricing
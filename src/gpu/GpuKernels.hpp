@@ -0,0 +1,59 @@
+#ifndef OPTIONS_PRICING_GPU_KERNELS_HPP
+#define OPTIONS_PRICING_GPU_KERNELS_HPP
+
+#include <cuda_runtime_api.h>
+#include <cstddef>
+#include <cstdint>
+
+// Launchers for the device kernels in GpuKernels.cu, in plain types so the
+// host side (GpuPricer.cpp) builds with the C++ compiler alone.
+
+namespace OptionsPricing {
+namespace gpu {
+
+// One chunk of contracts in device memory, columns of `size`; type is 0 for
+// a call, 1 for a put (OptionType's values)
+struct DeviceContracts {
+    const double* spot;
+    const double* strike;
+    const double* riskFreeRate;
+    const double* volatility;
+    const double* timeToMaturity;
+    const int* type;
+    std::size_t size;
+};
+
+constexpr int greekCount = 9;  // price, delta, gamma, theta, vega, rho, vanna, volga, charm
+
+void launchPrice(const DeviceContracts& contracts, double* out, cudaStream_t stream);
+
+// slots[k] is the column of out that Greek k goes to, or -1 to skip it
+void launchGreeks(const DeviceContracts& contracts, const int (&slots)[greekCount], double* out,
+                  cudaStream_t stream);
+
+// One Monte Carlo configuration, precomputed on the host as in
+// MonteCarloOption::simulateBlock()
+struct PathSpec {
+    double spot;
+    double strike;
+    double drift;      // (r - sigma^2 / 2) dt
+    double diffusion;  // sigma sqrt(dt)
+    double discount;
+    double sign;       // +1 call, -1 put
+    unsigned int steps;
+    bool asian;
+    bool antithetic;
+    std::uint64_t seed;
+};
+
+constexpr int blockPaths = 256;
+constexpr int sumCount = 6;  // count, sumY, sumX, sumYY, sumXX, sumXY
+
+// Blocks [firstBlock, firstBlock + blocks), writing sumCount sums per block
+void launchMonteCarlo(const PathSpec& spec, std::uint64_t firstBlock, std::size_t blocks, double* sums,
+                      cudaStream_t stream);
+
+} // namespace gpu
+} // namespace OptionsPricing
+
+#endif // OPTIONS_PRICING_GPU_KERNELS_HPP
@@ -0,0 +1,294 @@
+#include "OptionsPricing/Gpu.hpp"
+#include "GpuKernels.hpp"
+
+#include <cuda_runtime_api.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace OptionsPricing {
+
+static_assert(sizeof(OptionType) == sizeof(int) && static_cast<int>(OptionType::Call) == 0 &&
+                  static_cast<int>(OptionType::Put) == 1,
+              "the device kernels read OptionType as int, 0 call and 1 put");
+
+namespace {
+
+constexpr int inputColumns = 5;  // spot, strike, rate, volatility, maturity
+
+void check(cudaError_t status, const char* what) {
+    if (status != cudaSuccess) {
+        throw std::runtime_error(std::string(what) + ": " + cudaGetErrorString(status));
+    }
+}
+
+} // namespace
+
+bool gpuAvailable() {
+    int devices = 0;
+    return cudaGetDeviceCount(&devices) == cudaSuccess && devices > 0;
+}
+
+struct GpuPricer::Impl {
+    // One stream with its own staging, so chunks on different streams overlap
+    struct Lane {
+        cudaStream_t stream = nullptr;
+        double* hostInputs = nullptr;  // pinned, [column][contract]
+        int* hostTypes = nullptr;
+        double* hostOutputs = nullptr;
+        double* deviceInputs = nullptr;
+        int* deviceTypes = nullptr;
+        double* deviceOutputs = nullptr;
+        // The chunk whose results are still in flight
+        bool pending = false;
+        std::size_t begin = 0;
+        std::size_t size = 0;
+    };
+
+    // Monte Carlo launches cover 64 of the CPU engine's 64-block rounds
+    static constexpr std::size_t monteCarloBlocks = 64 * 64;
+
+    int device = 0;
+    std::size_t chunk = 0;
+    std::vector<Lane> lanes;
+    double* deviceSums = nullptr;
+    double* hostSums = nullptr;
+
+    Impl(const GpuSettings& settings) : device(settings.device), chunk(settings.chunkContracts) {
+        check(cudaSetDevice(device), "cudaSetDevice");
+        lanes.resize(settings.streams);
+        try {
+            for (Lane& lane : lanes) {
+                check(cudaStreamCreateWithFlags(&lane.stream, cudaStreamNonBlocking), "cudaStreamCreate");
+                check(cudaMallocHost(&lane.hostInputs, sizeof(double) * inputColumns * chunk), "cudaMallocHost");
+                check(cudaMallocHost(&lane.hostTypes, sizeof(int) * chunk), "cudaMallocHost");
+                check(cudaMallocHost(&lane.hostOutputs, sizeof(double) * gpu::greekCount * chunk),
+                      "cudaMallocHost");
+                check(cudaMalloc(&lane.deviceInputs, sizeof(double) * inputColumns * chunk), "cudaMalloc");
+                check(cudaMalloc(&lane.deviceTypes, sizeof(int) * chunk), "cudaMalloc");
+                check(cudaMalloc(&lane.deviceOutputs, sizeof(double) * gpu::greekCount * chunk), "cudaMalloc");
+            }
+            check(cudaMalloc(&deviceSums, sizeof(double) * gpu::sumCount * monteCarloBlocks), "cudaMalloc");
+            check(cudaMallocHost(&hostSums, sizeof(double) * gpu::sumCount * monteCarloBlocks), "cudaMallocHost");
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+    ~Impl() { release(); }
+
+    // Frees whatever has been allocated; safe on a half-built Impl
+    void release() {
+        cudaSetDevice(device);
+        for (Lane& lane : lanes) {
+            if (lane.stream) {
+                cudaStreamSynchronize(lane.stream);
+                cudaStreamDestroy(lane.stream);
+            }
+            cudaFreeHost(lane.hostInputs);
+            cudaFreeHost(lane.hostTypes);
+            cudaFreeHost(lane.hostOutputs);
+            cudaFree(lane.deviceInputs);
+            cudaFree(lane.deviceTypes);
+            cudaFree(lane.deviceOutputs);
+        }
+        lanes.clear();
+        cudaFree(deviceSums);
+        cudaFreeHost(hostSums);
+        deviceSums = nullptr;
+        hostSums = nullptr;
+    }
+
+    // Wait for the lane's chunk and hand its staged results to unpack
+    template <typename Unpack>
+    void drain(Lane& lane, Unpack& unpack) {
+        if (!lane.pending) {
+            return;
+        }
+        check(cudaStreamSynchronize(lane.stream), "cudaStreamSynchronize");
+        lane.pending = false;
+        unpack(lane.begin, lane.size, lane.hostOutputs);
+    }
+
+    // Abandon whatever is in flight after a failure, so no later call
+    // unpacks a stale chunk into its own output
+    void abandon() {
+        for (Lane& lane : lanes) {
+            if (lane.stream) {
+                cudaStreamSynchronize(lane.stream);
+            }
+            lane.pending = false;
+        }
+        cudaGetLastError();  // clear the sticky launch error, if any
+    }
+
+    // Chunk the batch round-robin over the lanes: pack into pinned staging,
+    // copy up, launch(contracts, deviceOut, stream), copy `outputs` columns
+    // back and unpack(begin, size, hostOut) once the lane comes round again
+    template <typename Launch, typename Unpack>
+    void pipeline(const OptionBatchView& batch, int outputs, Launch launch, Unpack unpack) {
+        try {
+            run(batch, outputs, launch, unpack);
+        } catch (...) {
+            abandon();
+            throw;
+        }
+    }
+
+    template <typename Launch, typename Unpack>
+    void run(const OptionBatchView& batch, int outputs, Launch& launch, Unpack& unpack) {
+        check(cudaSetDevice(device), "cudaSetDevice");
+        std::size_t chunks = (batch.size + chunk - 1) / chunk;
+        for (std::size_t c = 0; c < chunks; ++c) {
+            Lane& lane = lanes[c % lanes.size()];
+            drain(lane, unpack);
+
+            std::size_t begin = c * chunk;
+            std::size_t n = std::min(chunk, batch.size - begin);
+            const double* columns[inputColumns] = {batch.spot, batch.strike, batch.riskFreeRate,
+                                                   batch.volatility, batch.timeToMaturity};
+            for (int k = 0; k < inputColumns; ++k) {
+                std::memcpy(lane.hostInputs + k * n, columns[k] + begin, sizeof(double) * n);
+            }
+            std::memcpy(lane.hostTypes, batch.type + begin, sizeof(int) * n);
+
+            check(cudaMemcpyAsync(lane.deviceInputs, lane.hostInputs, sizeof(double) * inputColumns * n,
+                                  cudaMemcpyHostToDevice, lane.stream), "cudaMemcpyAsync");
+            check(cudaMemcpyAsync(lane.deviceTypes, lane.hostTypes, sizeof(int) * n,
+                                  cudaMemcpyHostToDevice, lane.stream), "cudaMemcpyAsync");
+            const double* in = lane.deviceInputs;
+            launch(gpu::DeviceContracts{in, in + n, in + 2 * n, in + 3 * n, in + 4 * n, lane.deviceTypes, n},
+                   lane.deviceOutputs, lane.stream);
+            check(cudaGetLastError(), "kernel launch");
+            check(cudaMemcpyAsync(lane.hostOutputs, lane.deviceOutputs, sizeof(double) * outputs * n,
+                                  cudaMemcpyDeviceToHost, lane.stream), "cudaMemcpyAsync");
+            lane.pending = true;
+            lane.begin = begin;
+            lane.size = n;
+        }
+        for (Lane& lane : lanes) {
+            drain(lane, unpack);
+        }
+    }
+};
+
+GpuPricer::GpuPricer(GpuSettings settings) : settings_(settings) {
+    if (settings_.streams == 0) {
+        throw std::invalid_argument("GpuPricer needs at least one stream");
+    }
+    if (settings_.chunkContracts == 0) {
+        throw std::invalid_argument("GpuPricer needs a positive chunk size");
+    }
+    if (!gpuAvailable()) {
+        throw std::runtime_error("No CUDA device available");
+    }
+    impl_ = std::make_unique<Impl>(settings_);
+}
+
+GpuPricer::~GpuPricer() = default;
+
+void GpuPricer::price(const OptionBatchView& batch, double* out) {
+    impl_->pipeline(batch, 1, gpu::launchPrice,
+                    [&](std::size_t begin, std::size_t n, const double* staged) {
+                        std::memcpy(out + begin, staged, sizeof(double) * n);
+                    });
+}
+
+void GpuPricer::greeks(const OptionBatchView& batch, const GreeksBatchOutput& out) {
+    double* targets[gpu::greekCount] = {out.price, out.delta, out.gamma, out.theta, out.vega,
+                                        out.rho, out.vanna, out.volga, out.charm};
+    int slots[gpu::greekCount];
+    int outputs = 0;
+    for (int k = 0; k < gpu::greekCount; ++k) {
+        slots[k] = targets[k] ? outputs++ : -1;
+    }
+    if (outputs == 0) {
+        return;
+    }
+    impl_->pipeline(batch, outputs,
+                    [&](const gpu::DeviceContracts& contracts, double* deviceOut, cudaStream_t stream) {
+                        gpu::launchGreeks(contracts, slots, deviceOut, stream);
+                    },
+                    [&](std::size_t begin, std::size_t n, const double* staged) {
+                        for (int k = 0; k < gpu::greekCount; ++k) {
+                            if (slots[k] >= 0) {
+                                std::memcpy(targets[k] + begin, staged + slots[k] * n, sizeof(double) * n);
+                            }
+                        }
+                    });
+}
+
+MonteCarloResult GpuPricer::simulate(const MonteCarloOption& option, GpuPathPayoff payoff) {
+    const MonteCarloSettings& settings = option.settings_;
+    if (settings.sampling != MonteCarloSampling::PseudoRandom) {
+        throw std::invalid_argument("GPU Monte Carlo supports pseudo-random sampling only");
+    }
+    check(cudaSetDevice(impl_->device), "cudaSetDevice");
+
+    double dt = option.timeToMaturity_ / settings.timeSteps;
+    gpu::PathSpec spec;
+    spec.spot = option.spot_;
+    spec.strike = option.strike_;
+    spec.drift = (option.riskFreeRate_ - 0.5 * option.volatility_ * option.volatility_) * dt;
+    spec.diffusion = option.volatility_ * std::sqrt(dt);
+    spec.discount = std::exp(-option.riskFreeRate_ * option.timeToMaturity_);
+    spec.sign = option.type_ == OptionType::Call ? 1.0 : -1.0;
+    spec.steps = settings.timeSteps;
+    spec.asian = payoff == GpuPathPayoff::ArithmeticAsian;
+    spec.antithetic = settings.antithetic;
+    spec.seed = settings.seed;
+
+    // Per-block sums merged in the CPU engine's block order and rounds, so
+    // early stopping lands on the same block count
+    constexpr std::size_t blockPaths = MonteCarloOption::blockPaths;
+    constexpr std::size_t blocksPerRound = MonteCarloOption::blocksPerRound;
+    static_assert(blockPaths == gpu::blockPaths, "device and host blocks must agree");
+    static_assert(Impl::monteCarloBlocks % blocksPerRound == 0, "launches must hold whole rounds");
+    bool controlVariate = settings.controlVariate;
+    double controlMean = option.controlMean();
+    cudaStream_t stream = impl_->lanes.front().stream;
+    std::size_t maxBlocks = (settings.maxPaths + blockPaths - 1) / blockPaths;
+    MonteCarloOption::Accumulator total;
+    MonteCarloResult result{};
+    std::size_t block = 0;
+    while (block < maxBlocks) {
+        std::size_t count = std::min(Impl::monteCarloBlocks, maxBlocks - block);
+        gpu::launchMonteCarlo(spec, block, count, impl_->deviceSums, stream);
+        check(cudaGetLastError(), "kernel launch");
+        check(cudaMemcpyAsync(impl_->hostSums, impl_->deviceSums, sizeof(double) * gpu::sumCount * count,
+                              cudaMemcpyDeviceToHost, stream), "cudaMemcpyAsync");
+        check(cudaStreamSynchronize(stream), "cudaStreamSynchronize");
+
+        for (std::size_t k = 0; k < count;) {
+            std::size_t roundEnd = std::min(k + blocksPerRound, count);
+            for (; k < roundEnd; ++k) {
+                const double* sums = impl_->hostSums + k * gpu::sumCount;
+                MonteCarloOption::Accumulator stats;
+                stats.count = sums[0];
+                stats.sumY = sums[1];
+                stats.sumX = sums[2];
+                stats.sumYY = sums[3];
+                stats.sumXX = sums[4];
+                stats.sumXY = sums[5];
+                total.merge(stats);
+            }
+            result = MonteCarloOption::estimate(total, controlVariate, controlMean, (block + k) * blockPaths);
+            if (settings.targetStandardError > 0.0 && result.standardError <= settings.targetStandardError) {
+                return result;
+            }
+        }
+        block += count;
+    }
+    return result;
+}
+
+std::string GpuPricer::deviceName() const {
+    cudaDeviceProp properties;
+    check(cudaGetDeviceProperties(&properties, impl_->device), "cudaGetDeviceProperties");
+    return properties.name;
+}
+
+} // namespace OptionsPricing